@@ -0,0 +1,99 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * COUNT DISTINCT of a user-id column.
+ *
+ * The exact count groups the column with table_aggregate(), as DISTINCT
+ * does, keeping every distinct value. APPROX_COUNT_DISTINCT
+ * (table_approx_distinct()) keeps only a HyperLogLog sketch; it is timed
+ * at several precisions, with its error against the exact count next to
+ * the reported standard error, and at the default precision on 1, 2, 4,
+ * ... threads, where the merged sketch must equal the serial one.
+ *
+ * Usage: ./bench_approx_distinct [rows] [distinct]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 10000000;
+    int users = argc > 2 ? atoi(argv[2]) : 2000000;
+    if (rows <= 0) rows = 10000000;
+    if (users <= 0) users = 2000000;
+
+    Table t;
+    init_table(&t);
+    if (!table_add_column(&t, "user_id")) return 1;
+    char id[32];
+    uint32_t seed = 7;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(id, sizeof(id), "user-%08u", (seed >> 4) % (uint32_t)users);
+        const char *values[1] = { id };
+        if (!table_append_row(&t, values, 1)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+    }
+
+    printf("COUNT DISTINCT of %d user ids (drawn from %d)\n", rows, users);
+    int key = 0;
+    Aggregate agg;
+    double t0 = now_sec();
+    if (!table_aggregate(&agg, &t, &key, 1, NULL, 0)) {
+        fprintf(stderr, "Out of memory grouping.\n");
+        return 1;
+    }
+    double elapsed = now_sec() - t0;
+    int exact = agg.groups;
+    printf("  %-26s %9.2f ms  %d  (every distinct value kept)\n", "exact (hash aggregation)",
+           elapsed * 1e3, exact);
+    agg_free(&agg);
+
+    for (int p = 10; p <= HLL_MAX_PRECISION; p += 2) {
+        HyperLogLog h;
+        t0 = now_sec();
+        if (!table_approx_distinct(&t, 0, p, &h)) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+        double estimate = hll_estimate(&h);
+        elapsed = now_sec() - t0;
+        hll_free(&h);
+        char label[64];
+        snprintf(label, sizeof(label), "HLL p=%d (%zu KB)", p, ((size_t)1 << p) / 1024);
+        printf("  %-26s %9.2f ms  %.0f  (off by %+.2f%%, standard error %.2f%%)\n", label,
+               elapsed * 1e3, estimate, 100.0 * (estimate - exact) / exact, 100.0 * hll_std_error(p));
+    }
+
+    printf("HLL p=%d on several threads\n", HLL_PRECISION);
+    HyperLogLog serial;
+    csv_load_threads = 1;
+    if (!table_approx_distinct(&t, 0, HLL_PRECISION, &serial)) return 1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int threads = 1; threads <= 2 * cpus && threads <= CSV_MAX_THREADS; threads *= 2) {
+        csv_load_threads = threads;
+        HyperLogLog h;
+        t0 = now_sec();
+        if (!table_approx_distinct(&t, 0, HLL_PRECISION, &h)) return 1;
+        elapsed = now_sec() - t0;
+        int same = memcmp(h.registers, serial.registers, (size_t)1 << HLL_PRECISION) == 0;
+        printf("  %2d thread(s) %9.2f ms  %s\n", threads, elapsed * 1e3, same ? "same sketch" : "MISMATCH");
+        hll_free(&h);
+    }
+    hll_free(&serial);
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,218 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Single-column scan: column-major Table vs. the old row-major layout.
+ *
+ * Both layouts point at the same cell strings, so the only difference
+ * is how the cell pointers are laid out. The old layout is rebuilt here
+ * exactly as it used to be in csv_sql.c (136-byte Row structs). The typed
+ * SUM reads the native values kept for inferred numeric columns.
+ *
+ * Usage: ./bench_column_scan [rows] [cols]
+ */
+
+#define LEGACY_MAX_COLS 16
+
+typedef struct {
+    char *cells[LEGACY_MAX_COLS];
+    int cell_count;
+} LegacyRow;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Hardware cache-miss counter; returns -1 when perf events are unavailable. */
+static int open_cache_miss_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void counter_start(int fd) {
+    if (fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static long long counter_stop(int fd) {
+    if (fd < 0) return -1;
+    long long value = -1;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) return -1;
+    return value;
+}
+
+static double sum_columnar(const Table *t, int col) {
+    const Cell *cells = t->cols[col].cells;
+    double sum = 0.0;
+    for (int i = 0; i < t->row_count; i++) {
+        double v;
+        if (parse_cell_double(cells[i], &v)) sum += v;
+    }
+    return sum;
+}
+
+static double sum_typed(const Table *t, int col) {
+    const Column *c = &t->cols[col];
+    double sum = 0.0;
+    for (int i = 0; i < t->row_count; i++) {
+        if (c->valid[i]) sum += c->nums[i];
+    }
+    return sum;
+}
+
+static double sum_legacy(const LegacyRow *rows, int n, int col) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        const char *cell = (col < rows[i].cell_count) ? rows[i].cells[col] : NULL;
+        double v;
+        if (cell && parse_double(cell, &v)) sum += v;
+    }
+    return sum;
+}
+
+/* Pointer-only pass: isolates the cost of reaching each cell. */
+static double count_columnar(const Table *t, int col) {
+    const Cell *cells = t->cols[col].cells;
+    long count = 0;
+    for (int i = 0; i < t->row_count; i++) {
+        if (cells[i].ptr) count++;
+    }
+    return (double)count;
+}
+
+static double count_legacy(const LegacyRow *rows, int n, int col) {
+    long count = 0;
+    for (int i = 0; i < n; i++) {
+        if (col < rows[i].cell_count && rows[i].cells[col]) count++;
+    }
+    return (double)count;
+}
+
+static void report(const char *name, double best, long long misses, int rows) {
+    printf("  %-22s %9.2f ms  %7.2f ns/row", name, best * 1e3, best * 1e9 / rows);
+    if (misses >= 0) {
+        printf("  %12lld cache misses (%.3f/row)", misses, (double)misses / rows);
+    } else {
+        printf("  cache misses: n/a");
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 2000000;
+    int cols = argc > 2 ? atoi(argv[2]) : 16;
+    if (rows <= 0) rows = 2000000;
+    if (cols <= 0 || cols > LEGACY_MAX_COLS) cols = LEGACY_MAX_COLS;
+    const int reps = 5;
+
+    Table t;
+    init_table(&t);
+    char name[32];
+    for (int c = 0; c < cols; c++) {
+        snprintf(name, sizeof(name), "c%d", c);
+        table_add_column(&t, name);
+    }
+
+    char bufs[LEGACY_MAX_COLS][32];
+    const char *values[LEGACY_MAX_COLS];
+    srand(42);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            snprintf(bufs[c], sizeof(bufs[c]), "%d.%02d", rand() % 100000, rand() % 100);
+            values[c] = bufs[c];
+        }
+        if (!table_append_row(&t, values, cols)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+    }
+
+    LegacyRow *legacy = (LegacyRow *)calloc((size_t)rows, sizeof(LegacyRow));
+    if (!legacy) {
+        fprintf(stderr, "Out of memory building legacy rows.\n");
+        return 1;
+    }
+    for (int r = 0; r < rows; r++) {
+        legacy[r].cell_count = cols;
+        for (int c = 0; c < cols; c++) {
+            /* Arena cells are NUL-terminated, so they double as C strings. */
+            legacy[r].cells[c] = (char *)t.cols[c].cells[r].ptr;
+        }
+    }
+
+    table_infer_types(&t);
+    if (t.cols[cols / 2].type != COL_DOUBLE) {
+        fprintf(stderr, "Column %d was not inferred as double.\n", cols / 2);
+        return 1;
+    }
+
+    int fd = open_cache_miss_counter();
+    int col = cols / 2;
+    printf("Scanning column %d of %d rows x %d cols (best of %d)\n", col, rows, cols, reps);
+
+    struct {
+        const char *name;
+        int columnar;
+        int parse;
+    } cases[] = {
+        { "row-major count",  0, 0 },
+        { "columnar count",   1, 0 },
+        { "row-major SUM",    0, 1 },
+        { "columnar SUM",     1, 1 },
+        { "typed SUM",        1, 2 },
+    };
+
+    volatile double sink = 0.0;
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++) {
+        double best = 1e30;
+        long long best_misses = -1;
+        for (int rep = 0; rep < reps; rep++) {
+            counter_start(fd);
+            double t0 = now_sec();
+            double v;
+            if (cases[k].columnar) {
+                v = cases[k].parse == 2 ? sum_typed(&t, col)
+                  : cases[k].parse ? sum_columnar(&t, col) : count_columnar(&t, col);
+            } else {
+                v = cases[k].parse ? sum_legacy(legacy, rows, col) : count_legacy(legacy, rows, col);
+            }
+            double elapsed = now_sec() - t0;
+            long long misses = counter_stop(fd);
+            sink += v;
+            if (elapsed < best) {
+                best = elapsed;
+                best_misses = misses;
+            }
+        }
+        report(cases[k].name, best, best_misses, rows);
+    }
+    (void)sink;
+
+    if (fd >= 0) close(fd);
+    free(legacy);
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * COUNT / SUM / AVG / MIN / MAX of one numeric column.
+ *
+ * The old way is three passes, as max_by_column(), min_by_column() and
+ * sum_avg_column() used to run them (reimplemented here): MAX, MIN, then
+ * a plain SUM. It is timed against one column_stats() pass through the
+ * scalar and the AVX2 kernels, on an int64 and a double column with a
+ * tenth of their cells empty. All must find the same rows.
+ *
+ * Then accuracy: a double column of 0.1 repeated, with a few 1e15 and
+ * -1e15 cells mixed in, summed with the plain loop and with the kernels,
+ * against the exact total.
+ *
+ * Usage: ./bench_column_stats [rows]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* n: INT64, amount: DOUBLE; every tenth row empty in both. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "n") || !table_add_column(t, "amount")) return 0;
+    char n[32], amount[32];
+    uint32_t seed = 7;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        n[0] = amount[0] = '\0';
+        if (i % 10 != 3) {
+            snprintf(n, sizeof(n), "%d", (int)(seed >> 4) - (1 << 27));
+            snprintf(amount, sizeof(amount), "%u.%02u", (seed >> 8) % 100000, seed % 100);
+        }
+        const char *values[2] = { n, amount };
+        if (!table_append_row(t, values, 2)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* The three separate passes. */
+static void three_passes(const Table *t, int col, ColumnStats *s) {
+    const Column *c = &t->cols[col];
+    memset(s, 0, sizeof(*s));
+    s->min_row = s->max_row = -1;
+    for (int want_max = 1; want_max >= 0; want_max--) {
+        int best = -1;
+        for (int i = 0; i < t->row_count; i++) {
+            if (!c->valid[i]) continue;
+            double v = c->type == COL_INT64 ? (double)c->ints[i] : c->nums[i];
+            double b = best < 0 ? 0.0 : c->type == COL_INT64 ? (double)c->ints[best] : c->nums[best];
+            if (best < 0 || (want_max ? v > b : v < b)) best = i;
+        }
+        if (want_max) s->max_row = best;
+        else s->min_row = best;
+    }
+    for (int i = 0; i < t->row_count; i++) {
+        if (!c->valid[i]) continue;
+        s->sum += c->type == COL_INT64 ? (double)c->ints[i] : c->nums[i];
+        s->count++;
+    }
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (rows <= 0) rows = 10000000;
+
+    const StatsKernels *kernels[2] = { &stats_kernels_scalar, NULL };
+#ifdef CSV_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) kernels[1] = &stats_kernels_avx2;
+#endif
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("COUNT / SUM / AVG / MIN / MAX over %d rows (a tenth empty)\n", rows);
+    for (int col = 0; col < 2; col++) {
+        printf("  %s column\n", col == 0 ? "int64" : "double");
+        ColumnStats old;
+        double t0 = now_sec();
+        three_passes(&t, col, &old);
+        double elapsed = now_sec() - t0;
+        printf("    %-28s %8.2f ms  sum %.2f\n", "three passes (MAX, MIN, SUM)", elapsed * 1e3, old.sum);
+        for (int k = 0; k < 2; k++) {
+            if (!kernels[k]) continue;
+            stats_kernels = kernels[k];
+            ColumnStats s;
+            t0 = now_sec();
+            column_stats(&t, col, &s);
+            elapsed = now_sec() - t0;
+            char label[64];
+            snprintf(label, sizeof(label), "one pass, %s", kernels[k]->name);
+            printf("    %-28s %8.2f ms  sum %.2f  %s\n", label, elapsed * 1e3, s.sum,
+                   s.count == old.count && s.min_row == old.min_row && s.max_row == old.max_row
+                       ? "same rows" : "MISMATCH");
+        }
+    }
+    free_table(&t);
+
+    /* 0.1 repeated, with +1e15 and -1e15 in pairs 1000 rows apart, so the
+     * big cells cancel and the exact total is 0.1 (the double nearest it)
+     * times the number of small cells. */
+    init_table(&t);
+    table_add_column(&t, "x");
+    int big = 0;
+    for (int i = 0; i < rows; i++) {
+        const char *v = "0.1";
+        if (i % 2000 == 999 && i + 1000 < rows) v = "1e15";
+        else if (i % 2000 == 1999) v = "-1e15";
+        if (v[0] != '0') big++;
+        if (!table_append_row(&t, &v, 1)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+    }
+    table_infer_types(&t);
+    long double exact = (long double)0.1 * (rows - big);
+    ColumnStats old;
+    three_passes(&t, 0, &old);
+    printf("Sum of 0.1 repeated with +-1e15 mixed in, %d rows: exact %.6Lf\n", rows, exact);
+    printf("  %-20s %.6f  (off by %.3g)\n", "plain loop", old.sum, (double)((long double)old.sum - exact));
+    for (int k = 0; k < 2; k++) {
+        if (!kernels[k]) continue;
+        stats_kernels = kernels[k];
+        ColumnStats s;
+        column_stats(&t, 0, &s);
+        printf("  %-20s %.6f  (off by %.3g)\n", kernels[k]->name, s.sum, (double)((long double)s.sum - exact));
+    }
+    stats_kernels = NULL;
+    free_table(&t);
+    return 0;
+}
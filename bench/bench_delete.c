@@ -0,0 +1,223 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Deleting rows one at a time.
+ *
+ * The old delete shifted every later row up by one in every column, so
+ * purging rows from the front of a large table is quadratic; it is
+ * reimplemented here and timed on small purges only. Tombstones with
+ * batched compaction (table_delete_row()) are timed on the same purges and
+ * on purging half the table, also with a hash index on the id column. Both
+ * must leave the same rows.
+ *
+ * Then DELETE and UPDATE ... WHERE region = value: one matching row per
+ * round trip (find_row_index_by_value(), then the single-row change, as
+ * the "1 row" menu options do), timed on the first few thousand matches,
+ * against one selection pass and one set-based change to every match.
+ *
+ * Last, GROUP BY, which skips tombstones through the bitmap, and SUM,
+ * which needs no check, are timed over the table with a fifth of its rows
+ * left as tombstones, and again after compacting.
+ *
+ * Usage: ./bench_delete [rows]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char *const regions[] = { "north", "south", "east", "west", "central" };
+
+/* id: INT64, region: text, amount: DOUBLE. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "id") || !table_add_column(t, "region") ||
+        !table_add_column(t, "amount")) {
+        return 0;
+    }
+    char id[16], amount[32];
+    uint32_t seed = 7;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(id, sizeof(id), "%d", i);
+        snprintf(amount, sizeof(amount), "%u.%02u", (seed >> 8) % 10000, seed % 100);
+        const char *values[3] = { id, regions[(seed >> 20) % 5], amount };
+        if (!table_append_row(t, values, 3)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* The old delete: every later row moves up one, in every column. */
+static void shift_delete_row(Table *t, int row) {
+    size_t tail = (size_t)(t->row_count - 1 - row);
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        table_release_cell(t, col->cells[row]);
+        memmove(&col->cells[row], &col->cells[row + 1], tail * sizeof(Cell));
+        if (col->type == COL_STRING) continue;
+        memmove(&col->valid[row], &col->valid[row + 1], tail);
+        if (col->type == COL_INT64) {
+            memmove(&col->ints[row], &col->ints[row + 1], tail * sizeof(int64_t));
+        } else {
+            memmove(&col->nums[row], &col->nums[row + 1], tail * sizeof(double));
+        }
+    }
+    t->row_count--;
+}
+
+/* Checksum of the live ids, in row order. */
+static long live_ids(const Table *t) {
+    long sum = 0;
+    for (int r = table_next_live(t, 0); r < t->row_count; r = table_next_live(t, r + 1)) {
+        sum = sum * 31 + t->cols[0].ints[r];
+    }
+    return sum;
+}
+
+/* Delete the first live row `count` times. */
+static double purge(Table *t, int count, int tombstones) {
+    double t0 = now_sec();
+    for (int i = 0; i < count; i++) {
+        if (!tombstones) shift_delete_row(t, 0);
+        else if (!table_delete_row(t, table_next_live(t, 0))) return -1.0;
+    }
+    return now_sec() - t0;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (rows <= 0) rows = 1000000;
+
+    printf("Deleting the first row of %d rows, again and again\n", rows);
+    const int counts[] = { 100, 1000, 10000, rows / 2 };
+    for (int indexed = 0; indexed <= 1; indexed++) {
+        printf("  %s\n", indexed ? "CREATE INDEX on id (tombstones only)" : "no index");
+        for (int k = 0; k < 4; k++) {
+            int count = counts[k];
+            if (count > rows || (k > 0 && count <= counts[k - 1])) continue;
+            Table t;
+            if (!build_table(&t, rows)) {
+                fprintf(stderr, "Out of memory building table.\n");
+                return 1;
+            }
+            /* The old delete is quadratic: small purges only. */
+            double shifted = -1.0;
+            long expected = 0;
+            if (!indexed && count <= 1000) {
+                shifted = purge(&t, count, 0);
+                expected = live_ids(&t);
+                free_table(&t);
+                build_table(&t, rows);
+            }
+            if (indexed) table_create_index(&t, 0);
+            double tombstoned = purge(&t, count, 1);
+            if (tombstoned < 0) {
+                fprintf(stderr, "Out of memory deleting.\n");
+                return 1;
+            }
+            char old[32] = "         -";
+            if (shifted >= 0) snprintf(old, sizeof(old), "%10.2f", shifted * 1e3);
+            printf("    %8d deletes  shift %s ms  tombstones %9.2f ms  (%d not compacted)  %s\n",
+                   count, old, tombstoned * 1e3, t.dead_count,
+                   shifted < 0 ? "" : live_ids(&t) == expected ? "identical" : "MISMATCH");
+            free_table(&t);
+        }
+    }
+
+    printf("WHERE region = value on %d rows (about a fifth match)\n", rows);
+    for (int update = 0; update <= 1; update++) {
+        const char *label = update ? "UPDATE SET region = 'n'" : "DELETE";
+        Table t;
+        if (!build_table(&t, rows)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+        int loops = rows / 500 < 2000 ? rows / 500 : 2000;
+        double t0 = now_sec();
+        for (int i = 0; i < loops; i++) {
+            int row = find_row_index_by_value(&t, 1, "north");
+            if (row < 0) break;
+            if (!update) {
+                table_delete_row(&t, row);
+            } else {
+                table_release_cell(&t, t.cols[1].cells[row]);
+                table_set_cell(&t, row, 1, arena_cell(&t.strings, "n", 1));
+            }
+        }
+        double one = (now_sec() - t0) / loops;
+        free_table(&t);
+        build_table(&t, rows);
+
+        t0 = now_sec();
+        int *selected;
+        int n = table_select_equal(&t, 1, "north", &selected);
+        double t1 = now_sec();
+        const char *set[3] = { NULL, "n", NULL };
+        int ok = n >= 0 && (update ? table_update_rows(&t, selected, n, set)
+                                   : table_delete_rows(&t, selected, n));
+        double t2 = now_sec();
+        if (!ok) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+        free(selected);
+        int *left;
+        int remaining = table_select_equal(&t, 1, "north", &left);
+        free(left);
+        printf("  %-24s one row per round trip %7.3f ms/row (all %d: at least ~%.0f ms)\n", label,
+               one * 1e3, n, one * n * 1e3);
+        printf("  %-24s set-based %9.2f ms  (select %.2f ms, apply %.2f ms)  %s\n", "", (t2 - t0) * 1e3,
+               (t1 - t0) * 1e3, (t2 - t1) * 1e3, remaining == 0 ? "ok" : "ROWS LEFT");
+        free_table(&t);
+    }
+
+    printf("Scans over %d rows with a fifth of them deleted\n", rows);
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    tombstone_min_dead = INT_MAX;
+    for (int r = 0; r < rows; r += 5) table_delete_row(&t, r);
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+    int key = 1, value = 2;
+    for (int pass = 0; pass < 2; pass++) {
+        double t0 = now_sec();
+        Aggregate agg;
+        if (!table_aggregate(&agg, &t, &key, 1, &value, 1)) {
+            fprintf(stderr, "Out of memory grouping.\n");
+            return 1;
+        }
+        double grouped = now_sec() - t0;
+        t0 = now_sec();
+        /* As sum_avg_column() does it: tombstones hold no value. */
+        double sum = 0.0;
+        const Column *amount = &t.cols[2];
+        for (int r = 0; r < t.row_count; r++) {
+            if (amount->valid[r]) sum += amount->nums[r];
+        }
+        double summed = now_sec() - t0;
+        printf("  %-22s GROUP BY region %8.2f ms  SUM(amount) %7.2f ms  (%d groups, sum %.2f)\n",
+               pass ? "after compaction" : "with tombstones", grouped * 1e3, summed * 1e3,
+               agg.groups, sum);
+        agg_free(&agg);
+        if (pass == 0) {
+            t0 = now_sec();
+            table_compact_rows(&t);
+            printf("  %-22s %8.2f ms\n", "compaction", (now_sec() - t0) * 1e3);
+        }
+    }
+    free_table(&t);
+    return 0;
+}
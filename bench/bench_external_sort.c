@@ -0,0 +1,132 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * External sort of a CSV file.
+ *
+ * A CSV file of region, date, customer, amount and qty columns is
+ * written to $TMPDIR (or /tmp), then sorted by region, date, amount DESC
+ * with external_sort_csv() under memory budgets from eight times the
+ * file's size (sorted in memory) down to 1/64 of it, and once by loading
+ * it, table_sort() and save_csv(). Every output must be byte for byte the
+ * same.
+ *
+ * Usage: ./bench_external_sort [rows]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char *const regions[] = { "north", "south", "east", "west", "central" };
+
+static void temp_path(char *path, size_t size, const char *name) {
+    const char *dir = getenv("TMPDIR");
+    snprintf(path, size, "%s/%s", dir && *dir ? dir : "/tmp", name);
+}
+
+static int write_input(const char *path, int rows) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    fprintf(f, "region,date,customer,amount,qty\n");
+    uint32_t seed = 7;
+    for (int i = 0; i < rows; i++) {
+        uint32_t a = seed = seed * 1103515245u + 12345u;
+        uint32_t b = seed = seed * 1103515245u + 12345u;
+        uint32_t c = seed = seed * 1103515245u + 12345u;
+        fprintf(f, "%s,2024-%02u-%02u,\"customer, %07u\",%u.%02u,%u\n", regions[(a >> 8) % 5],
+                1 + (a >> 16) % 12, 1 + (b >> 8) % 28, (b >> 4) % 5000000, (c >> 8) % 10000,
+                c % 100, (c >> 20) % 50);
+    }
+    return fclose(f) == 0;
+}
+
+/* FNV-1a of the file, or 0 when it cannot be read. */
+static uint64_t file_hash(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    uint64_t h = 1469598103934665603ULL;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (size_t i = 0; i < n; i++) h = (h ^ (unsigned char)buf[i]) * 1099511628211ULL;
+    }
+    fclose(f);
+    return h;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 2000000;
+    if (rows <= 0) rows = 2000000;
+
+    char input[4096], output[4096];
+    temp_path(input, sizeof(input), "bench_external_sort_in.csv");
+    temp_path(output, sizeof(output), "bench_external_sort_out.csv");
+    if (!write_input(input, rows)) {
+        fprintf(stderr, "Cannot write %s.\n", input);
+        return 1;
+    }
+    struct stat st;
+    stat(input, &st);
+    size_t file_size = (size_t)st.st_size;
+    const char *order_by = "0, 1, 3 DESC";
+    printf("ORDER BY region, date, amount DESC on %d rows (%.1f MB of CSV)\n", rows, file_size / 1e6);
+
+    /* In memory: load, sort, save. */
+    FILE *devnull = fopen("/dev/null", "w");
+    FILE *orig_stdout = stdout;
+    Table t;
+    init_table(&t);
+    double t0 = now_sec();
+    stdout = devnull;
+    int loaded = load_csv(input, &t);
+    stdout = orig_stdout;
+    SortKey keys[SORT_MAX_KEYS];
+    int count = parse_order_by(&t, order_by, keys, SORT_MAX_KEYS);
+    if (!loaded || count <= 0 || !table_sort(&t, keys, count)) {
+        fprintf(stderr, "Cannot load and sort %s.\n", input);
+        return 1;
+    }
+    stdout = devnull;
+    save_csv(output, &t);
+    stdout = orig_stdout;
+    double elapsed = now_sec() - t0;
+    free_table(&t);
+    uint64_t expected = file_hash(output);
+    printf("  %-24s %9.2f ms\n", "load + sort + save", elapsed * 1e3);
+
+    for (size_t div = 1; div <= 512; div *= 8) {
+        size_t memory = file_size * 8 / div;
+        FILE *in = fopen(input, "r");
+        FILE *out = fopen(output, "w");
+        if (!in || !out) {
+            fprintf(stderr, "Cannot open %s or %s.\n", input, output);
+            return 1;
+        }
+        ExtSortStats stats;
+        t0 = now_sec();
+        int ok = external_sort_csv(in, out, order_by, memory, &stats);
+        fclose(in);
+        ok = fclose(out) == 0 && ok;
+        elapsed = now_sec() - t0;
+        if (!ok) return 1;
+        char label[64];
+        snprintf(label, sizeof(label), "budget %.1f MB", memory / 1e6);
+        printf("  %-24s %9.2f ms  %4zu runs, %d merge passes  %s\n", label, elapsed * 1e3,
+               stats.runs, stats.passes, file_hash(output) == expected ? "identical" : "MISMATCH");
+    }
+
+    fclose(devnull);
+    remove(input);
+    remove(output);
+    return 0;
+}
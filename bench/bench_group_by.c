@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * GROUP BY / DISTINCT by hash aggregation.
+ *
+ * For key columns with few to many distinct values, the old grouping
+ * (every row compared against each group found so far) is timed against
+ * table_aggregate() on 1, 2, 4, ... threads, and sorting the groups for
+ * ordered output is timed on its own. Every run must produce the same
+ * groups and counts as the serial one. The old grouping is skipped once
+ * it would take minutes.
+ *
+ * Then COUNT, SUM, AVG, MIN and MAX over two numeric columns, grouped by
+ * one and by two key columns, are computed in one fused pass and, for
+ * comparison, one pass per aggregated column.
+ *
+ * Usage: ./bench_group_by [rows] [max_threads]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const int group_counts[] = { 10, 1000, 100000, 1000000 };
+#define KEY_COLS ((int)(sizeof(group_counts) / sizeof(group_counts[0])))
+
+/* KEY_COLS key columns, then two numeric columns. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    char names[KEY_COLS + 2][16], keys[KEY_COLS + 2][32];
+    const char *values[KEY_COLS + 2];
+    for (int c = 0; c < KEY_COLS + 2; c++) {
+        if (c < KEY_COLS) snprintf(names[c], sizeof(names[c]), "k%d", group_counts[c]);
+        else snprintf(names[c], sizeof(names[c]), "%s", c == KEY_COLS ? "amount" : "qty");
+        if (!table_add_column(t, names[c])) return 0;
+        values[c] = keys[c];
+    }
+    uint32_t seed = 42;
+    for (int i = 0; i < rows; i++) {
+        for (int c = 0; c < KEY_COLS; c++) {
+            seed = seed * 1103515245u + 12345u;
+            snprintf(keys[c], sizeof(keys[c]), "key-%u", (seed >> 4) % (uint32_t)group_counts[c]);
+        }
+        snprintf(keys[KEY_COLS], sizeof(keys[0]), "%u.%02u", (seed >> 8) % 100000, seed % 100);
+        snprintf(keys[KEY_COLS + 1], sizeof(keys[0]), "%u", (seed >> 12) % 1000);
+        if (!table_append_row(t, values, KEY_COLS + 2)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* The old grouping: a linear search of the groups so far for every row. */
+static int linear_groups(const Table *t, int col, long *checksum) {
+    Cell *groups = (Cell *)malloc((size_t)t->row_count * sizeof(Cell));
+    int *counts = (int *)malloc((size_t)t->row_count * sizeof(int));
+    int n = 0;
+    const Cell *cells = t->cols[col].cells;
+    for (int r = 0; r < t->row_count; r++) {
+        int g = 0;
+        while (g < n && cell_compare(groups[g], cells[r]) != 0) g++;
+        if (g == n) {
+            groups[n] = cells[r];
+            counts[n++] = 0;
+        }
+        counts[g]++;
+    }
+    *checksum = 0;
+    for (int g = 0; g < n; g++) *checksum = *checksum * 31 + counts[g];
+    free(groups);
+    free(counts);
+    return n;
+}
+
+static long agg_checksum(const Aggregate *a) {
+    long sum = 0;
+    for (int g = 0; g < a->groups; g++) sum = sum * 31 + a->counts[g];
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 2000000;
+    long max_threads = argc > 2 ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (rows <= 0) rows = 2000000;
+    if (max_threads <= 0) max_threads = 1;
+    if (max_threads > CSV_MAX_THREADS) max_threads = CSV_MAX_THREADS;
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("GROUP BY on %d rows, up to %ld threads (%ld CPUs online)\n",
+           rows, max_threads, sysconf(_SC_NPROCESSORS_ONLN));
+
+    for (int c = 0; c < KEY_COLS; c++) {
+        printf("  ~%d groups\n", group_counts[c]);
+        long expected = 0;
+        if ((double)rows * group_counts[c] <= 2e10) {
+            double t0 = now_sec();
+            int n = linear_groups(&t, c, &expected);
+            printf("    linear scan  %10.2f ms  %d groups\n", (now_sec() - t0) * 1e3, n);
+        } else {
+            printf("    linear scan  skipped\n");
+        }
+
+        double base = 0.0;
+        for (long threads = 1; threads <= max_threads; threads *= 2) {
+            csv_load_threads = (int)threads;
+            Aggregate agg;
+            double t0 = now_sec();
+            if (!table_aggregate(&agg, &t, &c, 1, NULL, 0)) {
+                fprintf(stderr, "Out of memory aggregating.\n");
+                return 1;
+            }
+            double elapsed = now_sec() - t0;
+            if (threads == 1) {
+                base = elapsed;
+                if (expected == 0) expected = agg_checksum(&agg);
+            }
+            printf("    hash %3ld thr %10.2f ms  %d groups  speedup %.2fx  %s\n", threads,
+                   elapsed * 1e3, agg.groups, base / elapsed,
+                   agg_checksum(&agg) == expected ? "identical" : "MISMATCH");
+            if (threads == max_threads) {
+                t0 = now_sec();
+                int *order = agg_sorted_groups(&agg);
+                printf("    sort groups  %10.2f ms\n", (now_sec() - t0) * 1e3);
+                free(order);
+            }
+            agg_free(&agg);
+            if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+        }
+    }
+
+    /* Five aggregates over two columns: one fused pass vs. one pass per column. */
+    csv_load_threads = 1;
+    int value_cols[2] = { KEY_COLS, KEY_COLS + 1 };
+    int key_sets[2][2] = { { 0, 0 }, { 0, 1 } };
+    for (int k = 1; k <= 2; k++) {
+        Aggregate agg;
+        double t0 = now_sec();
+        if (!table_aggregate(&agg, &t, key_sets[k - 1], k, NULL, 0)) return 1;
+        double count_only = now_sec() - t0;
+        agg_free(&agg);
+
+        t0 = now_sec();
+        if (!table_aggregate(&agg, &t, key_sets[k - 1], k, value_cols, 2)) return 1;
+        double fused = now_sec() - t0;
+        double fused_sum;
+        agg_result(&agg, 0, 1, AGG_SUM, &fused_sum);
+        int groups = agg.groups;
+        agg_free(&agg);
+
+        t0 = now_sec();
+        double split_sum = 0.0;
+        for (int v = 0; v < 2; v++) {
+            if (!table_aggregate(&agg, &t, key_sets[k - 1], k, &value_cols[v], 1)) return 1;
+            if (v == 1) agg_result(&agg, 0, 0, AGG_SUM, &split_sum);
+            agg_free(&agg);
+        }
+        double split = now_sec() - t0;
+        printf("  %d key column(s), %d groups, COUNT/SUM/AVG/MIN/MAX of 2 columns\n", k, groups);
+        printf("    COUNT only   %10.2f ms\n", count_only * 1e3);
+        printf("    fused pass   %10.2f ms\n", fused * 1e3);
+        printf("    pass/column  %10.2f ms  %s\n", split * 1e3,
+               fused_sum == split_sum ? "identical" : "MISMATCH");
+    }
+
+    free_table(&t);
+    return 0;
+}
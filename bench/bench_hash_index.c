@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Keyed point lookups and updates, with and without CREATE INDEX.
+ *
+ * Each operation is what "Update 1 row (WHERE col = value)" does:
+ * find_row_index_by_value() on the key column, then table_set_cell() on
+ * another column. The indexed run is checked to hit the same rows as the
+ * scan.
+ *
+ * Usage: ./bench_hash_index [rows] [ops]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "key") || !table_add_column(t, "value")) return 0;
+    char key[32];
+    for (int i = 0; i < rows; i++) {
+        snprintf(key, sizeof(key), "user%08d", i);
+        const char *values[2] = { key, "0" };
+        if (!table_append_row(t, values, 2)) return 0;
+    }
+    return 1;
+}
+
+/* Run `ops` keyed updates; returns a checksum of the rows touched. */
+static long run_updates(Table *t, int ops, double *elapsed) {
+    char key[32];
+    long sum = 0;
+    uint32_t seed = 12345;
+    double t0 = now_sec();
+    for (int i = 0; i < ops; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(key, sizeof(key), "user%08d", (int)(seed % (uint32_t)t->row_count));
+        int row = find_row_index_by_value(t, 0, key);
+        if (row < 0) continue;
+        table_set_cell(t, row, 1, arena_cell(&t->strings, "1", 1));
+        sum += row;
+    }
+    *elapsed = now_sec() - t0;
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 1000000;
+    int ops = argc > 2 ? atoi(argv[2]) : 2000;
+    if (rows <= 0) rows = 1000000;
+    if (ops <= 0) ops = 2000;
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("%d keyed updates on %d rows\n", ops, rows);
+
+    double scan_time, index_time;
+    long scan_sum = run_updates(&t, ops, &scan_time);
+
+    double t0 = now_sec();
+    if (!table_create_index(&t, 0)) {
+        fprintf(stderr, "Out of memory building index.\n");
+        return 1;
+    }
+    double build_time = now_sec() - t0;
+    long index_sum = run_updates(&t, ops, &index_time);
+
+    printf("  scan     %10.2f us/op %12.0f ops/s\n", scan_time * 1e6 / ops, ops / scan_time);
+    printf("  index    %10.2f us/op %12.0f ops/s  speedup %.0fx  %s\n", index_time * 1e6 / ops,
+           ops / index_time, scan_time / index_time, scan_sum == index_sum ? "identical" : "MISMATCH");
+    printf("  CREATE INDEX %.2f ms\n", build_time * 1e3);
+
+    free_table(&t);
+    return 0;
+}
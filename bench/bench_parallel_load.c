@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Parallel load scaling.
+ *
+ * The same in-memory CSV image (quoted fields, embedded commas and line
+ * breaks included) is loaded with load_csv_buffer() at 1, 2, 4, ... up
+ * to the requested number of threads. Every run is checked against the
+ * single-threaded table with an order-sensitive checksum, so the speedup
+ * column only ever compares identical results.
+ *
+ * Usage: ./bench_parallel_load [megabytes] [max_threads]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char *make_csv(size_t target, size_t *out_size) {
+    static const char *words[] = { "north", "south", "east", "west", "central" };
+    char *buf = (char *)malloc(target + 256);
+    if (!buf) return NULL;
+    size_t n = (size_t)sprintf(buf, "id,name,region,amount,qty,note\n");
+    srand(42);
+    for (long id = 0; n < target; id++) {
+        int r = rand();
+        n += (size_t)sprintf(buf + n, "%ld,\"user, %d\",%s,%d.%02d,%d,%s\n",
+                             id, rand() % 100000, words[r % 5],
+                             rand() % 100000, rand() % 100, rand() % 1000,
+                             (r & 8) ? "\"two\nlines\"" : "ok");
+    }
+    *out_size = n;
+    return buf;
+}
+
+/* FNV-1a over every cell in row order. */
+static uint64_t table_checksum(const Table *t) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int r = 0; r < t->row_count; r++) {
+        for (int c = 0; c < t->col_count; c++) {
+            Cell cell = table_cell(t, r, c);
+            for (size_t i = 0; i < cell.len; i++) {
+                h = (h ^ (unsigned char)cell.ptr[i]) * 1099511628211ULL;
+            }
+            h = (h ^ (cell.ptr ? 0x1f : 0x2f)) * 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+int main(int argc, char **argv) {
+    long mb = argc > 1 ? atol(argv[1]) : 512;
+    long max_threads = argc > 2 ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (mb <= 0) mb = 512;
+    if (max_threads <= 0) max_threads = 1;
+    if (max_threads > CSV_MAX_THREADS) max_threads = CSV_MAX_THREADS;
+    const int reps = 3;
+
+    size_t size;
+    char *data = make_csv((size_t)mb << 20, &size);
+    if (!data) {
+        fprintf(stderr, "Out of memory building input.\n");
+        return 1;
+    }
+    printf("Loading %.1f MB of CSV on up to %ld threads, %ld CPUs online (best of %d)\n",
+           (double)size / (1 << 20), max_threads, sysconf(_SC_NPROCESSORS_ONLN), reps);
+
+    FILE *devnull = fopen("/dev/null", "w");
+    double base = 0.0;
+    uint64_t expected = 0;
+    for (long threads = 1; threads <= max_threads; threads *= 2) {
+        csv_load_threads = (int)threads;
+        double best = 1e30;
+        int rows = 0;
+        uint64_t sum = 0;
+        for (int rep = 0; rep < reps; rep++) {
+            Table t;
+            init_table(&t);
+            FILE *orig_stdout = stdout;
+            if (devnull) stdout = devnull;
+            double t0 = now_sec();
+            load_csv_buffer(&t, data, size);
+            double elapsed = now_sec() - t0;
+            stdout = orig_stdout;
+            if (elapsed < best) best = elapsed;
+            if (rep == 0) {
+                rows = t.row_count;
+                sum = table_checksum(&t);
+            }
+            free_table(&t);
+        }
+        if (threads == 1) {
+            base = best;
+            expected = sum;
+        }
+        printf("  %3ld threads  %9.2f ms  %6.2f GB/s  speedup %5.2fx  %d rows  %s\n",
+               threads, best * 1e3, (double)size / best / 1e9, base / best, rows,
+               sum == expected ? "identical" : "MISMATCH");
+        if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+    }
+
+    if (devnull) fclose(devnull);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Number parsing throughput: parse_cell_double() vs. the strtod() route
+ * it replaced, and parse_cell_int64() on integer cells.
+ *
+ * Each input set is a packed buffer of cell views of one typical CSV
+ * shape. Every value is checked bit for bit against strtod() before
+ * timing, so the speedup column only ever compares identical results.
+ *
+ * Usage: ./bench_parse_number [values]
+ */
+
+typedef struct {
+    const char *name;
+    Cell *cells;
+    size_t bytes;
+} InputSet;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* The old parse_cell_double(): copy out and let strtod() decide. */
+static int parse_cell_strtod(Cell c, double *out) {
+    if (!c.ptr || c.len == 0) return 0;
+    char buf[64];
+    if (c.len >= sizeof(buf)) return 0;
+    memcpy(buf, c.ptr, c.len);
+    buf[c.len] = '\0';
+    char *end = NULL;
+    double v = strtod(buf, &end);
+    if (end == buf || *end != '\0') return 0;
+    *out = v;
+    return 1;
+}
+
+static uint64_t next_random(uint64_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static void make_value(int kind, uint64_t *seed, char *buf, size_t cap) {
+    uint64_t r = next_random(seed);
+    switch (kind) {
+    case 0: snprintf(buf, cap, "%llu", (unsigned long long)(r % 1000000)); break;
+    case 1: snprintf(buf, cap, "%llu.%02llu", (unsigned long long)(r % 100000),
+                     (unsigned long long)((r >> 32) % 100)); break;
+    case 2: snprintf(buf, cap, "%.6e", (double)(r % 1000000007) * 1e-12); break;
+    case 3: {
+        double d = (double)(r >> 11) / (double)(1ULL << 53) * 1000.0;
+        snprintf(buf, cap, "%.17g", d);
+        break;
+    }
+    default: snprintf(buf, cap, "user%llu", (unsigned long long)(r % 100000)); break;
+    }
+}
+
+static int make_set(InputSet *set, const char *name, int kind, size_t n, Arena *arena) {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL + (uint64_t)kind;
+    set->name = name;
+    set->bytes = 0;
+    set->cells = (Cell *)malloc(n * sizeof(Cell));
+    if (!set->cells) return 0;
+    for (size_t i = 0; i < n; i++) {
+        char buf[64];
+        make_value(kind, &seed, buf, sizeof(buf));
+        set->cells[i] = arena_cell(arena, buf, strlen(buf));
+        set->bytes += set->cells[i].len;
+        double a = 0.0, b = 0.0;
+        int ok_a = parse_cell_double(set->cells[i], &a);
+        int ok_b = parse_cell_strtod(set->cells[i], &b);
+        if (ok_a != ok_b || (ok_a && memcmp(&a, &b, sizeof(a)) != 0)) {
+            fprintf(stderr, "MISMATCH on %s\n", buf);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static double time_doubles(const InputSet *set, size_t n, int fast, double *sink) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        double acc = 0.0;
+        double t0 = now_sec();
+        for (size_t i = 0; i < n; i++) {
+            double v;
+            int ok = fast ? parse_cell_double(set->cells[i], &v) : parse_cell_strtod(set->cells[i], &v);
+            if (ok) acc += v;
+        }
+        double elapsed = now_sec() - t0;
+        if (elapsed < best) best = elapsed;
+        *sink += acc;
+    }
+    return best;
+}
+
+static double time_ints(const InputSet *set, size_t n, int64_t *sink) {
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++) {
+        int64_t acc = 0;
+        double t0 = now_sec();
+        for (size_t i = 0; i < n; i++) {
+            int64_t v;
+            if (parse_cell_int64(set->cells[i], &v)) acc += v;
+        }
+        double elapsed = now_sec() - t0;
+        if (elapsed < best) best = elapsed;
+        *sink += acc;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? (size_t)atol(argv[1]) : 1000000;
+    if (n == 0) n = 1000000;
+
+    static const char *names[] = { "integers", "money", "scientific", "17 digits", "text" };
+    InputSet sets[5];
+    Arena arena;
+    arena_init(&arena);
+    for (int k = 0; k < 5; k++) {
+        if (!make_set(&sets[k], names[k], k, n, &arena)) return 1;
+    }
+
+    double dsink = 0.0;
+    int64_t isink = 0;
+    printf("Parsing %zu values per set (best of 5)\n", n);
+    printf("  %-11s %10s %10s %10s %8s\n", "set", "strtod", "parse", "MB/s", "speedup");
+    for (int k = 0; k < 5; k++) {
+        double slow = time_doubles(&sets[k], n, 0, &dsink);
+        double fast = time_doubles(&sets[k], n, 1, &dsink);
+        printf("  %-11s %7.2f ns %7.2f ns %10.1f %7.2fx\n", sets[k].name,
+               slow * 1e9 / (double)n, fast * 1e9 / (double)n,
+               (double)sets[k].bytes / fast / 1e6, slow / fast);
+    }
+    double ints = time_ints(&sets[0], n, &isink);
+    printf("  %-11s %10s %7.2f ns %10.1f   (parse_cell_int64)\n", "integers", "",
+           ints * 1e9 / (double)n, (double)sets[0].bytes / ints / 1e6);
+    printf("(checksum %g %lld)\n", dsink, (long long)isink);
+
+    for (int k = 0; k < 5; k++) free(sets[k].cells);
+    arena_free(&arena);
+    return 0;
+}
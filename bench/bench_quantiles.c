@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * p50 / p90 / p95 / p99 / p99.9 of one numeric column.
+ *
+ * The workaround was to sort the table by the column (sort_by_column(),
+ * i.e. table_sort()) and read the rows at the ranks. It is timed against
+ * column_quantiles(), which selects the ranks in a copy of the column,
+ * and against column_quantiles_approx() (one pass into a t-digest) at
+ * several compressions, on a long-tailed "latency" column of doubles and
+ * an int64 column. The t-digest's error is shown as the distance in rank
+ * from the exact answer, in percent of the rows.
+ *
+ * Usage: ./bench_quantiles [rows]
+ */
+
+#define PCOUNT 5
+
+static const double percents[PCOUNT] = { 50, 90, 95, 99, 99.9 };
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* latency_ms: DOUBLE, a long tail (the cube of a uniform value);
+ * bytes: INT64, uniform. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "latency_ms") || !table_add_column(t, "bytes")) return 0;
+    char latency[32], bytes[32];
+    uint32_t seed = 11;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        double u = (double)(seed >> 8) / 16777216.0;
+        snprintf(latency, sizeof(latency), "%.3f", 0.5 + 2000.0 * u * u * u);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(bytes, sizeof(bytes), "%u", seed >> 4);
+        const char *values[2] = { latency, bytes };
+        if (!table_append_row(t, values, 2)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* Rank of v among the sorted column, in percent of the rows. */
+static double rank_percent(const Table *sorted, int col, double v) {
+    int lo = 0, hi = sorted->row_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        double x;
+        table_cell_number(sorted, mid, col, &x);
+        if (x < v) lo = mid + 1;
+        else hi = mid;
+    }
+    return 100.0 * (double)lo / (double)(sorted->row_count - 1);
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (rows <= 1) rows = 10000000;
+
+    double qs[PCOUNT];
+    for (int i = 0; i < PCOUNT; i++) qs[i] = percents[i] / 100.0;
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("p50 / p90 / p95 / p99 / p99.9 over %d rows\n", rows);
+    double exact[2][PCOUNT];
+    for (int col = 0; col < 2; col++) {
+        printf("  %s column\n", col == 0 ? "double (latency_ms)" : "int64 (bytes)");
+        double t0 = now_sec();
+        if (column_quantiles(&t, col, qs, PCOUNT, exact[col]) != rows) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+        printf("    %-28s %8.2f ms ", "exact (introselect)", (now_sec() - t0) * 1e3);
+        for (int i = 0; i < PCOUNT; i++) printf(" p%g %.3f", percents[i], exact[col][i]);
+        printf("\n");
+        static const int compressions[] = { 50, 100, 200, 400 };
+        for (int k = 0; k < 4; k++) {
+            double approx[PCOUNT];
+            t0 = now_sec();
+            column_quantiles_approx(&t, col, compressions[k], qs, PCOUNT, approx);
+            double elapsed = now_sec() - t0;
+            char label[64];
+            snprintf(label, sizeof(label), "t-digest, compression %d", compressions[k]);
+            printf("    %-28s %8.2f ms ", label, elapsed * 1e3);
+            for (int i = 0; i < PCOUNT; i++) printf(" p%g %.3f", percents[i], approx[i]);
+            printf("\n");
+        }
+    }
+
+    /* The old route, last since it reorders the table: sort, then read
+     * the values at the ranks, and show each t-digest's rank error. */
+    for (int col = 0; col < 2; col++) {
+        SortKey key = { col, 1 };
+        double t0 = now_sec();
+        if (!table_sort(&t, &key, 1)) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+        double elapsed = now_sec() - t0;
+        int same = 1;
+        for (int i = 0; i < PCOUNT; i++) {
+            double h = qs[i] * (double)(rows - 1), a, b;
+            int r = (int)h;
+            table_cell_number(&t, r, col, &a);
+            table_cell_number(&t, r + 1 < rows ? r + 1 : r, col, &b);
+            if (quantile_lerp(a, b, h - (double)r) != exact[col][i]) same = 0;
+        }
+        printf("  %s column: sort_by_column() + read ranks %8.2f ms  %s\n",
+               col == 0 ? "double" : "int64", elapsed * 1e3, same ? "same values" : "MISMATCH");
+        static const int compressions[] = { 50, 100, 200, 400 };
+        for (int k = 0; k < 4; k++) {
+            double approx[PCOUNT];
+            column_quantiles_approx(&t, col, compressions[k], qs, PCOUNT, approx);
+            printf("    t-digest %3d rank error:", compressions[k]);
+            for (int i = 0; i < PCOUNT; i++) {
+                printf(" p%g %+.4f%%", percents[i], rank_percent(&t, col, approx[i]) - percents[i]);
+            }
+            printf("\n");
+        }
+    }
+    free_table(&t);
+    return 0;
+}
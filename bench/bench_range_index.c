@@ -0,0 +1,104 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * BETWEEN on a numeric column: full scan vs. CREATE ORDERED INDEX.
+ *
+ * Values are uniform in [0, 1e6), and every query asks for a window of
+ * width 1000, i.e. 0.1% of the rows. The indexed run must return exactly
+ * the rows of the scan. A second indexed run interleaves one keyed update
+ * per query to show the cost of the batched maintenance.
+ *
+ * Usage: ./bench_range_index [rows] [queries]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t next_random(uint32_t *s) {
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 1;
+}
+
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "amount")) return 0;
+    uint32_t seed = 42;
+    char buf[32];
+    for (int i = 0; i < rows; i++) {
+        snprintf(buf, sizeof(buf), "%u.%02u", next_random(&seed) % 1000000, next_random(&seed) % 100);
+        const char *values[1] = { buf };
+        if (!table_append_row(t, values, 1)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* `queries` BETWEEN lookups (plus one update each if `updates`); returns
+ * a checksum of the matching rows. */
+static uint64_t run_queries(Table *t, int queries, int updates, int *out, double *elapsed) {
+    uint32_t seed = 7;
+    uint64_t sum = 0;
+    double t0 = now_sec();
+    for (int q = 0; q < queries; q++) {
+        double lo = (double)(next_random(&seed) % 999000);
+        int n = find_rows_in_range(t, 0, lo, lo + 1000.0, out, t->row_count);
+        for (int i = 0; i < n; i++) sum += (uint64_t)out[i] * (uint64_t)(q + 1);
+        if (updates) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%u", next_random(&seed) % 1000000);
+            table_set_cell(t, (int)(next_random(&seed) % (uint32_t)t->row_count), 0,
+                           arena_cell(&t->strings, buf, strlen(buf)));
+        }
+    }
+    *elapsed = now_sec() - t0;
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 10000000;
+    int queries = argc > 2 ? atoi(argv[2]) : 100;
+    if (rows <= 0) rows = 10000000;
+    if (queries <= 0) queries = 100;
+
+    Table t;
+    int *out = (int *)malloc((size_t)rows * sizeof(int));
+    if (!out || !build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("%d BETWEEN queries at 0.1%% selectivity on %d rows\n", queries, rows);
+
+    double scan_time, index_time, mixed_time;
+    uint64_t scan_sum = run_queries(&t, queries, 0, out, &scan_time);
+
+    double t0 = now_sec();
+    if (!table_create_range_index(&t, 0)) {
+        fprintf(stderr, "Out of memory building index.\n");
+        return 1;
+    }
+    double build_time = now_sec() - t0;
+    uint64_t index_sum = run_queries(&t, queries, 0, out, &index_time);
+    run_queries(&t, queries * 100, 1, out, &mixed_time);
+
+    printf("  scan          %10.1f us/query\n", scan_time * 1e6 / queries);
+    printf("  index         %10.1f us/query  speedup %.0fx  %s\n", index_time * 1e6 / queries,
+           scan_time / index_time, scan_sum == index_sum ? "identical" : "MISMATCH");
+    printf("  index+update  %10.1f us/query (one update per query, %d queries)\n",
+           mixed_time * 1e6 / (queries * 100), queries * 100);
+    printf("  CREATE ORDERED INDEX %.1f ms\n", build_time * 1e3);
+
+    free(out);
+    free_table(&t);
+    return 0;
+}
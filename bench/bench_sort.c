@@ -0,0 +1,282 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Sort ASC / DESC by column.
+ *
+ * The old bubble sort (compare_rows_by_col() on neighbours, table_swap_rows()
+ * on every inversion) is timed on small tables only; it is quadratic. Then
+ * sort_by_column() sorts 10M rows by an INT64 column, a DOUBLE column, a
+ * text column and a text column of numbers, in both directions.
+ *
+ * Then ORDER BY region, date, amount DESC is timed as one multi-key sort
+ * over normalized key strings and as three single-column sorts, last key
+ * first, and ORDER BY on numeric columns only is timed on the radix path
+ * against the normalized key strings. Every result is checked to be in
+ * order and stable.
+ *
+ * Last, the INT64, text and multi-key sorts are timed on 1, 2, 4, ...
+ * threads; every order must be the same as the serial one.
+ *
+ * Usage: ./bench_sort [rows] [max_threads]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char *const col_names[] = { "id", "amount", "name", "code", "seq" };
+#define COLS ((int)(sizeof(col_names) / sizeof(col_names[0])))
+
+/* id: INT64, amount: DOUBLE, name: text with shared prefixes, code: a
+ * number or a word (stays text), seq: the original row number. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    for (int c = 0; c < COLS; c++) {
+        if (!table_add_column(t, col_names[c])) return 0;
+    }
+    char text[COLS][32];
+    const char *values[COLS];
+    for (int c = 0; c < COLS; c++) values[c] = text[c];
+    uint32_t seed = 42;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[0], sizeof(text[0]), "%d", (int)(seed >> 4) % 1000000 - 500000);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[1], sizeof(text[1]), "%u.%02u", (seed >> 8) % 100000, seed % 100);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[2], sizeof(text[2]), "customer-%07u", (seed >> 4) % 5000000);
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 64 == 0) snprintf(text[3], sizeof(text[3]), "n/a");
+        else snprintf(text[3], sizeof(text[3]), "%u", (seed >> 8) % 100000);
+        snprintf(text[4], sizeof(text[4]), "%d", i);
+        if (!table_append_row(t, values, COLS)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* The old sort. */
+static void bubble_sort(Table *t, int col, int asc) {
+    for (int i = 0; i < t->row_count - 1; i++) {
+        for (int j = 0; j < t->row_count - 1 - i; j++) {
+            if (compare_rows_by_col(t, j, j + 1, col, asc) > 0) {
+                table_swap_rows(t, j, j + 1);
+            }
+        }
+    }
+}
+
+/* In order, and rows with equal keys still in row-number order. */
+static int sorted_stably(const Table *t, int col, int asc) {
+    const int64_t *seq = t->cols[COLS - 1].ints;
+    for (int r = 1; r < t->row_count; r++) {
+        int cmp = compare_rows_by_col(t, r - 1, r, col, asc);
+        if (cmp > 0 || (cmp == 0 && seq[r - 1] > seq[r])) return 0;
+    }
+    return 1;
+}
+
+/* Put the rows back in their original order. */
+static void restore(Table *t) {
+    SortKey seq = { COLS - 1, 1 };
+    int *order = table_sort_order(t, &seq, 1);
+    if (!order || !table_permute_rows(t, order)) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    free(order);
+}
+
+static const char *const report_names[] = { "region", "date", "amount", "qty", "seq" };
+static const char *const regions[] = { "north", "south", "east", "west", "central" };
+
+static int build_report(Table *t, int rows) {
+    init_table(t);
+    for (int c = 0; c < 5; c++) {
+        if (!table_add_column(t, report_names[c])) return 0;
+    }
+    char text[5][32];
+    const char *values[5];
+    for (int c = 0; c < 5; c++) values[c] = text[c];
+    uint32_t seed = 7;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[0], sizeof(text[0]), "%s", regions[(seed >> 8) % 5]);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[1], sizeof(text[1]), "2024-%02u-%02u", 1 + (seed >> 8) % 12, 1 + (seed >> 16) % 28);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[2], sizeof(text[2]), "%u.%02u", (seed >> 8) % 10000, seed % 100);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(text[3], sizeof(text[3]), "%u", (seed >> 8) % 50);
+        snprintf(text[4], sizeof(text[4]), "%d", i);
+        if (!table_append_row(t, values, 5)) return 0;
+    }
+    table_infer_types(t);
+    return 1;
+}
+
+/* Time one way of computing the order; returns the order's checksum. */
+static long time_order(const char *label, int *order, double t0, const Table *t) {
+    double elapsed = now_sec() - t0;
+    if (!order) {
+        fprintf(stderr, "Out of memory sorting.\n");
+        exit(1);
+    }
+    long sum = 0;
+    for (int i = 0; i < t->row_count; i++) sum = sum * 31 + order[i];
+    printf("    %-28s %8.2f ms\n", label, elapsed * 1e3);
+    free(order);
+    return sum;
+}
+
+/* One sort on 1, 2, 4, ... up to max_threads threads. */
+static void scaling(Table *t, const char *label, const SortKey *keys, int count, long max_threads) {
+    printf("  %s\n", label);
+    double base = 0.0;
+    long expected = 0;
+    for (long threads = 1; threads <= max_threads; threads *= 2) {
+        csv_load_threads = (int)threads;
+        double t0 = now_sec();
+        int *order = table_sort_order(t, keys, count);
+        double t1 = now_sec();
+        if (!order || !table_permute_rows(t, order)) {
+            fprintf(stderr, "Out of memory sorting.\n");
+            exit(1);
+        }
+        double t2 = now_sec();
+        long sum = 0;
+        for (int i = 0; i < t->row_count; i++) sum = sum * 31 + order[i];
+        free(order);
+        if (threads == 1) {
+            base = t2 - t0;
+            expected = sum;
+        }
+        printf("    %3ld thr  %9.2f ms  (order %.2f ms, permute %.2f ms)  speedup %.2fx  %s\n",
+               threads, (t2 - t0) * 1e3, (t1 - t0) * 1e3, (t2 - t1) * 1e3, base / (t2 - t0),
+               sum == expected ? "identical" : "MISMATCH");
+        restore(t);
+        if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+    }
+    csv_load_threads = 0;
+}
+
+/* ORDER BY on several keys. */
+static int order_by(int rows, long max_threads) {
+    Table t;
+    if (!build_report(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("ORDER BY on %d rows\n", rows);
+
+    SortKey report[3] = { { 0, 1 }, { 1, 1 }, { 2, 0 } };
+    printf("  region, date, amount DESC\n");
+    double t0 = now_sec();
+    long multi = time_order("one sort, normalized keys", table_sort_order(&t, report, 3), t0, &t);
+    t0 = now_sec();
+    for (int k = 2; k >= 0; k--) {
+        int *order = table_sort_order(&t, &report[k], 1);
+        if (!order || !table_permute_rows(&t, order)) return 1;
+        free(order);
+    }
+    double passes = now_sec() - t0;
+    long sum = 0;
+    const int64_t *seq = t.cols[4].ints;
+    for (int i = 0; i < t.row_count; i++) sum = sum * 31 + (int)seq[i];
+    printf("    %-28s %8.2f ms  (rows permuted three times)  %s\n", "three single-column sorts",
+           passes * 1e3, sum == multi ? "identical" : "MISMATCH");
+    SortKey by_seq = { 4, 1 };
+    int *order = table_sort_order(&t, &by_seq, 1);
+    if (!order || !table_permute_rows(&t, order)) return 1;
+    free(order);
+
+    SortKey numeric[2] = { { 3, 1 }, { 2, 0 } };
+    for (int count = 1; count <= 2; count++) {
+        printf("  %s\n", count == 1 ? "qty" : "qty, amount DESC");
+        t0 = now_sec();
+        long radix = time_order("radix", radix_sort_order(&t, numeric, count), t0, &t);
+        t0 = now_sec();
+        long normalized = time_order("normalized keys", normalized_sort_order(&t, numeric, count), t0, &t);
+        printf("    %s\n", radix == normalized ? "identical" : "MISMATCH");
+    }
+
+    printf("Threads, ORDER BY on %d rows (%ld CPUs online)\n", rows, sysconf(_SC_NPROCESSORS_ONLN));
+    scaling(&t, "region, date, amount DESC", report, 3, max_threads);
+    free_table(&t);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 10000000;
+    long max_threads = argc > 2 ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (rows <= 0) rows = 10000000;
+    if (max_threads <= 0) max_threads = 1;
+    if (max_threads > CSV_MAX_THREADS) max_threads = CSV_MAX_THREADS;
+
+    printf("Bubble sort vs. sort_by_column(), ASC by amount\n");
+    for (int n = 2000; n <= 8000; n *= 2) {
+        Table t;
+        if (!build_table(&t, n)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+        double t0 = now_sec();
+        bubble_sort(&t, 1, 1);
+        double t1 = now_sec();
+        restore(&t);
+        double t2 = now_sec();
+        SortKey key = { 1, 1 };
+        int *order = table_sort_order(&t, &key, 1);
+        if (!order || !table_permute_rows(&t, order)) return 1;
+        free(order);
+        double t3 = now_sec();
+        printf("  %8d rows  bubble %9.2f ms  sorted %7.2f ms  speedup %6.0fx  %s\n",
+               n, (t1 - t0) * 1e3, (t3 - t2) * 1e3, (t1 - t0) / (t3 - t2),
+               sorted_stably(&t, 1, 1) ? "ok" : "NOT SORTED");
+        free_table(&t);
+    }
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    printf("sort_by_column() on %d rows (keys + permutation)\n", rows);
+    for (int col = 0; col < COLS - 1; col++) {
+        for (int asc = 1; asc >= 0; asc--) {
+            SortKey key = { col, asc };
+            double t0 = now_sec();
+            int *order = table_sort_order(&t, &key, 1);
+            double t1 = now_sec();
+            if (!order || !table_permute_rows(&t, order)) {
+                fprintf(stderr, "Out of memory sorting.\n");
+                return 1;
+            }
+            double t2 = now_sec();
+            free(order);
+            printf("  %-6s %-6s %-4s  %8.2f ms  (order %.2f ms, permute %.2f ms)  %s\n",
+                   col_names[col], column_type_name(t.cols[col].type), asc ? "ASC" : "DESC",
+                   (t2 - t0) * 1e3, (t1 - t0) * 1e3, (t2 - t1) * 1e3,
+                   sorted_stably(&t, col, asc) ? "ok" : "NOT SORTED");
+            restore(&t);
+        }
+    }
+
+    printf("Threads, sort_by_column() on %d rows (%ld CPUs online)\n", rows,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    SortKey by_id = { 0, 1 }, by_name = { 2, 1 };
+    scaling(&t, "id ASC", &by_id, 1, max_threads);
+    scaling(&t, "name ASC", &by_name, 1, max_threads);
+    free_table(&t);
+    return order_by(rows, max_threads);
+}
@@ -0,0 +1,169 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Tokenizer throughput in GB/s.
+ *
+ * An in-memory CSV image is indexed with each block scanner the CPU
+ * supports (scalar, SSE2, AVX2), then loaded end to end with
+ * load_csv_buffer(). The old per-line memchr/split path is timed as a
+ * baseline. The run is repeated on an RFC 4180 quoted variant of the same
+ * data (quoted text fields, embedded commas and "" escapes) to show what
+ * quote tracking costs.
+ *
+ * Usage: ./bench_tokenizer [megabytes]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char *make_csv(size_t target, int quoted, size_t *out_size) {
+    static const char *words[] = { "north", "south", "east", "west", "central" };
+    char *buf = (char *)malloc(target + 256);
+    if (!buf) return NULL;
+    size_t n = (size_t)sprintf(buf, "id,name,region,amount,qty,note\n");
+    srand(42);
+    const char *fmt = quoted ? "%ld,\"user, %d\",\"%s\",%d.%02d,%d,\"%s\"\n"
+                             : "%ld,user%d,%s,%d.%02d,%d,%s\n";
+    const char *notes[2][2] = { { "ok", "pending review" },
+                                { "ok", "said \"\"pending\"\"" } };
+    for (long id = 0; n < target; id++) {
+        n += (size_t)sprintf(buf + n, fmt,
+                             id, rand() % 100000, words[rand() % 5],
+                             rand() % 100000, rand() % 100, rand() % 1000,
+                             notes[quoted][rand() & 1]);
+    }
+    *out_size = n;
+    return buf;
+}
+
+static size_t index_all(const char *data, size_t size, uint32_t *pos) {
+    size_t total = 0;
+    CsvScanState st = { 0, 0, 0 };
+    for (size_t off = 0; off < size; off += CSV_WINDOW) {
+        size_t len = size - off < CSV_WINDOW ? size - off : CSV_WINDOW;
+        total += csv_index_separators(data + off, len, pos, &st);
+    }
+    return total;
+}
+
+static size_t split_lines(const char *data, size_t size) {
+    Cell fields[16];
+    size_t total = 0;
+    const char *p = data, *end = data + size;
+    while (p < end) {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+        size_t len = (size_t)((nl ? nl : end) - p);
+        total += (size_t)split_csv_view(p, len, fields, 16);
+        p = nl ? nl + 1 : end;
+    }
+    return total;
+}
+
+static void report(const char *name, double best, size_t size) {
+    printf("  %-22s %9.2f ms  %6.2f GB/s\n", name, best * 1e3, (double)size / best / 1e9);
+}
+
+typedef struct {
+    const char *name;
+    CsvBlockScanner scan;
+    int supported;
+} ScannerCase;
+
+static void run_input(const char *data, size_t size, uint32_t *pos,
+                      const ScannerCase *scanners, size_t count, int reps) {
+    volatile size_t sink = 0;
+    double best = 1e30;
+    for (int rep = 0; rep < reps; rep++) {
+        double t0 = now_sec();
+        sink += split_lines(data, size);
+        double elapsed = now_sec() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    report("memchr split", best, size);
+
+    for (size_t k = 0; k < count; k++) {
+        if (!scanners[k].supported) {
+            printf("  %-22s unsupported on this CPU\n", scanners[k].name);
+            continue;
+        }
+        csv_scanner = scanners[k].scan;
+        csv_scanner_name = scanners[k].name;
+        char label[32];
+
+        best = 1e30;
+        for (int rep = 0; rep < reps; rep++) {
+            double t0 = now_sec();
+            sink += index_all(data, size, pos);
+            double elapsed = now_sec() - t0;
+            if (elapsed < best) best = elapsed;
+        }
+        snprintf(label, sizeof(label), "%s index", scanners[k].name);
+        report(label, best, size);
+
+        best = 1e30;
+        for (int rep = 0; rep < reps; rep++) {
+            Table t;
+            init_table(&t);
+            double t0 = now_sec();
+            load_csv_buffer(&t, data, size);
+            double elapsed = now_sec() - t0;
+            sink += (size_t)t.row_count;
+            free_table(&t);
+            if (elapsed < best) best = elapsed;
+        }
+        snprintf(label, sizeof(label), "%s load_csv_buffer", scanners[k].name);
+        report(label, best, size);
+    }
+    (void)sink;
+}
+
+int main(int argc, char **argv) {
+    long mb = argc > 1 ? atol(argv[1]) : 256;
+    if (mb <= 0) mb = 256;
+    const int reps = 3;
+
+    ScannerCase scanners[] = {
+        { "scalar", csv_scan_block_scalar, 1 },
+#ifdef CSV_HAVE_X86_SIMD
+        { "sse2",   csv_scan_block_sse2,   0 },
+        { "avx2",   csv_scan_block_avx2,   0 },
+#endif
+    };
+#ifdef CSV_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    scanners[1].supported = __builtin_cpu_supports("sse2");
+    scanners[2].supported = __builtin_cpu_supports("avx2");
+#endif
+
+    uint32_t *pos = (uint32_t *)malloc(CSV_WINDOW * sizeof(uint32_t));
+    if (!pos) {
+        fprintf(stderr, "Out of memory building input.\n");
+        return 1;
+    }
+    for (int quoted = 0; quoted <= 1; quoted++) {
+        size_t size;
+        char *data = make_csv((size_t)mb << 20, quoted, &size);
+        if (!data) {
+            fprintf(stderr, "Out of memory building input.\n");
+            return 1;
+        }
+        printf("Tokenizing %.1f MB of %s CSV (best of %d)\n",
+               (double)size / (1 << 20), quoted ? "quoted" : "plain", reps);
+        run_input(data, size, pos, scanners, sizeof(scanners) / sizeof(scanners[0]), reps);
+        free(data);
+    }
+
+    free(pos);
+    return 0;
+}
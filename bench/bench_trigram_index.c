@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * LIKE on a log-message column: strstr-style scan vs. CREATE TRIGRAM INDEX.
+ *
+ * Messages mix a few templates with random users, hosts and addresses, so
+ * the patterns below range from rare to matching a large share of rows.
+ * Every indexed query must return exactly the rows of the scan.
+ *
+ * Usage: ./bench_trigram_index [rows]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t next_random(uint32_t *s) {
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 1;
+}
+
+static int build_table(Table *t, int rows) {
+    static const char *templates[] = {
+        "host%02u sshd[%u]: Failed password for user%u from 10.0.%u.%u port %u",
+        "host%02u sshd[%u]: Accepted publickey for user%u from 10.0.%u.%u port %u",
+        "host%02u kernel[%u]: eth0 link up user%u 10.0.%u.%u speed %u",
+        "host%02u cron[%u]: job user%u finished 10.0.%u.%u status %u",
+    };
+    init_table(t);
+    if (!table_add_column(t, "message")) return 0;
+    uint32_t seed = 42;
+    char buf[160];
+    for (int i = 0; i < rows; i++) {
+        uint32_t r = next_random(&seed);
+        snprintf(buf, sizeof(buf), templates[r % 4], r % 50, next_random(&seed) % 30000,
+                 next_random(&seed) % 100000, next_random(&seed) % 256,
+                 next_random(&seed) % 256, next_random(&seed) % 65536);
+        const char *values[1] = { buf };
+        if (!table_append_row(t, values, 1)) return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (rows <= 0) rows = 1000000;
+    static const char *patterns[] = {
+        "user4217 ", "10.0.17.201 ", "Failed password for user99", "kernel", "publickey", "zzz",
+    };
+    const int npat = (int)(sizeof(patterns) / sizeof(patterns[0]));
+    const int reps = 5;
+
+    Table t;
+    int *out = (int *)malloc((size_t)rows * sizeof(int));
+    int *ref = (int *)malloc((size_t)rows * sizeof(int));
+    if (!out || !ref || !build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+
+    double t0 = now_sec();
+    if (!table_create_trigram_index(&t, 0)) {
+        fprintf(stderr, "Out of memory building index.\n");
+        return 1;
+    }
+    double build_time = now_sec() - t0;
+    TrigramIndex *ix = t.cols[0].grams;
+    t.cols[0].grams = NULL;
+
+    printf("LIKE on %d log messages (best of %d)\n", rows, reps);
+    printf("  %-28s %8s %12s %12s %8s\n", "pattern", "matches", "scan", "index", "speedup");
+    for (int p = 0; p < npat; p++) {
+        double scan = 1e30, indexed = 1e30;
+        int n = 0, m = 0;
+        for (int rep = 0; rep < reps; rep++) {
+            t.cols[0].grams = NULL;
+            t0 = now_sec();
+            n = find_rows_by_substring(&t, 0, patterns[p], ref, rows);
+            double e = now_sec() - t0;
+            if (e < scan) scan = e;
+            t.cols[0].grams = ix;
+            t0 = now_sec();
+            m = find_rows_by_substring(&t, 0, patterns[p], out, rows);
+            e = now_sec() - t0;
+            if (e < indexed) indexed = e;
+        }
+        int same = m == n && memcmp(out, ref, (size_t)n * sizeof(int)) == 0;
+        printf("  %-28s %8d %9.2f ms %9.3f ms %7.0fx %s\n", patterns[p], n, scan * 1e3,
+               indexed * 1e3, scan / indexed, same ? "" : "MISMATCH");
+    }
+    size_t postings = 0;
+    for (size_t i = 0; i <= ix->mask; i++) postings += ix->slots[i].count;
+    printf("  CREATE TRIGRAM INDEX %.1f ms, %zu trigrams, %.1f MB of postings\n",
+           build_time * 1e3, ix->grams, (double)postings * sizeof(int) / (1 << 20));
+
+    t.cols[0].grams = ix;
+    free(out);
+    free(ref);
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Use the REAL project implementation */
+#include "../csv_sql.c"
+
+/*
+ * Duplicate detection and UNIQUE enforcement.
+ *
+ * The duplicate check is timed with the old nested strcmp-style loop
+ * (only up to a few tens of thousands of rows; it is quadratic) and with
+ * column_duplicates(), the single hashing pass behind "Check column for
+ * duplicate values". Both must find the same duplicated values. Then a
+ * UNIQUE key is enforced on a large column as load_csv() does, and the
+ * per-row check insert_row() makes is timed with the key's index and with
+ * the scan it falls back to.
+ *
+ * Usage: ./bench_unique_check [rows] [checks]
+ */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Keys with roughly one duplicate per hundred rows. */
+static int build_table(Table *t, int rows) {
+    init_table(t);
+    if (!table_add_column(t, "key")) return 0;
+    char key[32];
+    uint32_t seed = 42;
+    for (int i = 0; i < rows; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int id = (seed >> 8) % 100 == 0 ? (int)((seed >> 4) % (uint32_t)(i + 1)) : i;
+        snprintf(key, sizeof(key), "user%08d", id);
+        const char *values[1] = { key };
+        if (!table_append_row(t, values, 1)) return 0;
+    }
+    return 1;
+}
+
+/* The old check: compare every pair; counts rows that repeat an earlier one. */
+static int pairwise_repeats(const Table *t) {
+    const Cell *cells = t->cols[0].cells;
+    int repeats = 0;
+    for (int i = 0; i < t->row_count; i++) {
+        if (cells[i].len == 0) continue;
+        for (int j = 0; j < i; j++) {
+            if (cell_compare(cells[i], cells[j]) == 0) {
+                repeats++;
+                break;
+            }
+        }
+    }
+    return repeats;
+}
+
+static int hashed_repeats(const Table *t) {
+    int *heads, *next;
+    int dups = column_duplicates(t, 0, &heads, &next, NULL);
+    if (dups < 0) return -1;
+    int repeats = 0;
+    for (int i = 0; i < dups; i++) {
+        for (int r = next[heads[i]]; r >= 0; r = next[r]) repeats++;
+    }
+    free(heads);
+    free(next);
+    return repeats;
+}
+
+static double time_checks(Table *t, int checks, long *hits) {
+    char key[32];
+    uint32_t seed = 7;
+    *hits = 0;
+    double t0 = now_sec();
+    for (int i = 0; i < checks; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(key, sizeof(key), "user%08d", (int)(seed % (uint32_t)(t->row_count * 2)));
+        if (table_key_conflict(t, 0, -1, key, strlen(key)) >= 0) (*hits)++;
+    }
+    return now_sec() - t0;
+}
+
+int main(int argc, char **argv) {
+    int rows = argc > 1 ? atoi(argv[1]) : 4000000;
+    int checks = argc > 2 ? atoi(argv[2]) : 200;
+    if (rows <= 0) rows = 4000000;
+    if (checks <= 0) checks = 200;
+
+    printf("Duplicate check\n");
+    for (int n = 5000; n <= 40000; n *= 2) {
+        Table t;
+        if (!build_table(&t, n)) {
+            fprintf(stderr, "Out of memory building table.\n");
+            return 1;
+        }
+        double t0 = now_sec();
+        int old_repeats = pairwise_repeats(&t);
+        double t1 = now_sec();
+        int new_repeats = hashed_repeats(&t);
+        double t2 = now_sec();
+        printf("  %8d rows  pairwise %9.2f ms  hashed %7.2f ms  speedup %6.0fx  %s\n",
+               n, (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t1 - t0) / (t2 - t1),
+               old_repeats == new_repeats ? "identical" : "MISMATCH");
+        free_table(&t);
+    }
+
+    Table t;
+    if (!build_table(&t, rows)) {
+        fprintf(stderr, "Out of memory building table.\n");
+        return 1;
+    }
+    double t0 = now_sec();
+    int repeats = hashed_repeats(&t);
+    double t1 = now_sec();
+    int dropped = table_drop_key_violations(&t, 0, KEY_UNIQUE);
+    int added = table_add_key(&t, 0, KEY_UNIQUE);
+    double t2 = now_sec();
+    printf("  %8d rows  hashed %.2f ms, %d repeated rows\n", rows, (t1 - t0) * 1e3, repeats);
+    printf("UNIQUE on load: %.2f ms, %d rows skipped%s\n", (t2 - t1) * 1e3, dropped,
+           added == 1 && dropped == repeats ? "" : "  MISMATCH");
+
+    long index_hits, scan_hits;
+    double index_time = time_checks(&t, checks, &index_hits);
+    index_free(t.cols[0].index);
+    t.cols[0].index = NULL;
+    double scan_time = time_checks(&t, checks, &scan_hits);
+    printf("Insert check (%d rows, %d values)\n", t.row_count, checks);
+    printf("  scan     %10.2f us/check\n", scan_time * 1e6 / checks);
+    printf("  index    %10.2f us/check  speedup %.0fx  %s\n", index_time * 1e6 / checks,
+           scan_time / index_time, index_hits == scan_hits ? "identical" : "MISMATCH");
+
+    free_table(&t);
+    return 0;
+}
@@ -1,23 +1,174 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSV_HAVE_X86_SIMD 1
+#endif
 
-#define MAX_ROWS        1024
-#define MAX_COLS        16
 #define MAX_FIELD_LEN   128
-#define MAX_LINE_LEN    1024
+#define INITIAL_ROW_CAP 64
+
+#define ARENA_MIN_CHUNK     (64u * 1024u)
+#define ARENA_MAX_CHUNK     (64u * 1024u * 1024u)
+#define ARENA_COMPACT_BYTES (1u * 1024u * 1024u)
+
+#define CSV_BLOCK  64
+#define CSV_WINDOW (64u * 1024u)
+
+#define CSV_READ_BUFFER        (1u * 1024u * 1024u)
+#define CSV_PARALLEL_MIN_CHUNK (4u * 1024u * 1024u)
+#define CSV_MAX_THREADS        256
+
+/* Bump allocator for cell strings. Chunks grow geometrically, so a load
+ * is a handful of large allocations and freeing walks only the chunks. */
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t used;
+    size_t cap;
+    char data[];
+} ArenaChunk;
+
+typedef struct {
+    ArenaChunk *head;
+    size_t used;   /* bytes handed out, across all chunks */
+    size_t dead;   /* bytes no longer referenced by any cell */
+} Arena;
+
+/* A cell is a string view (pointer + length) into either the mapped CSV
+ * file or the table's string arena. Views are not NUL-terminated; a NULL
+ * pointer marks a missing cell. */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} Cell;
+
+/* Column types inferred at load time. Every non-empty cell of an INT64 or
+ * DOUBLE column parses as that type; empty and missing cells are nulls. */
+typedef enum {
+    COL_STRING,
+    COL_INT64,
+    COL_DOUBLE
+} ColumnType;
+
+/* Key constraints. They are enforced through the column's hash index by
+ * the operations that write user values (insert, update and load); the
+ * table primitives below do not check them. Empty cells count as NULL:
+ * UNIQUE allows any number of them, a PRIMARY KEY none. */
+typedef enum {
+    KEY_NONE,
+    KEY_UNIQUE,
+    KEY_PRIMARY
+} KeyConstraint;
+
+/* CREATE INDEX: an open-addressing hash table (linear probing) over one
+ * column. A slot holds a row number and the hash of that row's cell, not
+ * the cell pointer, so string compaction never invalidates it; keys are
+ * always compared against the column itself. At most half the slots are
+ * in use, so every probe sequence ends at an empty slot. */
+typedef struct {
+    uint32_t hash;
+    int row;            /* -1 marks an empty slot */
+} IndexSlot;
+
+typedef struct {
+    IndexSlot *slots;
+    size_t mask;        /* slot count - 1; the count is a power of two */
+    size_t count;
+} HashIndex;
+
+/* Rows changed since an index was last brought up to date: a flag per
+ * row (row_cap of them) and the list of flagged rows. Lookups skip what
+ * the index says about flagged rows and test them against the column. */
+typedef struct {
+    uint8_t *stale;
+    int *rows;
+    size_t len;
+    size_t cap;
+} RowLog;
+
+typedef struct {
+    double value;
+    int row;
+} RangeEntry;
+
+/* CREATE ORDERED INDEX: the numeric cells of one column as (value, row)
+ * pairs sorted by value, for BETWEEN. Changed rows are not re-sorted one
+ * at a time: they wait in the log, which is merged back in a single pass
+ * once it outgrows a fraction of the index. */
+typedef struct {
+    RangeEntry *entries;
+    size_t count;
+    RowLog log;         /* rows changed since the last merge */
+} RangeIndex;
+
+/* One trigram's posting list: postings[start .. start + count), ascending. */
+typedef struct {
+    uint32_t gram;      /* the three bytes plus one; 0 marks an empty slot */
+    uint32_t count;
+    size_t start;
+    int last;           /* last row counted, while building */
+} GramSlot;
+
+/* CREATE TRIGRAM INDEX: every 3-byte substring of a column's cells mapped
+ * to the rows containing it, with all posting lists packed into one array.
+ * LIKE intersects the lists of the pattern's trigrams and verifies the
+ * rows that survive. Changed rows wait in the log and the index is rebuilt
+ * once that grows long, since such columns are read far more often than
+ * they change. */
+typedef struct {
+    GramSlot *slots;    /* open addressing, at most half full */
+    size_t mask;
+    size_t grams;
+    int *postings;
+    RowLog log;         /* rows changed since the last build */
+} TrigramIndex;
 
+/* Tables are stored column-major: each column owns one contiguous vector
+ * of cells, so single-column scans stream through memory instead of
+ * striding over whole rows. Rows are addressed by index. Numeric columns
+ * also keep their parsed values in a native array next to the text,
+ * with `valid[i]` clear for nulls.
+ *
+ * A deleted row is a tombstone until the next compaction: its bit in
+ * `live` is cleared, its cells are emptied and it is out of every index,
+ * so row numbers do not move. Scans that could match an empty cell (view,
+ * save, GROUP BY, equality on "") check the bitmap; the rest never match
+ * a dead row anyway. */
 typedef struct {
-    char *cells[MAX_COLS];
-    int cell_count;
-} Row;
+    Cell *cells;
+    ColumnType type;
+    int64_t *ints;      /* COL_INT64 */
+    double *nums;       /* COL_DOUBLE */
+    uint8_t *valid;     /* numeric columns: 1 where the value is not null */
+    HashIndex *index;   /* CREATE INDEX, or NULL */
+    RangeIndex *range;  /* CREATE ORDERED INDEX, or NULL */
+    TrigramIndex *grams; /* CREATE TRIGRAM INDEX, or NULL */
+    KeyConstraint key;  /* UNIQUE / PRIMARY KEY, or KEY_NONE */
+} Column;
 
 typedef struct {
-    char *col_names[MAX_COLS];
+    char **col_names;
+    Column *cols;
     int col_count;
-    Row rows[MAX_ROWS];
     int row_count;
+    int row_cap;
+    uint64_t *live;     /* bit per row, set while it is live; NULL when none is dead */
+    int dead_count;     /* tombstones awaiting compaction */
+    Arena strings;      /* cells that were inserted, updated or copied in */
+    const char *map;    /* read-only mapping of the loaded file, or NULL */
+    size_t map_len;
 } Table;
 
 static void trim_newline(char *s) {
@@ -47,369 +198,3218 @@ static char *str_dup(const char *s) {
     return p;
 }
 
-static int parse_double(const char *s, double *out) {
-    if (!s || !out) return 0;
-    char *end = NULL;
-    double v = strtod(s, &end);
-    if (end == s || *end != '\0') return 0;
-    *out = v;
-    return 1;
+static void arena_init(Arena *a) {
+    a->head = NULL;
+    a->used = 0;
+    a->dead = 0;
 }
 
-static void init_row(Row *r) {
-    if (!r) return;
-    r->cell_count = 0;
-    for (int i = 0; i < MAX_COLS; i++) {
-        r->cells[i] = NULL;
+static void arena_free(Arena *a) {
+    ArenaChunk *c = a->head;
+    while (c) {
+        ArenaChunk *next = c->next;
+        free(c);
+        c = next;
     }
+    arena_init(a);
 }
 
-static void free_row(Row *r) {
-    if (!r) return;
-    for (int i = 0; i < r->cell_count; i++) {
-        free(r->cells[i]);
-        r->cells[i] = NULL;
-    }
-    r->cell_count = 0;
+/* Ensure the current chunk has at least `size` free bytes. */
+static int arena_reserve(Arena *a, size_t size) {
+    ArenaChunk *c = a->head;
+    if (c && c->cap - c->used >= size) return 1;
+    size_t cap = c ? c->cap * 2 : ARENA_MIN_CHUNK;
+    if (cap > ARENA_MAX_CHUNK) cap = ARENA_MAX_CHUNK;
+    if (cap < size) cap = size;
+    c = (ArenaChunk *)malloc(sizeof(ArenaChunk) + cap);
+    if (!c) return 0;
+    c->next = a->head;
+    c->used = 0;
+    c->cap = cap;
+    a->head = c;
+    return 1;
 }
 
-static void init_table(Table *t) {
-    if (!t) return;
-    t->col_count = 0;
-    t->row_count = 0;
-    for (int i = 0; i < MAX_COLS; i++) {
-        t->col_names[i] = NULL;
-    }
-    for (int i = 0; i < MAX_ROWS; i++) {
-        init_row(&t->rows[i]);
-    }
+static void *arena_alloc(Arena *a, size_t size) {
+    if (!arena_reserve(a, size)) return NULL;
+    ArenaChunk *c = a->head;
+    void *p = c->data + c->used;
+    c->used += size;
+    a->used += size;
+    return p;
 }
 
-static void free_table(Table *t) {
-    if (!t) return;
-    for (int i = 0; i < t->col_count; i++) {
-        free(t->col_names[i]);
-        t->col_names[i] = NULL;
-    }
-    for (int i = 0; i < t->row_count; i++) {
-        free_row(&t->rows[i]);
-    }
-    t->col_count = 0;
-    t->row_count = 0;
+/* Copy `len` bytes into the arena; the copy is NUL-terminated. */
+static Cell arena_cell(Arena *a, const char *s, size_t len) {
+    Cell c = { NULL, 0 };
+    if (!s) return c;
+    char *p = (char *)arena_alloc(a, len + 1);
+    if (!p) return c;
+    memcpy(p, s, len);
+    p[len] = '\0';
+    c.ptr = p;
+    c.len = len;
+    return c;
 }
 
-static void print_row(const Table *t, const Row *r) {
-    if (!t || !r) return;
-    for (int i = 0; i < t->col_count; i++) {
-        const char *val = (i < r->cell_count && r->cells[i]) ? r->cells[i] : "NULL";
-        printf("%s", val);
-        if (i + 1 < t->col_count) printf(" | ");
+/* Move every chunk of `src` into `dst`, leaving `src` empty. New
+ * allocations keep going to dst's current chunk. */
+static void arena_adopt(Arena *dst, Arena *src) {
+    if (!src->head) return;
+    if (!dst->head) {
+        src->used += dst->used;
+        src->dead += dst->dead;
+        *dst = *src;
+        arena_init(src);
+        return;
     }
-    printf("\n");
+    ArenaChunk *tail = src->head;
+    while (tail->next) tail = tail->next;
+    tail->next = dst->head->next;
+    dst->head->next = src->head;
+    dst->used += src->used;
+    dst->dead += src->dead;
+    arena_init(src);
 }
 
-static void print_header(const Table *t) {
-    if (!t) return;
-    for (int i = 0; i < t->col_count; i++) {
-        printf("%s", t->col_names[i] ? t->col_names[i] : "(col)");
-        if (i + 1 < t->col_count) printf(" | ");
+static int cell_equals(Cell c, const char *s, size_t len) {
+    return c.len == len && (len == 0 || memcmp(c.ptr, s, len) == 0);
+}
+
+/* strstr() over a view: does `c` contain the `len` bytes at `needle`? */
+static int cell_contains(Cell c, const char *needle, size_t len) {
+    if (len == 0) return 1;
+    if (c.len < len) return 0;
+    const char *p = c.ptr;
+    const char *last = c.ptr + (c.len - len);
+    while (p <= last) {
+        p = (const char *)memchr(p, needle[0], (size_t)(last - p) + 1);
+        if (!p) return 0;
+        if (memcmp(p, needle, len) == 0) return 1;
+        p++;
     }
-    printf("\n");
+    return 0;
 }
 
-int parse_csv_line(const char *line, char *fields[], int max_fields) {
-    if (!line || !fields || max_fields <= 0) return 0;
+/* strcmp() order over views; missing cells compare as "". */
+static int cell_compare(Cell a, Cell b) {
+    size_t n = a.len < b.len ? a.len : b.len;
+    int cmp = n ? memcmp(a.ptr, b.ptr, n) : 0;
+    if (cmp != 0) return cmp;
+    return (a.len > b.len) - (a.len < b.len);
+}
 
-    char buffer[MAX_LINE_LEN];
-    size_t len = strlen(line);
-    if (len >= sizeof(buffer)) {
-        return 0;
-    }
-    strcpy(buffer, line);
+/* Number parsing.
+ *
+ * parse_number() accepts exactly the strings strtod() would consume whole
+ * in the C locale, and returns the same bits, but needs no terminator and
+ * never consults the locale. Plain decimals are converted here: digits are
+ * gathered eight at a time into a 64-bit significand, and the result is
+ * rounded exactly either by Clinger's fast path (significand and power of
+ * ten both exact doubles) or by the Eisel-Lemire 128-bit product. The rest
+ * of strtod()'s grammar (leading spaces, hex, inf/nan), more than 19
+ * significant digits, powers of ten outside the table and the rare
+ * ambiguous roundings are passed on to strtod() itself. */
 
-    int count = 0;
-    char *p = buffer;
-    while (count < max_fields) {
-        char *comma = strchr(p, ',');
-        if (comma) {
-            *comma = '\0';
-            fields[count] = str_dup(p);
-            if (!fields[count]) {
-                for (int i = 0; i < count; i++) free(fields[i]);
-                return 0;
-            }
-            count++;
-            p = comma + 1;
-        } else {
-            fields[count] = str_dup(p);
-            if (!fields[count]) {
-                for (int i = 0; i < count; i++) free(fields[i]);
-                return 0;
-            }
-            count++;
-            break;
-        }
-    }
+/* Eight ASCII digits in one little-endian word (SWAR). */
+static inline uint64_t load_digits8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
 
-    return count;
+static inline int is_digits8(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
 }
 
-static void free_fields(char *fields[], int count) {
-    for (int i = 0; i < count; i++) {
-        free(fields[i]);
-        fields[i] = NULL;
+static inline uint32_t parse_digits8(uint64_t v) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    v -= 0x3030303030303030ULL;
+    v = v * 10 + (v >> 8);
+    v = ((v & mask) * 0x000F424000000064ULL +
+         ((v >> 16) & mask) * 0x0000271000000001ULL) >> 32;
+    return (uint32_t)v;
+}
+
+/* Digits starting at p, eight at a time while they last. */
+static const char *scan_digits(const char *p, const char *end, uint64_t *man) {
+    uint64_t m = *man;
+    while (end - p >= 8) {
+        uint64_t w = load_digits8(p);
+        if (!is_digits8(w)) break;
+        m = m * 100000000u + parse_digits8(w);
+        p += 8;
+    }
+    while (p < end && (unsigned)((unsigned char)*p - '0') <= 9) {
+        m = m * 10 + (uint64_t)(*p - '0');
+        p++;
     }
+    *man = m;
+    return p;
 }
 
-static int load_csv(const char *filename, Table *t) {
-    if (!filename || !t) return 0;
+/* Truncated 128-bit significands of 10^-64 .. 10^64, top bit set. */
+#define POW10_MIN_EXP (-64)
+#define POW10_MAX_EXP 64
 
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        perror("Error opening CSV");
-        return 0;
-    }
+static const uint64_t pow10_128[][2] = {
+    { 0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL }, { 0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL },
+    { 0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL }, { 0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL },
+    { 0xCDB02555653131B6ULL, 0x3792F412CB06794DULL }, { 0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL },
+    { 0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL }, { 0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL },
+    { 0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL }, { 0x9CED737BB6C4183DULL, 0x55464DD69685606BULL },
+    { 0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL }, { 0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL },
+    { 0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL }, { 0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL },
+    { 0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL }, { 0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL },
+    { 0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL }, { 0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL },
+    { 0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL }, { 0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL },
+    { 0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL }, { 0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL },
+    { 0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL }, { 0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL },
+    { 0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL }, { 0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL },
+    { 0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL }, { 0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL },
+    { 0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL }, { 0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL },
+    { 0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL }, { 0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL },
+    { 0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL }, { 0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL },
+    { 0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL }, { 0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL },
+    { 0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL }, { 0x9E74D1B791E07E48ULL, 0x775EA264CF55347DULL },
+    { 0xC612062576589DDAULL, 0x95364AFE032A819DULL }, { 0xF79687AED3EEC551ULL, 0x3A83DDBD83F52204ULL },
+    { 0x9ABE14CD44753B52ULL, 0xC4926A9672793542ULL }, { 0xC16D9A0095928A27ULL, 0x75B7053C0F178293ULL },
+    { 0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6338ULL }, { 0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E03ULL },
+    { 0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF584ULL }, { 0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E5ULL },
+    { 0x9392EE8E921D5D07ULL, 0x3AFF322E62439FCFULL }, { 0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C2ULL },
+    { 0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B3ULL }, { 0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A10ULL },
+    { 0xB424DC35095CD80FULL, 0x538484C19EF38C94ULL }, { 0xE12E13424BB40E13ULL, 0x2865A5F206B06FB9ULL },
+    { 0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D3ULL }, { 0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D748ULL },
+    { 0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1BULL }, { 0x89705F4136B4A597ULL, 0x31680A88F8953030ULL },
+    { 0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3DULL }, { 0xD6BF94D5E57A42BCULL, 0x3D32907604691B4CULL },
+    { 0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B10FULL }, { 0xA7C5AC471B478423ULL, 0x0FCF80DC33721D53ULL },
+    { 0xD1B71758E219652BULL, 0xD3C36113404EA4A8ULL }, { 0x83126E978D4FDF3BULL, 0x645A1CAC083126E9ULL },
+    { 0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A3ULL }, { 0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCCULL },
+    { 0x8000000000000000ULL, 0x0000000000000000ULL }, { 0xA000000000000000ULL, 0x0000000000000000ULL },
+    { 0xC800000000000000ULL, 0x0000000000000000ULL }, { 0xFA00000000000000ULL, 0x0000000000000000ULL },
+    { 0x9C40000000000000ULL, 0x0000000000000000ULL }, { 0xC350000000000000ULL, 0x0000000000000000ULL },
+    { 0xF424000000000000ULL, 0x0000000000000000ULL }, { 0x9896800000000000ULL, 0x0000000000000000ULL },
+    { 0xBEBC200000000000ULL, 0x0000000000000000ULL }, { 0xEE6B280000000000ULL, 0x0000000000000000ULL },
+    { 0x9502F90000000000ULL, 0x0000000000000000ULL }, { 0xBA43B74000000000ULL, 0x0000000000000000ULL },
+    { 0xE8D4A51000000000ULL, 0x0000000000000000ULL }, { 0x9184E72A00000000ULL, 0x0000000000000000ULL },
+    { 0xB5E620F480000000ULL, 0x0000000000000000ULL }, { 0xE35FA931A0000000ULL, 0x0000000000000000ULL },
+    { 0x8E1BC9BF04000000ULL, 0x0000000000000000ULL }, { 0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL },
+    { 0xDE0B6B3A76400000ULL, 0x0000000000000000ULL }, { 0x8AC7230489E80000ULL, 0x0000000000000000ULL },
+    { 0xAD78EBC5AC620000ULL, 0x0000000000000000ULL }, { 0xD8D726B7177A8000ULL, 0x0000000000000000ULL },
+    { 0x878678326EAC9000ULL, 0x0000000000000000ULL }, { 0xA968163F0A57B400ULL, 0x0000000000000000ULL },
+    { 0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL }, { 0x84595161401484A0ULL, 0x0000000000000000ULL },
+    { 0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL }, { 0xCECB8F27F4200F3AULL, 0x0000000000000000ULL },
+    { 0x813F3978F8940984ULL, 0x4000000000000000ULL }, { 0xA18F07D736B90BE5ULL, 0x5000000000000000ULL },
+    { 0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL }, { 0xFC6F7C4045812296ULL, 0x4D00000000000000ULL },
+    { 0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL }, { 0xC5371912364CE305ULL, 0x6C28000000000000ULL },
+    { 0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL }, { 0x9A130B963A6C115CULL, 0x3C7F400000000000ULL },
+    { 0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL }, { 0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL },
+    { 0x96769950B50D88F4ULL, 0x1314448000000000ULL }, { 0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL },
+    { 0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL }, { 0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL },
+    { 0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL }, { 0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL },
+    { 0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL }, { 0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL },
+    { 0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL }, { 0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL },
+    { 0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL }, { 0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL },
+    { 0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL }, { 0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL },
+    { 0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL }, { 0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL },
+    { 0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL }, { 0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL },
+    { 0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL }, { 0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL },
+    { 0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL }, { 0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL },
+    { 0x9F4F2726179A2245ULL, 0x01D762422C946590ULL }, { 0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL },
+    { 0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL }, { 0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL },
+    { 0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL },
+};
 
-    free_table(t);
-    init_table(t);
+static const double exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-    char line[MAX_LINE_LEN];
+static inline void mul_64x64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    *lo = (uint64_t)r;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    *lo = (mid << 32) | (uint32_t)ll;
+#endif
+}
 
-    if (!fgets(line, sizeof(line), f)) {
-        fclose(f);
-        printf("CSV file is empty.\n");
-        return 0;
-    }
-    trim_newline(line);
+/* man * 10^exp10 rounded to nearest-even, for 0 < man and exp10 in the
+ * table; returns 0 when the 128-bit product cannot decide the rounding
+ * or the result is subnormal or infinite. */
+static int eisel_lemire(uint64_t man, int64_t exp10, int neg, double *out) {
+    const uint64_t *pow = pow10_128[exp10 - POW10_MIN_EXP];
+    int clz = __builtin_clzll(man);
+    man <<= clz;
+    uint64_t exp2 = (uint64_t)(((217706 * exp10) >> 16) + 64 + 1023) - (uint64_t)clz;
 
-    char *fields[MAX_COLS] = {0};
-    int field_count = parse_csv_line(line, fields, MAX_COLS);
-    if (field_count <= 0) {
-        fclose(f);
-        printf("Failed to parse header line.\n");
-        return 0;
+    uint64_t hi, lo;
+    mul_64x64(man, pow[0], &hi, &lo);
+    if ((hi & 0x1FF) == 0x1FF && lo + man < man) {
+        uint64_t hi2, lo2;
+        mul_64x64(man, pow[1], &hi2, &lo2);
+        uint64_t merged_lo = lo + hi2;
+        uint64_t merged_hi = hi + (merged_lo < lo);
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && lo2 + man < man) return 0;
+        hi = merged_hi;
+        lo = merged_lo;
     }
-    t->col_count = field_count;
-    for (int i = 0; i < field_count; i++) {
-        t->col_names[i] = fields[i];
-    }
-
-    while (fgets(line, sizeof(line), f)) {
-        trim_newline(line);
-        if (line[0] == '\0') continue;
-        if (t->row_count >= MAX_ROWS) {
-            printf("Reached max rows (%d). Remaining lines are ignored.\n", MAX_ROWS);
-            break;
-        }
 
-        int count = parse_csv_line(line, fields, MAX_COLS);
-        if (count <= 0) {
-            printf("Skipping invalid row: %s\n", line);
-            continue;
-        }
+    uint64_t msb = hi >> 63;
+    uint64_t mantissa = hi >> (msb + 9);
+    exp2 -= 1 ^ msb;
+    if (lo == 0 && (hi & 0x1FF) == 0 && (mantissa & 3) == 1) return 0;
 
-        Row *r = &t->rows[t->row_count];
-        init_row(r);
-        r->cell_count = count;
-        for (int i = 0; i < count; i++) {
-            r->cells[i] = fields[i];
-        }
-        t->row_count++;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >> 53) {
+        mantissa >>= 1;
+        exp2++;
     }
+    if (exp2 - 1 >= 0x7FF - 1) return 0;
 
-    fclose(f);
-    printf("Loaded %d rows with %d columns from '%s'.\n",
-           t->row_count, t->col_count, filename);
+    uint64_t bits = exp2 << 52 | (mantissa & 0x000FFFFFFFFFFFFFULL);
+    if (neg) bits |= 0x8000000000000000ULL;
+    memcpy(out, &bits, sizeof(bits));
     return 1;
 }
 
-static void show_summary(const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* Plain decimal syntax: [+-]digits[.digits][(e|E)[+-]digits]. Returns 1
+ * with the value, 0 when the text is not a plain decimal (or has trailing
+ * bytes), -1 when it is one but must be rounded by strtod(). A NUL ends
+ * the text early, as it would for strtod(). */
+static int parse_decimal(const char *p, size_t len, double *out) {
+    const char *s = p, *end = p + len;
+    int neg = 0;
+    if (s < end && (*s == '+' || *s == '-')) {
+        neg = *s == '-';
+        s++;
     }
-    printf("\n=== CSV Summary ===\n");
-    printf("Rows:   %d\n", t->row_count);
-    printf("Cols:   %d\n", t->col_count);
-    printf("Header: ");
-    for (int i = 0; i < t->col_count; i++) {
-        printf("%s", t->col_names[i] ? t->col_names[i] : "(col)");
-        if (i + 1 < t->col_count) printf(", ");
+
+    uint64_t man = 0;
+    const char *int_start = s;
+    s = scan_digits(s, end, &man);
+    size_t digits = (size_t)(s - int_start);
+    int64_t exp10 = 0;
+    if (s < end && *s == '.') {
+        const char *frac_start = ++s;
+        s = scan_digits(s, end, &man);
+        exp10 = -(int64_t)(s - frac_start);
+        digits += (size_t)(s - frac_start);
     }
-    printf("\n===================\n");
-}
+    if (digits == 0) return 0;
 
-static void view_first_n(const Table *t, int n) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char *e = s + 1;
+        int exp_neg = 0;
+        if (e < end && (*e == '+' || *e == '-')) {
+            exp_neg = *e == '-';
+            e++;
+        }
+        if (e == end || (unsigned)((unsigned char)*e - '0') > 9) return 0;
+        int64_t ev = 0;
+        for (; e < end && (unsigned)((unsigned char)*e - '0') <= 9; e++) {
+            if (ev < 100000) ev = ev * 10 + (*e - '0');
+        }
+        exp10 += exp_neg ? -ev : ev;
+        s = e;
     }
-    if (n <= 0 || n > t->row_count) n = t->row_count;
-    printf("\n-- First %d row(s) --\n", n);
-    print_header(t);
-    for (int i = 0; i < n; i++) {
-        print_row(t, &t->rows[i]);
+    if (s < end && *s != '\0') return 0;
+
+    if (digits > 19) {
+        /* Leading zeros do not count against the 19 digits man can hold. */
+        for (const char *z = int_start; z < end && (*z == '0' || *z == '.'); z++) {
+            if (*z == '0') digits--;
+        }
+        if (digits > 19) return -1;
     }
-}
 
-static void view_last_n(const Table *t, int n) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+    if (man == 0) {
+        *out = neg ? -0.0 : 0.0;
+        return 1;
     }
-    if (n <= 0 || n > t->row_count) n = t->row_count;
-    int start = t->row_count - n;
-    printf("\n-- Last %d row(s) --\n", n);
-    print_header(t);
-    for (int i = start; i < t->row_count; i++) {
-        print_row(t, &t->rows[i]);
+#if FLT_EVAL_METHOD == 0
+    if (man <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        double d = (double)man;
+        d = exp10 < 0 ? d / exact_pow10[-exp10] : d * exact_pow10[exp10];
+        *out = neg ? -d : d;
+        return 1;
     }
+#endif
+    if (exp10 < POW10_MIN_EXP || exp10 > POW10_MAX_EXP) return -1;
+    return eisel_lemire(man, exp10, neg, out) ? 1 : -1;
 }
 
-static void insert_row(Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
-    }
-    if (t->row_count >= MAX_ROWS) {
-        printf("Table is full.\n");
-        return;
+/* Could strtod() still accept text that is not a plain decimal? Only if
+ * it starts with white space, or a sign and then inf/nan or hex. */
+static int strtod_may_accept(const char *p, size_t len) {
+    if (len == 0) return 0;
+    if (*p == ' ' || (*p >= '\t' && *p <= '\r')) return 1;
+    if (*p == '+' || *p == '-') {
+        p++;
+        len--;
     }
+    if (len == 0) return 0;
+    char c = (char)(*p | 0x20);
+    return c == 'i' || c == 'n' || (len > 1 && *p == '0' && (p[1] | 0x20) == 'x');
+}
 
-    Row *r = &t->rows[t->row_count];
-    init_row(r);
-    r->cell_count = t->col_count;
-
-    char buf[MAX_FIELD_LEN];
-    printf("Inserting new row:\n");
-    for (int i = 0; i < t->col_count; i++) {
-        printf("Enter value for column '%s': ", t->col_names[i]);
-        read_line_stdin(buf, sizeof(buf));
-        r->cells[i] = str_dup(buf);
+/* The strtod() route, on a terminated copy of the text. */
+static int parse_number_strtod(const char *p, size_t len, double *out) {
+    char buf[64];
+    char *s = buf;
+    if (len >= sizeof(buf)) {
+        s = (char *)malloc(len + 1);
+        if (!s) return 0;
     }
-    t->row_count++;
-    printf("Row inserted at index %d.\n", t->row_count - 1);
+    memcpy(s, p, len);
+    s[len] = '\0';
+    char *end = NULL;
+    double v = strtod(s, &end);
+    int ok = end != s && *end == '\0';
+    if (ok) *out = v;
+    if (s != buf) free(s);
+    return ok;
 }
 
-static int find_row_index_by_value(const Table *t, int col_index, const char *value) {
-    if (!t || col_index < 0 || col_index >= t->col_count || !value) return -1;
-    for (int i = 0; i < t->row_count; i++) {
-        const char *cell = (col_index < t->rows[i].cell_count && t->rows[i].cells[col_index])
-                           ? t->rows[i].cells[col_index] : "";
-        if (strcmp(cell, value) == 0) {
-            return i;
-        }
+static int parse_number(const char *p, size_t len, double *out) {
+    double v;
+    int r = parse_decimal(p, len, &v);
+    if (r > 0) {
+        *out = v;
+        return 1;
     }
-    return -1;
+    if (r == 0 && !strtod_may_accept(p, len)) return 0;
+    return parse_number_strtod(p, len, out);
 }
 
-static void delete_one_row(Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+static int parse_double(const char *s, double *out) {
+    if (!s || !out) return 0;
+    return parse_number(s, strlen(s), out);
+}
+
+/* Strict integer syntax: an optional sign and decimal digits that fit in
+ * int64_t. Anything else numeric (spaces, fractions, exponents, hex) is
+ * left to parse_double(). */
+static int parse_cell_int64(Cell c, int64_t *out) {
+    if (!c.ptr || c.len == 0 || c.len > 20) return 0;
+    size_t i = 0;
+    int neg = 0;
+    if (c.ptr[0] == '+' || c.ptr[0] == '-') {
+        neg = c.ptr[0] == '-';
+        i = 1;
     }
-    char buf[64];
-    printf("Enter column index for condition (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+    if (i == c.len) return 0;
+    uint64_t v = 0;
+    /* Up to 16 digits cannot overflow; only the tail needs checking. */
+    for (; c.len - i >= 8 && i <= 12; i += 8) {
+        uint64_t w = load_digits8(c.ptr + i);
+        if (!is_digits8(w)) return 0;
+        v = v * 100000000u + parse_digits8(w);
     }
-    printf("Enter value to match: ");
-    char value[MAX_FIELD_LEN];
-    read_line_stdin(value, sizeof(value));
-
-    int idx = find_row_index_by_value(t, col, value);
-    if (idx < 0) {
-        printf("No row found where col[%d] = '%s'.\n", col, value);
-        return;
+    for (; i < c.len; i++) {
+        unsigned d = (unsigned)((unsigned char)c.ptr[i] - '0');
+        if (d > 9) return 0;
+        if (v > (UINT64_MAX - d) / 10) return 0;
+        v = v * 10 + d;
     }
-
-    printf("Deleting row %d:\n", idx);
-    print_row(t, &t->rows[idx]);
-
-    free_row(&t->rows[idx]);
-    for (int i = idx; i < t->row_count - 1; i++) {
-        t->rows[i] = t->rows[i + 1];
+    if (neg) {
+        if (v > (uint64_t)INT64_MAX + 1) return 0;
+        *out = v == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)v;
+    } else {
+        if (v > (uint64_t)INT64_MAX) return 0;
+        *out = (int64_t)v;
     }
-    init_row(&t->rows[t->row_count - 1]);
-    t->row_count--;
-    printf("Row deleted.\n");
+    return 1;
 }
 
-static void update_one_row(Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* parse_double() on a view. */
+static int parse_cell_double(Cell c, double *out) {
+    if (!c.ptr || c.len == 0) return 0;
+    return parse_number(c.ptr, c.len, out);
+}
+
+/* 64-bit hash of `len` bytes, eight at a time; a missing cell hashes like "". */
+static uint64_t hash_bytes(const char *p, size_t len) {
+    const uint64_t k = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = (uint64_t)len * k;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        h = (h ^ w) * k;
+        h ^= h >> 31;
+        p += 8;
+        len -= 8;
     }
-    char buf[64];
-    printf("Enter column index for condition (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+    if (len > 0) {
+        uint64_t w = 0;
+        memcpy(&w, p, len);
+        h = (h ^ w) * k;
+        h ^= h >> 31;
     }
-    printf("Enter value to match: ");
-    char value[MAX_FIELD_LEN];
-    read_line_stdin(value, sizeof(value));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
 
-    int idx = find_row_index_by_value(t, col, value);
-    if (idx < 0) {
-        printf("No row found where col[%d] = '%s'.\n", col, value);
-        return;
-    }
+static uint32_t index_hash(Cell c) {
+    return (uint32_t)hash_bytes(c.ptr, c.len);
+}
 
-    Row *r = &t->rows[idx];
-    printf("Current row:\n");
-    print_row(t, r);
+static int index_alloc_slots(HashIndex *ix, size_t cap) {
+    IndexSlot *slots = (IndexSlot *)malloc(cap * sizeof(IndexSlot));
+    if (!slots) return 0;
+    for (size_t i = 0; i < cap; i++) slots[i].row = -1;
+    ix->slots = slots;
+    ix->mask = cap - 1;
+    ix->count = 0;
+    return 1;
+}
 
-    printf("Enter new values (leave empty to keep current):\n");
-    for (int i = 0; i < t->col_count; i++) {
-        const char *current = (i < r->cell_count && r->cells[i]) ? r->cells[i] : "";
-        printf("Column '%s' [%s]: ", t->col_names[i], current);
-        read_line_stdin(buf, sizeof(buf));
-        if (strlen(buf) > 0) {
-            free(r->cells[i]);
-            r->cells[i] = str_dup(buf);
-        }
+static HashIndex *index_new(size_t rows) {
+    size_t cap = 16;
+    while (cap / 2 < rows) cap *= 2;
+    HashIndex *ix = (HashIndex *)malloc(sizeof(HashIndex));
+    if (!ix) return NULL;
+    if (!index_alloc_slots(ix, cap)) {
+        free(ix);
+        return NULL;
     }
+    return ix;
+}
 
-    printf("Row updated:\n");
-    print_row(t, r);
+static void index_free(HashIndex *ix) {
+    if (!ix) return;
+    free(ix->slots);
+    free(ix);
 }
 
-static void find_rows_by_value(const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* Insert without growing; the caller guarantees a free slot. */
+static void index_place(HashIndex *ix, uint32_t hash, int row) {
+    size_t i = hash & ix->mask;
+    while (ix->slots[i].row >= 0) i = (i + 1) & ix->mask;
+    ix->slots[i].hash = hash;
+    ix->slots[i].row = row;
+    ix->count++;
+}
+
+static int index_insert(HashIndex *ix, uint32_t hash, int row) {
+    if ((ix->count + 1) * 2 > ix->mask + 1) {
+        IndexSlot *old = ix->slots;
+        size_t old_cap = ix->mask + 1;
+        if (!index_alloc_slots(ix, old_cap * 2)) return 0;
+        for (size_t i = 0; i < old_cap; i++) {
+            if (old[i].row >= 0) index_place(ix, old[i].hash, old[i].row);
+        }
+        free(old);
     }
-    char buf[64];
-    printf("Enter column index to search (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+    index_place(ix, hash, row);
+    return 1;
+}
+
+/* Slot holding `row` under `hash`, or SIZE_MAX. */
+static size_t index_find_slot(const HashIndex *ix, uint32_t hash, int row) {
+    for (size_t i = hash & ix->mask; ix->slots[i].row >= 0; i = (i + 1) & ix->mask) {
+        if (ix->slots[i].row == row && ix->slots[i].hash == hash) return i;
     }
-    printf("Enter value to search: ");
-    char value[MAX_FIELD_LEN];
-    read_line_stdin(value, sizeof(value));
+    return SIZE_MAX;
+}
 
-    int found = 0;
-    print_header(t);
-    for (int i = 0; i < t->row_count; i++) {
-        const char *cell = (col < t->rows[i].cell_count && t->rows[i].cells[col])
-                           ? t->rows[i].cells[col] : "";
-        if (strcmp(cell, value) == 0) {
-            print_row(t, &t->rows[i]);
-            found = 1;
+/* Remove `row` and shift the rest of its probe run back, so lookups never
+ * need tombstones. */
+static void index_remove(HashIndex *ix, uint32_t hash, int row) {
+    size_t i = index_find_slot(ix, hash, row);
+    if (i == SIZE_MAX) return;
+    for (size_t j = (i + 1) & ix->mask; ix->slots[j].row >= 0; j = (j + 1) & ix->mask) {
+        size_t home = ix->slots[j].hash & ix->mask;
+        /* Move slot j into the hole unless its home lies cyclically in (i, j]. */
+        int stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            ix->slots[i] = ix->slots[j];
+            i = j;
         }
     }
-    if (!found) {
-        printf("No rows found.\n");
+    ix->slots[i].row = -1;
+    ix->count--;
+}
+
+/* Next row whose cell equals `value`, scanning the probe run from *pos
+ * (start at hash & mask); -1 when there are no more. */
+static int index_next(const HashIndex *ix, const Cell *cells, uint32_t hash,
+                      const char *value, size_t len, size_t *pos) {
+    for (size_t i = *pos; ix->slots[i].row >= 0; i = (i + 1) & ix->mask) {
+        const IndexSlot *slot = &ix->slots[i];
+        if (slot->hash == hash && cell_equals(cells[slot->row], value, len)) {
+            *pos = (i + 1) & ix->mask;
+            return slot->row;
+        }
     }
+    return -1;
+}
+
+static int row_log_init(RowLog *log, int row_cap) {
+    memset(log, 0, sizeof(*log));
+    log->stale = (uint8_t *)calloc((size_t)(row_cap > 0 ? row_cap : 1), 1);
+    return log->stale != NULL;
+}
+
+static void row_log_free(RowLog *log) {
+    free(log->stale);
+    free(log->rows);
+}
+
+/* Flag `row`; returns 0 when out of memory. */
+static int row_log_add(RowLog *log, int row) {
+    if (log->stale[row]) return 1;
+    if (log->len == log->cap) {
+        size_t cap = log->cap ? log->cap * 2 : 64;
+        int *rows = (int *)realloc(log->rows, cap * sizeof(int));
+        if (!rows) return 0;
+        log->rows = rows;
+        log->cap = cap;
+    }
+    log->stale[row] = 1;
+    log->rows[log->len++] = row;
+    return 1;
+}
+
+static void row_log_clear(RowLog *log) {
+    for (size_t i = 0; i < log->len; i++) log->stale[log->rows[i]] = 0;
+    log->len = 0;
+}
+
+/* Room for flags on `cap` rows, `old_cap` of which exist already. */
+static int row_log_reserve(RowLog *log, int old_cap, int cap) {
+    uint8_t *stale = (uint8_t *)realloc(log->stale, (size_t)cap);
+    if (!stale) return 0;
+    memset(stale + old_cap, 0, (size_t)(cap - old_cap));
+    log->stale = stale;
+    return 1;
+}
+
+static void range_index_free(RangeIndex *ix) {
+    if (!ix) return;
+    free(ix->entries);
+    row_log_free(&ix->log);
+    free(ix);
+}
+
+static void trigram_index_free(TrigramIndex *ix) {
+    if (!ix) return;
+    free(ix->slots);
+    free(ix->postings);
+    row_log_free(&ix->log);
+    free(ix);
+}
+
+static void init_table(Table *t) {
+    if (!t) return;
+    t->col_names = NULL;
+    t->cols = NULL;
+    t->col_count = 0;
+    t->row_count = 0;
+    t->row_cap = 0;
+    t->live = NULL;
+    t->dead_count = 0;
+    arena_init(&t->strings);
+    t->map = NULL;
+    t->map_len = 0;
+}
+
+static void free_table(Table *t) {
+    if (!t) return;
+    for (int c = 0; c < t->col_count; c++) {
+        free(t->col_names[c]);
+        free(t->cols[c].cells);
+        free(t->cols[c].ints);
+        free(t->cols[c].nums);
+        free(t->cols[c].valid);
+        index_free(t->cols[c].index);
+        range_index_free(t->cols[c].range);
+        trigram_index_free(t->cols[c].grams);
+    }
+    free(t->col_names);
+    free(t->cols);
+    free(t->live);
+    arena_free(&t->strings);
+    if (t->map) munmap((void *)t->map, t->map_len);
+    init_table(t);
+}
+
+/* Cells that still point into the file mapping are not arena-owned. */
+static int table_cell_is_mapped(const Table *t, Cell c) {
+    uintptr_t p = (uintptr_t)c.ptr;
+    uintptr_t base = (uintptr_t)t->map;
+    return t->map && p >= base && p <= base + t->map_len;
+}
+
+/* Account for an arena cell that is no longer referenced. */
+static void table_release_cell(Table *t, Cell c) {
+    if (c.ptr && !table_cell_is_mapped(t, c)) t->strings.dead += c.len + 1;
+}
+
+/* Copy every live arena cell into one fresh chunk and drop the old chunks. */
+static int table_compact_strings(Table *t) {
+    if (!t) return 0;
+    size_t live = 0;
+    for (int c = 0; c < t->col_count; c++) {
+        for (int i = 0; i < t->row_count; i++) {
+            Cell cell = t->cols[c].cells[i];
+            if (cell.ptr && !table_cell_is_mapped(t, cell)) live += cell.len + 1;
+        }
+    }
+
+    Arena fresh;
+    arena_init(&fresh);
+    if (live > 0 && !arena_reserve(&fresh, live)) return 0;
+
+    for (int c = 0; c < t->col_count; c++) {
+        Cell *cells = t->cols[c].cells;
+        for (int i = 0; i < t->row_count; i++) {
+            if (cells[i].ptr && !table_cell_is_mapped(t, cells[i])) {
+                cells[i] = arena_cell(&fresh, cells[i].ptr, cells[i].len);
+            }
+        }
+    }
+    arena_free(&t->strings);
+    t->strings = fresh;
+    return 1;
+}
+
+/* Updates and deletes leave garbage behind in the arena; once it makes up
+ * half of the arena, compact so memory tracks the live data. */
+static void table_maybe_compact(Table *t) {
+    if (!t) return;
+    if (t->strings.dead >= ARENA_COMPACT_BYTES && t->strings.dead * 2 >= t->strings.used) {
+        table_compact_strings(t);
+    }
+}
+
+/* 1 unless row `row` was deleted and not compacted away yet. */
+static inline int table_row_live(const Table *t, int row) {
+    return !t->live || ((t->live[row >> 6] >> (row & 63)) & 1);
+}
+
+/* The first live row at or after `row`, or row_count when there is none;
+ * a word of dead rows is skipped at once. */
+static inline int table_next_live(const Table *t, int row) {
+    if (!t->live) return row;
+    while (row < t->row_count) {
+        uint64_t bits = t->live[row >> 6] >> (row & 63);
+        if (bits) {
+            row += __builtin_ctzll(bits);
+            return row < t->row_count ? row : t->row_count;
+        }
+        row = (row | 63) + 1;
+    }
+    return t->row_count;
+}
+
+/* Rows that are not tombstones. */
+static int table_live_rows(const Table *t) {
+    return t->row_count - t->dead_count;
+}
+
+/* Allocate the bitmap with every existing row live, before the first
+ * delete; returns 0 when out of memory. */
+static int table_track_live(Table *t) {
+    if (t->live) return 1;
+    size_t words = ((size_t)t->row_cap + 63) / 64;
+    uint64_t *live = (uint64_t *)calloc(words ? words : 1, sizeof(uint64_t));
+    if (!live) return 0;
+    size_t full = (size_t)t->row_count / 64;
+    memset(live, 0xFF, full * sizeof(uint64_t));
+    if (t->row_count % 64) live[full] = (1ULL << (t->row_count % 64)) - 1;
+    t->live = live;
+    return 1;
+}
+
+/* Row view: the cell at (row, col); its ptr is NULL when the cell is missing. */
+static Cell table_cell(const Table *t, int row, int col) {
+    if (!t || row < 0 || row >= t->row_count || col < 0 || col >= t->col_count) {
+        Cell missing = { NULL, 0 };
+        return missing;
+    }
+    return t->cols[col].cells[row];
+}
+
+/* Make room for at least `need` rows in every column. Capacity doubles, so
+ * appends are amortized O(1) and columns never exceed twice the live size. */
+static int table_reserve_rows(Table *t, int need) {
+    if (!t || need < 0) return 0;
+    if (need <= t->row_cap) return 1;
+    int cap = t->row_cap > 0 ? t->row_cap : INITIAL_ROW_CAP;
+    while (cap < need) {
+        if (cap > INT_MAX / 2) {
+            cap = need;
+            break;
+        }
+        cap *= 2;
+    }
+    if (t->live) {
+        size_t old_words = ((size_t)t->row_cap + 63) / 64, words = ((size_t)cap + 63) / 64;
+        uint64_t *live = (uint64_t *)realloc(t->live, words * sizeof(uint64_t));
+        if (!live) return 0;
+        memset(live + old_words, 0, (words - old_words) * sizeof(uint64_t));
+        t->live = live;
+    }
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        Cell *cells = (Cell *)realloc(col->cells, (size_t)cap * sizeof(Cell));
+        if (!cells) return 0;
+        col->cells = cells;
+        if (col->range && !row_log_reserve(&col->range->log, t->row_cap, cap)) return 0;
+        if (col->grams && !row_log_reserve(&col->grams->log, t->row_cap, cap)) return 0;
+        if (col->type == COL_STRING) continue;
+        uint8_t *valid = (uint8_t *)realloc(col->valid, (size_t)cap);
+        if (!valid) return 0;
+        col->valid = valid;
+        if (col->type == COL_INT64) {
+            int64_t *ints = (int64_t *)realloc(col->ints, (size_t)cap * sizeof(int64_t));
+            if (!ints) return 0;
+            col->ints = ints;
+        } else {
+            double *nums = (double *)realloc(col->nums, (size_t)cap * sizeof(double));
+            if (!nums) return 0;
+            col->nums = nums;
+        }
+    }
+    t->row_cap = cap;
+    return 1;
+}
+
+/* Forget a column's parsed values; it is plain text from now on. */
+static void column_drop_types(Column *col) {
+    free(col->ints);
+    free(col->nums);
+    free(col->valid);
+    col->ints = NULL;
+    col->nums = NULL;
+    col->valid = NULL;
+    col->type = COL_STRING;
+}
+
+/* Turn an INT64 column into a DOUBLE one in place (both are 8 bytes). */
+static void column_widen_to_double(Column *col, int rows) {
+    double *nums = (double *)col->ints;
+    for (int i = 0; i < rows; i++) {
+        nums[i] = col->valid[i] ? (double)col->ints[i] : 0.0;
+    }
+    col->nums = nums;
+    col->ints = NULL;
+    col->type = COL_DOUBLE;
+}
+
+/* Infer the type of column `c`: INT64 if every non-empty cell is an
+ * integer, else DOUBLE if every one parses as a number, else STRING. A
+ * column with no values at all stays STRING. */
+static void table_infer_column(Table *t, int c) {
+    Column *col = &t->cols[c];
+    column_drop_types(col);
+    if (t->row_count == 0) return;
+
+    size_t cap = (size_t)t->row_cap;
+    col->ints = (int64_t *)malloc(cap * sizeof(int64_t));
+    col->valid = (uint8_t *)malloc(cap);
+    if (!col->ints || !col->valid) {
+        column_drop_types(col);
+        return;
+    }
+    col->type = COL_INT64;
+
+    int values = 0;
+    for (int i = 0; i < t->row_count; i++) {
+        Cell cell = col->cells[i];
+        if (!cell.ptr || cell.len == 0) {
+            col->valid[i] = 0;
+            if (col->type == COL_INT64) col->ints[i] = 0;
+            else col->nums[i] = 0.0;
+            continue;
+        }
+        col->valid[i] = 1;
+        values++;
+        if (col->type == COL_INT64) {
+            if (parse_cell_int64(cell, &col->ints[i])) continue;
+            column_widen_to_double(col, i);
+        }
+        if (!parse_cell_double(cell, &col->nums[i])) {
+            column_drop_types(col);
+            return;
+        }
+    }
+    if (values == 0) column_drop_types(col);
+}
+
+static void table_infer_types(Table *t) {
+    if (!t) return;
+    for (int c = 0; c < t->col_count; c++) {
+        table_infer_column(t, c);
+    }
+}
+
+/* Numeric value of a cell: native for typed columns, parsed for text. */
+static int table_cell_number(const Table *t, int row, int c, double *out) {
+    const Column *col = &t->cols[c];
+    switch (col->type) {
+    case COL_INT64:
+        if (!col->valid[row]) return 0;
+        *out = (double)col->ints[row];
+        return 1;
+    case COL_DOUBLE:
+        if (!col->valid[row]) return 0;
+        *out = col->nums[row];
+        return 1;
+    default:
+        return parse_cell_double(col->cells[row], out);
+    }
+}
+
+/* Unsigned key that orders like the double (no NaN; -0.0 as 0.0). */
+static uint64_t range_key(double v) {
+    uint64_t bits;
+    if (v == 0.0) v = 0.0;
+    memcpy(&bits, &v, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+/* Sort entries by value: LSD radix sort on 16-bit digits of range_key(),
+ * skipping digits every entry shares. Ties keep their input order. */
+static int sort_range_entries(RangeEntry *e, size_t n) {
+    if (n < 2) return 1;
+    RangeEntry *tmp = (RangeEntry *)malloc(n * sizeof(RangeEntry));
+    size_t *counts = (size_t *)malloc(65536 * sizeof(size_t));
+    if (!tmp || !counts) {
+        free(tmp);
+        free(counts);
+        return 0;
+    }
+    RangeEntry *src = e, *dst = tmp;
+    for (int shift = 0; shift < 64; shift += 16) {
+        memset(counts, 0, 65536 * sizeof(size_t));
+        for (size_t i = 0; i < n; i++) counts[(range_key(src[i].value) >> shift) & 0xFFFF]++;
+        if (counts[(range_key(src[0].value) >> shift) & 0xFFFF] == n) continue;
+        size_t sum = 0;
+        for (size_t d = 0; d < 65536; d++) {
+            size_t c = counts[d];
+            counts[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[counts[(range_key(src[i].value) >> shift) & 0xFFFF]++] = src[i];
+        }
+        RangeEntry *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != e) memcpy(e, src, n * sizeof(RangeEntry));
+    free(tmp);
+    free(counts);
+    return 1;
+}
+
+/* Entry for `row` if it holds a number; NaN never falls in a range. */
+static int range_entry(const Table *t, int c, int row, RangeEntry *out) {
+    double v;
+    if (!table_cell_number(t, row, c, &v) || v != v) return 0;
+    out->value = v;
+    out->row = row;
+    return 1;
+}
+
+/* CREATE ORDERED INDEX on column `c`; a column gets at most one. */
+static int table_create_range_index(Table *t, int c) {
+    if (!t || c < 0 || c >= t->col_count) return 0;
+    Column *col = &t->cols[c];
+    if (col->range) return 1;
+    RangeIndex *ix = (RangeIndex *)calloc(1, sizeof(RangeIndex));
+    if (!ix) return 0;
+    ix->entries = (RangeEntry *)malloc((size_t)(t->row_count > 0 ? t->row_count : 1) *
+                                       sizeof(RangeEntry));
+    if (!row_log_init(&ix->log, t->row_cap) || !ix->entries) {
+        range_index_free(ix);
+        return 0;
+    }
+    for (int i = 0; i < t->row_count; i++) {
+        if (range_entry(t, c, i, &ix->entries[ix->count])) ix->count++;
+    }
+    if (!sort_range_entries(ix->entries, ix->count)) {
+        range_index_free(ix);
+        return 0;
+    }
+    col->range = ix;
+    return 1;
+}
+
+/* Fold the log back in: drop stale entries, sort the logged rows' current
+ * values and merge the two sorted runs from the back. */
+static int range_index_merge(Table *t, int c) {
+    RangeIndex *ix = t->cols[c].range;
+    RowLog *log = &ix->log;
+    RangeEntry *fresh = (RangeEntry *)malloc((log->len > 0 ? log->len : 1) * sizeof(RangeEntry));
+    if (!fresh) return 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < ix->count; i++) {
+        if (!log->stale[ix->entries[i].row]) ix->entries[kept++] = ix->entries[i];
+    }
+    size_t m = 0;
+    for (size_t i = 0; i < log->len; i++) {
+        if (range_entry(t, c, log->rows[i], &fresh[m])) m++;
+    }
+    row_log_clear(log);
+    if (!sort_range_entries(fresh, m)) {
+        free(fresh);
+        return 0;
+    }
+
+    RangeEntry *entries = (RangeEntry *)realloc(ix->entries, (kept + m > 0 ? kept + m : 1) *
+                                                             sizeof(RangeEntry));
+    if (!entries) {
+        free(fresh);
+        return 0;
+    }
+    size_t i = kept, j = m, k = kept + m;
+    while (j > 0) {
+        if (i > 0 && entries[i - 1].value > fresh[j - 1].value) {
+            entries[--k] = entries[--i];
+        } else {
+            entries[--k] = fresh[--j];
+        }
+    }
+    ix->entries = entries;
+    ix->count = kept + m;
+    free(fresh);
+    return 1;
+}
+
+static void column_drop_range(Column *col) {
+    range_index_free(col->range);
+    col->range = NULL;
+}
+
+/* Row `row` of column `c` is about to change. When the index cannot be
+ * maintained it is dropped, and BETWEEN goes back to scanning. */
+static void column_range_touch(Table *t, int c, int row) {
+    RangeIndex *ix = t->cols[c].range;
+    if (ix->log.stale[row]) return;
+    if (ix->log.len >= 256 + ix->count / 4096 && !range_index_merge(t, c)) {
+        column_drop_range(&t->cols[c]);
+        return;
+    }
+    if (!row_log_add(&ix->log, row)) column_drop_range(&t->cols[c]);
+}
+
+static uint32_t gram_at(const char *p) {
+    return ((uint32_t)(unsigned char)p[0] << 16 | (uint32_t)(unsigned char)p[1] << 8 |
+            (uint32_t)(unsigned char)p[2]) + 1;
+}
+
+static size_t gram_home(const TrigramIndex *ix, uint32_t gram) {
+    uint32_t h = gram * 0x9E3779B1u;
+    return (h ^ (h >> 15)) & ix->mask;
+}
+
+static const GramSlot *gram_find(const TrigramIndex *ix, uint32_t gram) {
+    for (size_t i = gram_home(ix, gram); ix->slots[i].gram != 0; i = (i + 1) & ix->mask) {
+        if (ix->slots[i].gram == gram) return &ix->slots[i];
+    }
+    return NULL;
+}
+
+static int gram_alloc_slots(TrigramIndex *ix, size_t cap) {
+    GramSlot *slots = (GramSlot *)calloc(cap, sizeof(GramSlot));
+    if (!slots) return 0;
+    ix->slots = slots;
+    ix->mask = cap - 1;
+    ix->grams = 0;
+    return 1;
+}
+
+/* Slot for `gram`, added (with no rows yet) if new; NULL when out of memory. */
+static GramSlot *gram_insert(TrigramIndex *ix, uint32_t gram) {
+    size_t i = gram_home(ix, gram);
+    for (; ix->slots[i].gram != 0; i = (i + 1) & ix->mask) {
+        if (ix->slots[i].gram == gram) return &ix->slots[i];
+    }
+    if ((ix->grams + 1) * 2 > ix->mask + 1) {
+        GramSlot *old = ix->slots;
+        size_t old_cap = ix->mask + 1;
+        if (!gram_alloc_slots(ix, old_cap * 2)) {
+            ix->slots = old;
+            return NULL;
+        }
+        for (size_t k = 0; k < old_cap; k++) {
+            if (old[k].gram == 0) continue;
+            size_t j = gram_home(ix, old[k].gram);
+            while (ix->slots[j].gram != 0) j = (j + 1) & ix->mask;
+            ix->slots[j] = old[k];
+            ix->grams++;
+        }
+        free(old);
+        return gram_insert(ix, gram);
+    }
+    ix->slots[i].gram = gram;
+    ix->slots[i].last = -1;
+    ix->grams++;
+    return &ix->slots[i];
+}
+
+/* Two passes over the column: count each trigram once per row, then lay
+ * the posting lists out back to back and fill them in row order. */
+static TrigramIndex *trigram_build(const Table *t, int c) {
+    TrigramIndex *ix = (TrigramIndex *)calloc(1, sizeof(TrigramIndex));
+    if (!ix) return NULL;
+    if (!gram_alloc_slots(ix, 1024) || !row_log_init(&ix->log, t->row_cap)) {
+        trigram_index_free(ix);
+        return NULL;
+    }
+    const Cell *cells = t->cols[c].cells;
+    size_t total = 0;
+    for (int row = 0; row < t->row_count; row++) {
+        for (size_t i = 0; i + 3 <= cells[row].len; i++) {
+            GramSlot *g = gram_insert(ix, gram_at(cells[row].ptr + i));
+            if (!g) {
+                trigram_index_free(ix);
+                return NULL;
+            }
+            if (g->last != row) {
+                g->last = row;
+                g->count++;
+                total++;
+            }
+        }
+    }
+
+    ix->postings = (int *)malloc((total > 0 ? total : 1) * sizeof(int));
+    if (!ix->postings) {
+        trigram_index_free(ix);
+        return NULL;
+    }
+    size_t start = 0;
+    for (size_t i = 0; i <= ix->mask; i++) {
+        GramSlot *g = &ix->slots[i];
+        if (g->gram == 0) continue;
+        g->start = start;
+        start += g->count;
+        g->count = 0;
+        g->last = -1;
+    }
+    for (int row = 0; row < t->row_count; row++) {
+        for (size_t i = 0; i + 3 <= cells[row].len; i++) {
+            GramSlot *g = (GramSlot *)gram_find(ix, gram_at(cells[row].ptr + i));
+            if (g->last != row) {
+                g->last = row;
+                ix->postings[g->start + g->count++] = row;
+            }
+        }
+    }
+    return ix;
+}
+
+/* CREATE TRIGRAM INDEX on column `c`; a column gets at most one. */
+static int table_create_trigram_index(Table *t, int c) {
+    if (!t || c < 0 || c >= t->col_count) return 0;
+    if (t->cols[c].grams) return 1;
+    t->cols[c].grams = trigram_build(t, c);
+    return t->cols[c].grams != NULL;
+}
+
+/* Build afresh from the column, emptying the log; on failure the index is
+ * dropped and LIKE goes back to scanning. */
+static int trigram_rebuild(Table *t, int c) {
+    TrigramIndex *ix = trigram_build(t, c);
+    trigram_index_free(t->cols[c].grams);
+    t->cols[c].grams = ix;
+    return ix != NULL;
+}
+
+/* Row `row` of column `c` is about to change. */
+static void column_trigram_touch(Table *t, int c, int row) {
+    TrigramIndex *ix = t->cols[c].grams;
+    if (ix->log.stale[row]) return;
+    if (ix->log.len >= 256 + (size_t)t->row_count / 64) {
+        if (!trigram_rebuild(t, c)) return;
+        ix = t->cols[c].grams;
+    }
+    if (!row_log_add(&ix->log, row)) {
+        trigram_index_free(ix);
+        t->cols[c].grams = NULL;
+    }
+}
+
+/* Index `row` under the hash of `cell`. An index that cannot grow is
+ * dropped, and lookups on the column go back to scanning. */
+static void column_index_add(Column *col, int row, Cell cell) {
+    if (col->index && !index_insert(col->index, index_hash(cell), row)) {
+        index_free(col->index);
+        col->index = NULL;
+    }
+}
+
+/* CREATE INDEX on column `c`; a column is indexed at most once. */
+static int table_create_index(Table *t, int c) {
+    if (!t || c < 0 || c >= t->col_count) return 0;
+    Column *col = &t->cols[c];
+    if (col->index) return 1;
+    HashIndex *ix = index_new((size_t)t->row_count);
+    if (!ix) return 0;
+    for (int i = table_next_live(t, 0); i < t->row_count; i = table_next_live(t, i + 1)) {
+        index_place(ix, index_hash(col->cells[i]), i);
+    }
+    col->index = ix;
+    return 1;
+}
+
+/* Store `cell` at (row, col) and keep the typed values and any index in
+ * step: a value that no longer fits widens an INT64 column to DOUBLE, or
+ * turns the column back into text. */
+static void table_set_cell(Table *t, int row, int c, Cell cell) {
+    Column *col = &t->cols[c];
+    if (col->range) column_range_touch(t, c, row);
+    if (col->grams) column_trigram_touch(t, c, row);
+    if (col->index) {
+        uint32_t old_hash = index_hash(col->cells[row]);
+        if (old_hash != index_hash(cell)) {
+            index_remove(col->index, old_hash, row);
+            column_index_add(col, row, cell);
+        }
+    }
+    col->cells[row] = cell;
+    if (col->type == COL_STRING) return;
+
+    if (!cell.ptr || cell.len == 0) {
+        col->valid[row] = 0;
+        if (col->type == COL_INT64) col->ints[row] = 0;
+        else col->nums[row] = 0.0;
+        return;
+    }
+    if (col->type == COL_INT64) {
+        int64_t v;
+        if (parse_cell_int64(cell, &v)) {
+            col->ints[row] = v;
+            col->valid[row] = 1;
+            return;
+        }
+        column_widen_to_double(col, t->row_count);
+    }
+    double d;
+    if (parse_cell_double(cell, &d)) {
+        col->nums[row] = d;
+        col->valid[row] = 1;
+    } else {
+        column_drop_types(col);
+    }
+}
+
+static const char *column_type_name(ColumnType type) {
+    switch (type) {
+    case COL_INT64:  return "int64";
+    case COL_DOUBLE: return "double";
+    default:         return "string";
+    }
+}
+
+static const char *key_name(KeyConstraint key) {
+    return key == KEY_PRIMARY ? "PRIMARY KEY" : "UNIQUE";
+}
+
+/* Append a row of missing cells and return its index, or -1 when out of memory. */
+static int table_new_row(Table *t) {
+    if (!t || t->row_count == INT_MAX) return -1;
+    if (!table_reserve_rows(t, t->row_count + 1)) return -1;
+    int row = t->row_count++;
+    if (t->live) t->live[row >> 6] |= 1ULL << (row & 63);
+    Cell missing = { NULL, 0 };
+    for (int c = 0; c < t->col_count; c++) {
+        t->cols[c].cells[row] = missing;
+        column_index_add(&t->cols[c], row, missing);
+        if (t->cols[c].type != COL_STRING) table_set_cell(t, row, c, missing);
+    }
+    return row;
+}
+
+static int table_add_column(Table *t, const char *name) {
+    if (!t) return 0;
+    char **names = (char **)realloc(t->col_names,
+                                    (size_t)(t->col_count + 1) * sizeof(char *));
+    if (!names) return 0;
+    t->col_names = names;
+    Column *cols = (Column *)realloc(t->cols, (size_t)(t->col_count + 1) * sizeof(Column));
+    if (!cols) return 0;
+    t->cols = cols;
+
+    Column *col = &t->cols[t->col_count];
+    memset(col, 0, sizeof(*col));
+    col->type = COL_STRING;
+    if (t->row_cap > 0) {
+        col->cells = (Cell *)calloc((size_t)t->row_cap, sizeof(Cell));
+        if (!col->cells) return 0;
+    }
+    t->col_names[t->col_count] = str_dup(name ? name : "");
+    if (!t->col_names[t->col_count]) {
+        free(col->cells);
+        return 0;
+    }
+    t->col_count++;
+    return 1;
+}
+
+#if defined(FUZZING) || defined(BENCHMARK)
+/* Append a row holding copies of `values`; missing trailing cells stay NULL.
+ * Only the fuzzers and benchmarks build tables this way. */
+static int table_append_row(Table *t, const char *const values[], int count) {
+    if (!t || count < 0) return 0;
+    if (count > t->col_count) count = t->col_count;
+    int row = table_new_row(t);
+    if (row < 0) return 0;
+    for (int c = 0; c < count; c++) {
+        if (values[c]) {
+            table_set_cell(t, row, c, arena_cell(&t->strings, values[c], strlen(values[c])));
+        }
+    }
+    return 1;
+}
+
+/* Swap two rows, keeping the indexes in step. The sorts permute whole
+ * columns instead; the fuzzers use this to move rows under the indexes. */
+static void table_swap_rows(Table *t, int a, int b) {
+    if (t->live && table_row_live(t, a) != table_row_live(t, b)) {
+        t->live[a >> 6] ^= 1ULL << (a & 63);
+        t->live[b >> 6] ^= 1ULL << (b & 63);
+    }
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        if (col->index) {
+            size_t ia = index_find_slot(col->index, index_hash(col->cells[a]), a);
+            size_t ib = index_find_slot(col->index, index_hash(col->cells[b]), b);
+            if (ia != SIZE_MAX) col->index->slots[ia].row = b;
+            if (ib != SIZE_MAX) col->index->slots[ib].row = a;
+        }
+        if (col->range) column_range_touch(t, c, a);
+        if (col->range) column_range_touch(t, c, b);
+        if (col->grams) column_trigram_touch(t, c, a);
+        if (col->grams) column_trigram_touch(t, c, b);
+        Cell tmp = col->cells[a];
+        col->cells[a] = col->cells[b];
+        col->cells[b] = tmp;
+        if (col->type == COL_STRING) continue;
+        uint8_t v = col->valid[a];
+        col->valid[a] = col->valid[b];
+        col->valid[b] = v;
+        if (col->type == COL_INT64) {
+            int64_t x = col->ints[a];
+            col->ints[a] = col->ints[b];
+            col->ints[b] = x;
+        } else {
+            double x = col->nums[a];
+            col->nums[a] = col->nums[b];
+            col->nums[b] = x;
+        }
+    }
+}
+#endif
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Put row numbers back in row order: LSD radix sort on 11-bit digits,
+ * skipping digits all rows share; small lists use qsort(). */
+static int sort_row_ids(int *rows, size_t n) {
+    if (n < 256) {
+        if (n > 1) qsort(rows, n, sizeof(int), compare_ints);
+        return 1;
+    }
+    int *tmp = (int *)malloc(n * sizeof(int));
+    if (!tmp) return 0;
+    int *src = rows, *dst = tmp;
+    for (int shift = 0; shift < 33; shift += 11) {
+        size_t counts[2048] = { 0 };
+        for (size_t i = 0; i < n; i++) counts[((unsigned)src[i] >> shift) & 2047]++;
+        if (counts[((unsigned)src[0] >> shift) & 2047] == n) continue;
+        size_t sum = 0;
+        for (int d = 0; d < 2048; d++) {
+            size_t c = counts[d];
+            counts[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) dst[counts[((unsigned)src[i] >> shift) & 2047]++] = src[i];
+        int *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != rows) memcpy(rows, src, n * sizeof(int));
+    free(tmp);
+    return 1;
+}
+
+/* Group the non-empty cells of column `c` by value in one hashing pass.
+ * next[r] then links row r to the next row holding the same value (-1 at
+ * the end of a chain), and heads[0 .. count) lists, in row order, the
+ * first row of each value that more than one row holds. Returns that
+ * count, or -1 when out of memory; the arrays are malloc'd. When there
+ * are no duplicates and `set_out` is not NULL, the hash set built on the
+ * way, which then indexes every live row, is handed over in *set_out. */
+static int column_duplicates(const Table *t, int c, int **heads_out, int **next_out,
+                             HashIndex **set_out) {
+    size_t n = (size_t)t->row_count;
+    const Cell *cells = t->cols[c].cells;
+    HashIndex *seen = index_new(n);
+    int *next = (int *)malloc((n + 1) * sizeof(int));
+    int *last = (int *)malloc((n + 1) * sizeof(int));
+    int *heads = (int *)malloc((n / 2 + 1) * sizeof(int));
+    if (!seen || !next || !last || !heads) {
+        index_free(seen);
+        free(next);
+        free(last);
+        free(heads);
+        return -1;
+    }
+    int count = 0;
+    for (int r = 0; r < (int)n; r++) {
+        next[r] = -1;
+        if (!table_row_live(t, r)) continue;
+        uint32_t hash = index_hash(cells[r]);
+        if (cells[r].len == 0) {
+            index_place(seen, hash, r);
+            continue;
+        }
+        size_t pos = hash & seen->mask;
+        int head = index_next(seen, cells, hash, cells[r].ptr, cells[r].len, &pos);
+        if (head < 0) {
+            index_place(seen, hash, r);
+            last[r] = r;
+            continue;
+        }
+        if (last[head] == head) heads[count++] = head;
+        next[last[head]] = r;
+        last[head] = r;
+    }
+    if (set_out && count == 0) *set_out = seen;
+    else index_free(seen);
+    free(last);
+    /* Heads were found in order of their second rows. */
+    if (!sort_row_ids(heads, (size_t)count)) {
+        free(heads);
+        free(next);
+        return -1;
+    }
+    *heads_out = heads;
+    *next_out = next;
+    return count;
+}
+
+/* Rebuild every index from scratch, after the rows were moved wholesale. */
+static void table_rebuild_indexes(Table *t) {
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        if (col->index) {
+            index_free(col->index);
+            col->index = NULL;
+            table_create_index(t, c);
+        }
+        if (col->range) {
+            column_drop_range(col);
+            table_create_range_index(t, c);
+        }
+        if (col->grams) trigram_rebuild(t, c);
+    }
+}
+
+#define TOMBSTONE_MIN_DEAD 64    /* fewer tombstones are never compacted */
+
+static int tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+/* Drop the tombstones in a single pass, keeping the order of the live
+ * rows, which are renumbered. Indexes on the table are rebuilt; one that
+ * cannot be is dropped. */
+static void table_compact_rows(Table *t) {
+    if (!t || !t->live) return;
+    int kept = 0;
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        kept = 0;
+        for (int r = table_next_live(t, 0); r < t->row_count; r = table_next_live(t, r + 1)) {
+            col->cells[kept] = col->cells[r];
+            if (col->type != COL_STRING) {
+                col->valid[kept] = col->valid[r];
+                if (col->type == COL_INT64) col->ints[kept] = col->ints[r];
+                else col->nums[kept] = col->nums[r];
+            }
+            kept++;
+        }
+    }
+    free(t->live);
+    t->live = NULL;
+    t->row_count = t->col_count > 0 ? kept : 0;
+    t->dead_count = 0;
+    table_rebuild_indexes(t);
+    table_maybe_compact(t);
+}
+
+/* Release row `r`'s cells and mark it dead; it stays in the indexes until
+ * the compaction that must follow rebuilds them. */
+static void table_bury_row(Table *t, int r) {
+    if (!table_row_live(t, r)) return;
+    for (int c = 0; c < t->col_count; c++) table_release_cell(t, t->cols[c].cells[r]);
+    t->live[r >> 6] &= ~(1ULL << (r & 63));
+    t->dead_count++;
+}
+
+/* Delete row `row`: release and unindex its cells and leave a tombstone,
+ * so no other row moves. Once tombstones make up a quarter of the table
+ * they are compacted away together, which keeps deletes amortized O(1).
+ * Returns 0 when out of memory, leaving the row in place. */
+static int table_delete_row(Table *t, int row) {
+    if (!t || row < 0 || row >= t->row_count || !table_row_live(t, row)) return 1;
+    if (!table_track_live(t)) return 0;
+    Cell missing = { NULL, 0 };
+    for (int c = 0; c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        if (col->range) column_range_touch(t, c, row);
+        if (col->grams) column_trigram_touch(t, c, row);
+        if (col->index) index_remove(col->index, index_hash(col->cells[row]), row);
+        table_release_cell(t, col->cells[row]);
+        col->cells[row] = missing;
+        if (col->type == COL_STRING) continue;
+        col->valid[row] = 0;
+        if (col->type == COL_INT64) col->ints[row] = 0;
+        else col->nums[row] = 0.0;
+    }
+    t->live[row >> 6] &= ~(1ULL << (row & 63));
+    t->dead_count++;
+    if (t->dead_count >= tombstone_min_dead && (int64_t)t->dead_count * 4 >= t->row_count) {
+        table_compact_rows(t);
+    }
+    table_maybe_compact(t);
+    return 1;
+}
+
+/* Delete every row flagged in `drop` in a single pass, keeping the order
+ * of the rest. Indexes on the table are rebuilt; one that cannot be is
+ * dropped. Returns 0 when out of memory, leaving the table unchanged. */
+static int table_remove_rows(Table *t, const uint8_t *drop) {
+    if (!table_track_live(t)) return 0;
+    for (int r = 0; r < t->row_count; r++) {
+        if (drop[r]) table_bury_row(t, r);
+    }
+    table_compact_rows(t);
+    return 1;
+}
+
+#define TABLE_BATCH_MIN_ROWS 256  /* smaller changes keep indexes in step row by row */
+
+static int table_batch_min_rows = TABLE_BATCH_MIN_ROWS;
+
+/* Whether a change to `n` rows is better applied wholesale, rebuilding
+ * indexes once, than row by row. */
+static int table_batch_is_large(const Table *t, int n) {
+    return n > table_batch_min_rows + t->row_count / 64;
+}
+
+/* Delete rows[0 .. n), ascending, in one pass. A large batch, or one that
+ * reaches the compaction threshold, is tombstoned without touching the
+ * indexes and compacted once at the end, which rebuilds them; a smaller
+ * one is deleted row by row. Returns 0 when out of memory, leaving the
+ * table unchanged. */
+static int table_delete_rows(Table *t, const int *rows, int n) {
+    if (n == 0) return 1;
+    if (!table_track_live(t)) return 0;
+    int64_t dead = (int64_t)t->dead_count + n;
+    if (!table_batch_is_large(t, n) && (dead < tombstone_min_dead || dead * 4 < t->row_count)) {
+        for (int i = 0; i < n; i++) table_delete_row(t, rows[i]);
+        return 1;
+    }
+    for (int i = 0; i < n; i++) table_bury_row(t, rows[i]);
+    table_compact_rows(t);
+    return 1;
+}
+
+/* Store values[c] (a column is left alone when it is NULL) in every row of
+ * rows[0 .. n), in one pass. Past a few hundred rows, the indexes on the
+ * changed columns are dropped first and built once at the end rather than
+ * kept in step row by row; one that cannot be rebuilt stays dropped. Key
+ * constraints are the caller's to check. Returns 0 when out of memory,
+ * leaving the table unchanged. */
+static int table_update_rows(Table *t, const int *rows, int n, const char *const values[]) {
+    size_t bytes = 0;
+    for (int c = 0; c < t->col_count; c++) {
+        if (values[c]) bytes += (strlen(values[c]) + 1) * (size_t)n;
+    }
+    if (n == 0 || bytes == 0) return 1;
+    if (!arena_reserve(&t->strings, bytes)) return 0;
+
+    /* had[c]: 1, 2 and 4 for the hash, ordered and trigram index set aside. */
+    uint8_t *had = table_batch_is_large(t, n) ? (uint8_t *)calloc((size_t)t->col_count, 1) : NULL;
+    for (int c = 0; had && c < t->col_count; c++) {
+        Column *col = &t->cols[c];
+        if (!values[c]) continue;
+        if (col->index) {
+            index_free(col->index);
+            col->index = NULL;
+            had[c] |= 1;
+        }
+        if (col->range) {
+            column_drop_range(col);
+            had[c] |= 2;
+        }
+        if (col->grams) {
+            trigram_index_free(col->grams);
+            col->grams = NULL;
+            had[c] |= 4;
+        }
+    }
+
+    for (int c = 0; c < t->col_count; c++) {
+        if (!values[c]) continue;
+        size_t len = strlen(values[c]);
+        for (int i = 0; i < n; i++) {
+            table_release_cell(t, t->cols[c].cells[rows[i]]);
+            table_set_cell(t, rows[i], c, arena_cell(&t->strings, values[c], len));
+        }
+    }
+
+    for (int c = 0; had && c < t->col_count; c++) {
+        if (had[c] & 1) table_create_index(t, c);
+        if (had[c] & 2) table_create_range_index(t, c);
+        if (had[c] & 4) table_create_trigram_index(t, c);
+    }
+    free(had);
+    table_maybe_compact(t);
+    return 1;
+}
+
+/* A row other than `row` whose cell in column `c` equals `value`, or -1.
+ * Empty values never conflict. */
+static int table_key_conflict(const Table *t, int c, int row, const char *value, size_t len) {
+    if (len == 0) return -1;
+    const Column *col = &t->cols[c];
+    if (col->index) {
+        uint32_t hash = (uint32_t)hash_bytes(value, len);
+        size_t pos = hash & col->index->mask;
+        int other;
+        while ((other = index_next(col->index, col->cells, hash, value, len, &pos)) >= 0) {
+            if (other != row) return other;
+        }
+        return -1;
+    }
+    /* The index could not grow: the constraint still holds, by scanning. */
+    for (int i = 0; i < t->row_count; i++) {
+        if (i != row && cell_equals(col->cells[i], value, len)) return i;
+    }
+    return -1;
+}
+
+/* Delete the rows that keep column `c` from satisfying `key`: every
+ * repeat of a value after its first row and, for a PRIMARY KEY, every
+ * empty cell. Returns the number of rows deleted, or -1 when out of memory. */
+static int table_drop_key_violations(Table *t, int c, KeyConstraint key) {
+    int *heads, *next;
+    int dups = column_duplicates(t, c, &heads, &next, NULL);
+    if (dups < 0) return -1;
+    uint8_t *drop = (uint8_t *)calloc((size_t)t->row_count + 1, 1);
+    if (!drop) {
+        free(heads);
+        free(next);
+        return -1;
+    }
+    int dropped = 0;
+    for (int i = 0; i < dups; i++) {
+        for (int r = next[heads[i]]; r >= 0; r = next[r]) {
+            drop[r] = 1;
+            dropped++;
+        }
+    }
+    if (key == KEY_PRIMARY) {
+        for (int r = table_next_live(t, 0); r < t->row_count; r = table_next_live(t, r + 1)) {
+            if (t->cols[c].cells[r].len == 0) {
+                drop[r] = 1;
+                dropped++;
+            }
+        }
+    }
+    if (dropped > 0 && !table_remove_rows(t, drop)) dropped = -1;
+    free(drop);
+    free(heads);
+    free(next);
+    return dropped;
+}
+
+/* Declare `key` on column `c`, indexing the column if it is not already.
+ * Returns 1, 0 when out of memory, or -1 when the column's current values
+ * violate the constraint. A table has at most one PRIMARY KEY; the caller
+ * checks that. */
+static int table_add_key(Table *t, int c, KeyConstraint key) {
+    if (!t || c < 0 || c >= t->col_count) return 0;
+    Column *col = &t->cols[c];
+    if (key == KEY_PRIMARY) {
+        for (int r = table_next_live(t, 0); r < t->row_count; r = table_next_live(t, r + 1)) {
+            if (col->cells[r].len == 0) return -1;
+        }
+    }
+    int *heads, *next;
+    HashIndex *set = NULL;
+    int dups = column_duplicates(t, c, &heads, &next, col->index ? NULL : &set);
+    if (dups < 0) return 0;
+    free(heads);
+    free(next);
+    if (dups > 0) return -1;
+    if (set) col->index = set;
+    if (key > col->key) col->key = key;
+    return 1;
+}
+
+static void print_row(const Table *t, int row) {
+    if (!t) return;
+    for (int i = 0; i < t->col_count; i++) {
+        Cell val = table_cell(t, row, i);
+        if (val.ptr) {
+            fwrite(val.ptr, 1, val.len, stdout);
+        } else {
+            printf("NULL");
+        }
+        if (i + 1 < t->col_count) printf(" | ");
+    }
+    printf("\n");
+}
+
+static void print_header(const Table *t) {
+    if (!t) return;
+    for (int i = 0; i < t->col_count; i++) {
+        printf("%s", t->col_names[i] ? t->col_names[i] : "(col)");
+        if (i + 1 < t->col_count) printf(" | ");
+    }
+    printf("\n");
+}
+
+/*
+ * RFC 4180 quoting: a field that starts with '"' runs to the matching
+ * closing quote, may contain commas and newlines, and writes a literal
+ * quote as "". A quote anywhere else in a field is an ordinary byte, as
+ * in 5'10".
+ */
+
+/* Quote state before each byte of a record. */
+enum { CSV_FIELD_START, CSV_IN_FIELD, CSV_IN_QUOTES, CSV_AFTER_QUOTE };
+
+/* State after byte `c`: a quote opens a quoted section only at the start
+ * of a field or right after a closing quote (the "" escape). */
+static int csv_quote_step(int state, char c) {
+    if (state == CSV_IN_QUOTES) return c == '"' ? CSV_AFTER_QUOTE : CSV_IN_QUOTES;
+    if (c == ',' || c == '\n') return CSV_FIELD_START;
+    if (c == '"' && state != CSV_IN_FIELD) return CSV_IN_QUOTES;
+    return CSV_IN_FIELD;
+}
+
+/* Decode a quoted field into `out` (room for `len` bytes); returns the
+ * decoded length. Bytes after the closing quote are kept as they are. */
+static size_t csv_unquote(const char *p, size_t len, char *out) {
+    size_t n = 0;
+    size_t i = 1;
+    while (i < len) {
+        if (p[i] == '"') {
+            if (i + 1 < len && p[i + 1] == '"') {
+                out[n++] = '"';
+                i += 2;
+                continue;
+            }
+            i++;
+            break;
+        }
+        out[n++] = p[i++];
+    }
+    while (i < len) out[n++] = p[i++];
+    return n;
+}
+
+static int csv_is_quoted(const char *p, size_t len) {
+    return len > 0 && p[0] == '"';
+}
+
+/* Offset of the first comma (or, with `stop_at_newline`, newline) that is
+ * not inside quotes, or `len` when there is none. */
+static size_t csv_next_separator(const char *p, size_t len, int stop_at_newline) {
+    size_t end = len;
+    if (stop_at_newline) {
+        const char *nl = (const char *)memchr(p, '\n', len);
+        if (nl) end = (size_t)(nl - p);
+    }
+    const char *comma = (const char *)memchr(p, ',', end);
+    if (comma) end = (size_t)(comma - p);
+    if (!memchr(p, '"', end)) return end;
+
+    int state = CSV_FIELD_START;
+    for (size_t i = 0; i < len; i++) {
+        if (state != CSV_IN_QUOTES && (p[i] == ',' || (stop_at_newline && p[i] == '\n'))) return i;
+        state = csv_quote_step(state, p[i]);
+    }
+    return len;
+}
+
+int parse_csv_line(const char *line, char *fields[], int max_fields) {
+    if (!line || !fields || max_fields <= 0) return 0;
+
+    size_t len = strlen(line);
+    int count = 0;
+    const char *p = line;
+    const char *end = line + len;
+    while (count < max_fields) {
+        size_t flen = csv_next_separator(p, (size_t)(end - p), 0);
+        char *field = (char *)malloc(flen + 1);
+        if (!field) {
+            for (int i = 0; i < count; i++) free(fields[i]);
+            return 0;
+        }
+        if (csv_is_quoted(p, flen)) {
+            field[csv_unquote(p, flen, field)] = '\0';
+        } else {
+            memcpy(field, p, flen);
+            field[flen] = '\0';
+        }
+        fields[count++] = field;
+        if (p + flen == end) break;
+        p += flen + 1;
+    }
+
+    return count;
+}
+
+/* Split the bytes [p, p + len) on unquoted commas into at most
+ * `max_fields` views. Nothing is copied or unquoted; the views point into
+ * the caller's buffer. */
+static int split_csv_view(const char *p, size_t len, Cell fields[], int max_fields) {
+    if (!p || !fields || max_fields <= 0) return 0;
+    const char *end = p + len;
+    int count = 0;
+    if (!memchr(p, '"', len)) {
+        while (count < max_fields) {
+            const char *comma = (const char *)memchr(p, ',', (size_t)(end - p));
+            fields[count].ptr = p;
+            fields[count].len = (size_t)((comma ? comma : end) - p);
+            count++;
+            if (!comma) break;
+            p = comma + 1;
+        }
+        return count;
+    }
+    while (count < max_fields) {
+        size_t flen = csv_next_separator(p, (size_t)(end - p), 0);
+        fields[count].ptr = p;
+        fields[count].len = flen;
+        count++;
+        if (p + flen == end) break;
+        p += flen + 1;
+    }
+    return count;
+}
+
+static int count_csv_fields(const char *p, size_t len) {
+    int count = 1;
+    const char *end = p + len;
+    for (;;) {
+        size_t flen = csv_next_separator(p, (size_t)(end - p), 0);
+        if (p + flen == end) break;
+        if (count < INT_MAX) count++;
+        p += flen + 1;
+    }
+    return count;
+}
+
+static int table_set_header(Table *t, const char *line, size_t len) {
+    int count = count_csv_fields(line, len);
+    Cell *names = (Cell *)malloc((size_t)count * sizeof(Cell));
+    if (!names) return 0;
+    count = split_csv_view(line, len, names, count);
+    for (int i = 0; i < count; i++) {
+        char *name = (char *)malloc(names[i].len + 1);
+        if (!name) {
+            free(names);
+            return 0;
+        }
+        if (csv_is_quoted(names[i].ptr, names[i].len)) {
+            name[csv_unquote(names[i].ptr, names[i].len, name)] = '\0';
+        } else {
+            memcpy(name, names[i].ptr, names[i].len);
+            name[names[i].len] = '\0';
+        }
+        int ok = table_add_column(t, name);
+        free(name);
+        if (!ok) {
+            free(names);
+            return 0;
+        }
+    }
+    free(names);
+    return 1;
+}
+
+/* Turn a raw field view into a cell. Plain fields and quoted fields
+ * without "" escapes stay views; the rest are decoded into the arena. */
+static int table_field_cell(Table *t, Cell raw, Cell *out) {
+    if (!csv_is_quoted(raw.ptr, raw.len)) {
+        *out = raw;
+        return 1;
+    }
+    if (raw.len >= 2 && raw.ptr[raw.len - 1] == '"'
+        && !memchr(raw.ptr + 1, '"', raw.len - 2)) {
+        out->ptr = raw.ptr + 1;
+        out->len = raw.len - 2;
+        return 1;
+    }
+    char *p = (char *)arena_alloc(&t->strings, raw.len + 1);
+    if (!p) return 0;
+    size_t n = csv_unquote(raw.ptr, raw.len, p);
+    p[n] = '\0';
+    out->ptr = p;
+    out->len = n;
+    return 1;
+}
+
+/* Append a row from the raw fields of one record. `unquote` is zero when
+ * the record is known to hold no quotes, which skips looking at fields. */
+static int table_add_fields(Table *t, const Cell fields[], int count, int unquote) {
+    int row = table_new_row(t);
+    if (row < 0) return 0;
+    for (int i = 0; i < count; i++) {
+        Cell cell = fields[i];
+        if (unquote && csv_is_quoted(cell.ptr, cell.len) && !table_field_cell(t, cell, &cell)) {
+            return 0;
+        }
+        t->cols[i].cells[row] = cell;
+    }
+    return 1;
+}
+
+/*
+ * Vectorized tokenizer. Input is classified 64 bytes at a time into
+ * bitmasks of commas, newlines and quotes; the set bits are then
+ * flattened into an array of separator offsets, so field boundaries for a
+ * whole window come out of one tight loop instead of a strchr() per field.
+ * The widest block scanner the CPU supports is picked on first use.
+ *
+ * Quotes are resolved without branching per byte: the prefix XOR of the
+ * quote mask has a bit set for every byte inside quotes, and separators
+ * under that mask are dropped. An escaped "" toggles twice, so it needs
+ * no special case here; quotes in the middle of unquoted fields are
+ * masked out first.
+ */
+typedef struct {
+    uint64_t comma;
+    uint64_t newline;
+    uint64_t quote;
+} CsvBlockMasks;
+
+typedef void (*CsvBlockScanner)(const char *block, CsvBlockMasks *m);
+
+static void csv_scan_block_scalar(const char *block, CsvBlockMasks *m) {
+    uint64_t comma = 0, newline = 0, quote = 0;
+    for (int i = 0; i < CSV_BLOCK; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        if (block[i] == ',') comma |= bit;
+        else if (block[i] == '\n') newline |= bit;
+        else if (block[i] == '"') quote |= bit;
+    }
+    m->comma = comma;
+    m->newline = newline;
+    m->quote = quote;
+}
+
+#ifdef CSV_HAVE_X86_SIMD
+__attribute__((target("sse2")))
+static void csv_scan_block_sse2(const char *block, CsvBlockMasks *m) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i quote = _mm_set1_epi8('"');
+    uint64_t c = 0, n = 0, q = 0;
+    for (int i = 0; i < CSV_BLOCK / 16; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+        c |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, comma)) << (16 * i);
+        n |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)) << (16 * i);
+        q |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << (16 * i);
+    }
+    m->comma = c;
+    m->newline = n;
+    m->quote = q;
+}
+
+__attribute__((target("avx2")))
+static void csv_scan_block_avx2(const char *block, CsvBlockMasks *m) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i quote = _mm256_set1_epi8('"');
+    __m256i lo = _mm256_loadu_si256((const __m256i *)block);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(block + 32));
+    m->comma = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, comma))
+             | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, comma)) << 32;
+    m->newline = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline))
+               | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)) << 32;
+    m->quote = (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote))
+             | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)) << 32;
+}
+#endif
+
+static CsvBlockScanner csv_scanner = NULL;
+static const char *csv_scanner_name = "scalar";
+
+static CsvBlockScanner csv_block_scanner(void) {
+    if (!csv_scanner) {
+        CsvBlockScanner scan = csv_scan_block_scalar;
+        const char *name = "scalar";
+#ifdef CSV_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            scan = csv_scan_block_avx2;
+            name = "avx2";
+        } else if (__builtin_cpu_supports("sse2")) {
+            scan = csv_scan_block_sse2;
+            name = "sse2";
+        }
+#endif
+        csv_scanner_name = name;
+        csv_scanner = scan;
+    }
+    return csv_scanner;
+}
+
+static size_t csv_flatten_bits(uint64_t bits, uint32_t base, uint32_t *pos, size_t n) {
+    while (bits) {
+        pos[n++] = base + (uint32_t)__builtin_ctzll(bits);
+        bits &= bits - 1;
+    }
+    return n;
+}
+
+/* Bit i of the result is the XOR of bits 0..i of `x`. */
+static uint64_t csv_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/* Quote state carried from one window to the next. */
+typedef struct {
+    uint64_t quoted;    /* all ones while inside quotes, zero outside */
+    int saw_quote;      /* the last window contained a quote */
+    uint64_t in_field;  /* 1 when a quote next would be mid-field */
+} CsvScanState;
+
+/* Bytes of one block, of which the first `len` are input, that lie
+ * inside quotes. A quote that would open a section mid-field is literal:
+ * the earliest such quote is dropped from the mask and the prefix XOR
+ * redone, until none is left. */
+static uint64_t csv_block_quoted(const CsvBlockMasks *m, CsvScanState *st, int len) {
+    uint64_t quote = m->quote;
+    uint64_t inside, mid_field;
+    for (;;) {
+        inside = csv_prefix_xor(quote) ^ st->quoted;
+        mid_field = ~(m->comma | m->newline | (quote & ~inside));
+        uint64_t stray = quote & inside & (mid_field << 1 | st->in_field);
+        if (!stray) break;
+        quote ^= stray & ((uint64_t)0 - stray);
+    }
+    st->quoted = (uint64_t)0 - (inside >> (len - 1) & 1);
+    st->in_field = mid_field >> (len - 1) & 1;
+    st->saw_quote |= m->quote != 0;
+    return inside;
+}
+
+/* Separators of one block that lie outside quotes. */
+static uint64_t csv_block_separators(const CsvBlockMasks *m, CsvScanState *st, int len) {
+    return (m->comma | m->newline) & ~csv_block_quoted(m, st, len);
+}
+
+/* Offsets of every unquoted comma and newline in p[0..len),
+ * len <= CSV_WINDOW. `pos` must have room for `len` entries; `st` starts
+ * zeroed and is passed unchanged from one window to the next. */
+static size_t csv_index_separators(const char *p, size_t len, uint32_t *pos, CsvScanState *st) {
+    CsvBlockScanner scan = csv_block_scanner();
+    CsvBlockMasks m;
+    size_t n = 0;
+    size_t i = 0;
+    st->saw_quote = 0;
+    for (; i + CSV_BLOCK <= len; i += CSV_BLOCK) {
+        scan(p + i, &m);
+        n = csv_flatten_bits(csv_block_separators(&m, st, CSV_BLOCK), (uint32_t)i, pos, n);
+    }
+    if (i < len) {
+        char tail[CSV_BLOCK];
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, p + i, len - i);
+        scan(tail, &m);
+        n = csv_flatten_bits(csv_block_separators(&m, st, (int)(len - i)), (uint32_t)i, pos, n);
+    }
+    return n;
+}
+
+/* Close the record [record, end): fields[0..count) were cut at commas and
+ * `field` starts the last one. Trailing CRs are trimmed, blank lines skipped. */
+static int csv_emit_record(Table *t, Cell fields[], int count, int unquote,
+                           const char *record, const char *field, const char *end) {
+    while (end > record && end[-1] == '\r') end--;
+    if (end == record) return 1;
+    if (count < t->col_count) {
+        fields[count].ptr = field;
+        fields[count].len = (size_t)(end - field);
+        count++;
+    }
+    return table_add_fields(t, fields, count, unquote);
+}
+
+/* Append one row per record in [data, data + size); cells are views
+ * unless a quoted field has to be unescaped. */
+static int csv_parse_records(Table *t, const char *data, size_t size) {
+    Cell *fields = (Cell *)malloc((size_t)t->col_count * sizeof(Cell));
+    uint32_t *pos = (uint32_t *)malloc(CSV_WINDOW * sizeof(uint32_t));
+    if (!fields || !pos) {
+        free(fields);
+        free(pos);
+        return 0;
+    }
+
+    const int ncols = t->col_count;
+    const char *record = data;
+    const char *field = data;
+    CsvScanState st = { 0, 0, 0 };
+    int unquote = 0;            /* a quote was seen since `record` began */
+    int count = 0;
+    int ok = 1;
+
+    for (size_t off = 0; ok && off < size; off += CSV_WINDOW) {
+        const char *base = data + off;
+        size_t len = size - off < CSV_WINDOW ? size - off : CSV_WINDOW;
+        size_t n = csv_index_separators(base, len, pos, &st);
+        unquote |= st.saw_quote;
+        for (size_t k = 0; k < n; k++) {
+            const char *p = base + pos[k];
+            if (*p == ',') {
+                if (count < ncols) {
+                    fields[count].ptr = field;
+                    fields[count].len = (size_t)(p - field);
+                    count++;
+                }
+                field = p + 1;
+            } else {
+                if (!csv_emit_record(t, fields, count, unquote, record, field, p)) {
+                    ok = 0;
+                    break;
+                }
+                unquote = st.saw_quote;
+                count = 0;
+                record = field = p + 1;
+            }
+        }
+    }
+    if (ok && record < data + size) {
+        ok = csv_emit_record(t, fields, count, unquote, record, field, data + size);
+    }
+
+    free(fields);
+    free(pos);
+    return ok;
+}
+
+/*
+ * Parallel loading. The body is cut into one byte range per thread, each
+ * starting after a newline. A first pass finds whether every range ends
+ * inside quotes, both if it starts outside and if it starts inside them,
+ * which gives the exact quote state at each cut; cuts inside quotes then
+ * move forward to the next record boundary (an unquoted newline), so no
+ * record straddles two ranges. Ranges are parsed into private tables and
+ * appended in file order, so the result is the same for any number of
+ * threads.
+ */
+
+/* Threads for loading, grouping and sorting; 0 means one per online CPU. */
+static int csv_load_threads = 0;
+/* Smallest byte range worth a thread of its own. */
+static size_t csv_parallel_min_chunk = CSV_PARALLEL_MIN_CHUNK;
+
+typedef struct {
+    const Table *header;    /* columns to copy into `part` */
+    const char *data;
+    size_t size;
+    int quoted_end[2];      /* first pass, starting outside / inside quotes */
+    Table part;             /* second pass */
+    int ok;
+} CsvChunk;
+
+/* Whether p[0 .. len), which starts a field, ends inside quotes:
+ * ends[0] when it starts outside them and ends[1] when inside. The two
+ * are tracked together until their states meet. */
+static void csv_quoted_ends(const char *p, size_t len, int ends[2]) {
+    CsvBlockScanner scan = csv_block_scanner();
+    CsvBlockMasks m;
+    CsvScanState st[2] = { { 0, 0, 0 }, { ~(uint64_t)0, 0, 0 } };
+    int met = 0;
+    for (size_t i = 0; i < len; i += CSV_BLOCK) {
+        char tail[CSV_BLOCK];
+        const char *block = p + i;
+        int bytes = CSV_BLOCK;
+        if (len - i < CSV_BLOCK) {
+            bytes = (int)(len - i);
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, p + i, len - i);
+            block = tail;
+        }
+        scan(block, &m);
+        csv_block_quoted(&m, &st[0], bytes);
+        if (met) continue;
+        csv_block_quoted(&m, &st[1], bytes);
+        met = st[0].quoted == st[1].quoted && st[0].in_field == st[1].in_field;
+    }
+    ends[0] = st[0].quoted != 0;
+    ends[1] = met ? ends[0] : st[1].quoted != 0;
+}
+
+/* First record boundary after `p`, which starts a field, given whether
+ * `p` is inside quotes. */
+static const char *csv_next_record(const char *p, const char *end, int quoted) {
+    int state = quoted ? CSV_IN_QUOTES : CSV_FIELD_START;
+    for (; p < end; p++) {
+        if (*p == '\n' && state != CSV_IN_QUOTES) return p + 1;
+        state = csv_quote_step(state, *p);
+    }
+    return end;
+}
+
+static void *csv_quoted_ends_worker(void *arg) {
+    CsvChunk *c = (CsvChunk *)arg;
+    csv_quoted_ends(c->data, c->size, c->quoted_end);
+    return NULL;
+}
+
+static void *csv_parse_chunk_worker(void *arg) {
+    CsvChunk *c = (CsvChunk *)arg;
+    c->ok = 1;
+    for (int i = 0; c->ok && i < c->header->col_count; i++) {
+        c->ok = table_add_column(&c->part, c->header->col_names[i]);
+    }
+    if (c->ok) c->ok = csv_parse_records(&c->part, c->data, c->size);
+    return NULL;
+}
+
+/* Run `fn` on each of the `n` jobs in `jobs` (`job_size` bytes apart), one
+ * thread each; the caller takes job 0 and any job whose thread could not
+ * be started. */
+static void run_jobs(void *jobs, size_t job_size, int n, void *(*fn)(void *)) {
+    pthread_t threads[CSV_MAX_THREADS];
+    int started[CSV_MAX_THREADS];
+    char *base = (char *)jobs;
+    for (int i = 1; i < n; i++) {
+        started[i] = pthread_create(&threads[i], NULL, fn, base + (size_t)i * job_size) == 0;
+    }
+    fn(base);
+    for (int i = 1; i < n; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        else fn(base + (size_t)i * job_size);
+    }
+}
+
+/* Threads to use for `work` independent units: the configured count,
+ * capped by the work available. */
+static int worker_count(size_t work) {
+    long n = csv_load_threads;
+    if (n <= 0) n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > CSV_MAX_THREADS) n = CSV_MAX_THREADS;
+    if ((size_t)n > work) n = (long)work;
+    return n < 1 ? 1 : (int)n;
+}
+
+static int csv_thread_count(size_t size) {
+    size_t min_chunk = csv_parallel_min_chunk ? csv_parallel_min_chunk : 1;
+    return worker_count(size / min_chunk);
+}
+
+/* Append the rows of `part` to `t`; both have the same columns. */
+static int table_append_part(Table *t, Table *part) {
+    if (part->row_count == 0) return 1;
+    if (part->row_count > INT_MAX - t->row_count) return 0;
+    if (!table_reserve_rows(t, t->row_count + part->row_count)) return 0;
+    for (int c = 0; c < t->col_count; c++) {
+        memcpy(t->cols[c].cells + t->row_count, part->cols[c].cells,
+               (size_t)part->row_count * sizeof(Cell));
+    }
+    t->row_count += part->row_count;
+    arena_adopt(&t->strings, &part->strings);
+    return 1;
+}
+
+/* csv_parse_records() spread over csv_thread_count() threads. */
+static int csv_parse_parallel(Table *t, const char *data, size_t size) {
+    int n = csv_thread_count(size);
+    if (n <= 1) return csv_parse_records(t, data, size);
+
+    CsvChunk chunks[CSV_MAX_THREADS];
+    const char *start[CSV_MAX_THREADS + 1];
+    const char *end = data + size;
+
+    csv_block_scanner();    /* pick the scanner before the threads race to */
+    start[0] = data;
+    for (int i = 1; i < n; i++) {
+        const char *cut = data + size / (size_t)n * (size_t)i;
+        const char *nl = (const char *)memchr(cut, '\n', (size_t)(end - cut));
+        start[i] = nl ? nl + 1 : end;
+    }
+    start[n] = end;
+    for (int i = 0; i < n; i++) {
+        chunks[i].data = start[i];
+        chunks[i].size = (size_t)(start[i + 1] - start[i]);
+    }
+    run_jobs(chunks, sizeof(CsvChunk), n, csv_quoted_ends_worker);
+
+    int quoted = 0;
+    for (int i = 1; i < n; i++) {
+        quoted = chunks[i - 1].quoted_end[quoted];
+        if (quoted) start[i] = csv_next_record(start[i], end, 1);
+        if (start[i] < start[i - 1]) start[i] = start[i - 1];
+    }
+    for (int i = 0; i < n; i++) {
+        chunks[i].header = t;
+        chunks[i].data = start[i];
+        chunks[i].size = (size_t)(start[i + 1] - start[i]);
+        init_table(&chunks[i].part);
+    }
+    run_jobs(chunks, sizeof(CsvChunk), n, csv_parse_chunk_worker);
+
+    /* Keep whatever parsed before the first failure, as the serial loader does. */
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        if (ok && chunks[i].part.col_count == t->col_count) {
+            ok = table_append_part(t, &chunks[i].part) && chunks[i].ok;
+        } else {
+            ok = 0;
+        }
+        free_table(&chunks[i].part);
+    }
+    return ok;
+}
+
+typedef struct {
+    Table *t;
+    int first;
+    int step;
+} InferJob;
+
+static void *infer_columns_worker(void *arg) {
+    InferJob *job = (InferJob *)arg;
+    for (int c = job->first; c < job->t->col_count; c += job->step) {
+        table_infer_column(job->t, c);
+    }
+    return NULL;
+}
+
+/* table_infer_types() with the columns dealt out across the loader threads. */
+static void table_infer_types_parallel(Table *t) {
+    int n = t->row_count >= 65536 ? worker_count((size_t)t->col_count) : 1;
+    if (n <= 1) {
+        table_infer_types(t);
+        return;
+    }
+    InferJob jobs[CSV_MAX_THREADS];
+    for (int i = 0; i < n; i++) {
+        jobs[i].t = t;
+        jobs[i].first = i;
+        jobs[i].step = n;
+    }
+    run_jobs(jobs, sizeof(InferJob), n, infer_columns_worker);
+}
+
+/* Set the columns from the header record at the start of `data`.
+ * Returns the header's length including its newline, or 0 when out of
+ * memory. */
+static size_t csv_read_header(Table *t, const char *data, size_t size) {
+    size_t consumed = (size_t)(csv_next_record(data, data + size, 0) - data);
+    size_t len = consumed;
+    if (len > 0 && data[len - 1] == '\n') len--;
+    while (len > 0 && data[len - 1] == '\r') len--;
+    return table_set_header(t, data, len) ? consumed : 0;
+}
+
+/* Parse a whole CSV image in place. Cells become views into `data`,
+ * which must stay alive as long as the table does. */
+static int load_csv_buffer(Table *t, const char *data, size_t size) {
+    size_t header = csv_read_header(t, data, size);
+    if (header == 0) {
+        printf("Out of memory.\n");
+        return 0;
+    }
+    if (!csv_parse_parallel(t, data + header, size - header)) {
+        printf("Out of memory; remaining lines are ignored.\n");
+    }
+    return 1;
+}
+
+/*
+ * Buffered record reader for inputs that cannot be mapped. Input is read
+ * in large blocks into one reusable buffer, and the reader hands out the
+ * longest prefix that ends on a record boundary (an unquoted newline), so
+ * records of any length and quoted line breaks come through whole. The
+ * buffer only grows when a single record does not fit in it.
+ */
+typedef struct {
+    FILE *f;
+    char *buf;
+    size_t cap;
+    size_t len;         /* bytes buffered */
+    size_t scanned;     /* bytes already searched for boundaries */
+    size_t boundary;    /* end of the last whole record found, or 0 */
+    CsvScanState state; /* quote state at buf + scanned */
+    int eof;
+    int error;
+} CsvReader;
+
+/* Initial read buffer size. */
+static size_t csv_read_buffer = CSV_READ_BUFFER;
+
+static int csv_reader_init(CsvReader *r, FILE *f, size_t cap) {
+    memset(r, 0, sizeof(*r));
+    r->f = f;
+    r->cap = cap ? cap : 1;
+    r->buf = (char *)malloc(r->cap);
+    return r->buf != NULL;
+}
+
+static void csv_reader_free(CsvReader *r) {
+    free(r->buf);
+    r->buf = NULL;
+}
+
+/* Look for record boundaries in the whole blocks that arrived since the
+ * last call; a partial tail block waits for more input. */
+static void csv_reader_scan(CsvReader *r) {
+    CsvBlockScanner scan = csv_block_scanner();
+    CsvBlockMasks m;
+    size_t i = r->scanned;
+    for (; i + CSV_BLOCK <= r->len; i += CSV_BLOCK) {
+        scan(r->buf + i, &m);
+        uint64_t newlines = m.newline & ~csv_block_quoted(&m, &r->state, CSV_BLOCK);
+        if (newlines) r->boundary = i + CSV_BLOCK - (size_t)__builtin_clzll(newlines);
+    }
+    r->scanned = i;
+}
+
+/* Buffer whole records and return how many bytes at the start of r->buf
+ * they cover (at end of input, everything left). 0 means the input is
+ * exhausted or an error occurred. */
+static size_t csv_reader_fill(CsvReader *r) {
+    for (;;) {
+        if (r->boundary > 0) return r->boundary;
+        if (r->eof || r->error) return r->error ? 0 : r->len;
+        if (r->len == r->cap) {
+            char *buf = (char *)realloc(r->buf, r->cap * 2);
+            if (!buf) {
+                r->error = 1;
+                continue;
+            }
+            r->buf = buf;
+            r->cap *= 2;
+        }
+        size_t got = fread(r->buf + r->len, 1, r->cap - r->len, r->f);
+        r->len += got;
+        if (got == 0) {
+            if (ferror(r->f)) r->error = 1;
+            r->eof = 1;
+        }
+        csv_reader_scan(r);
+    }
+}
+
+/* Drop the first `n` bytes handed out by csv_reader_fill(); `n` always
+ * ends on a record boundary, where the quote state is known to be clear. */
+static void csv_reader_consume(CsvReader *r, size_t n) {
+    memmove(r->buf, r->buf + n, r->len - n);
+    r->len -= n;
+    if (n < r->scanned) {
+        r->scanned -= n;
+    } else {
+        r->scanned = 0;
+        memset(&r->state, 0, sizeof(r->state));
+    }
+    r->boundary = 0;
+    csv_reader_scan(r);
+}
+
+/* Fallback for inputs that cannot be mapped (pipes, special files): each
+ * buffered run of whole records is copied into the table's arena and
+ * parsed there like a mapped file. */
+static int load_csv_stream(Table *t, FILE *f) {
+    CsvReader r;
+    if (!csv_reader_init(&r, f, csv_read_buffer)) {
+        printf("Out of memory.\n");
+        return 0;
+    }
+
+    size_t n = csv_reader_fill(&r);
+    if (n == 0) {
+        printf(r.error ? "Error reading CSV.\n" : "CSV file is empty.\n");
+        csv_reader_free(&r);
+        return 0;
+    }
+    size_t header = csv_read_header(t, r.buf, n);
+    if (header == 0) {
+        printf("Out of memory.\n");
+        csv_reader_free(&r);
+        return 0;
+    }
+    csv_reader_consume(&r, header);
+
+    while ((n = csv_reader_fill(&r)) > 0) {
+        Cell block = arena_cell(&t->strings, r.buf, n);
+        if (!block.ptr || !csv_parse_parallel(t, block.ptr, n)) {
+            printf("Out of memory; remaining lines are ignored.\n");
+            break;
+        }
+        csv_reader_consume(&r, n);
+    }
+    if (r.error) printf("Error reading CSV; the table may be incomplete.\n");
+    csv_reader_free(&r);
+    return 1;
+}
+
+/* Key constraints belong to the schema rather than to the data, so they
+ * carry over to the next file loaded, matched by column name. */
+typedef struct {
+    char *name;
+    KeyConstraint key;
+} KeyDecl;
+
+/* Take the table's key constraints, with their column names, before the
+ * table is freed; NULL when there are none (or no memory to keep them). */
+static KeyDecl *table_take_keys(Table *t, int *count) {
+    int n = 0;
+    for (int c = 0; c < t->col_count; c++) {
+        if (t->cols[c].key != KEY_NONE) n++;
+    }
+    *count = 0;
+    KeyDecl *keys = n > 0 ? (KeyDecl *)malloc((size_t)n * sizeof(KeyDecl)) : NULL;
+    if (!keys) return NULL;
+    for (int c = 0; c < t->col_count; c++) {
+        if (t->cols[c].key == KEY_NONE) continue;
+        keys[*count].name = t->col_names[c];
+        keys[*count].key = t->cols[c].key;
+        t->col_names[c] = NULL;
+        (*count)++;
+    }
+    return keys;
+}
+
+static void free_keys(KeyDecl *keys, int count) {
+    for (int i = 0; i < count; i++) free(keys[i].name);
+    free(keys);
+}
+
+/* Enforce the carried-over constraints on a freshly loaded table: rows
+ * that break one are skipped, keeping the first row of each key value. */
+static void table_restore_keys(Table *t, const KeyDecl *keys, int count) {
+    for (int i = 0; i < count; i++) {
+        int c = 0;
+        while (c < t->col_count && strcmp(t->col_names[c], keys[i].name) != 0) c++;
+        if (c == t->col_count) {
+            printf("%s (%s) dropped: no such column.\n", key_name(keys[i].key), keys[i].name);
+            continue;
+        }
+        int skipped = table_drop_key_violations(t, c, keys[i].key);
+        if (skipped < 0 || table_add_key(t, c, keys[i].key) != 1) {
+            printf("Out of memory; %s (%s) dropped.\n", key_name(keys[i].key), keys[i].name);
+        } else if (skipped > 0) {
+            printf("Skipped %d row(s) violating %s (%s).\n",
+                   skipped, key_name(keys[i].key), keys[i].name);
+        }
+    }
+}
+
+/* Regular files are mmap()ed and parsed in place, so loading costs little
+ * more than faulting the pages in; cells are copied out only on update. */
+static int load_csv(const char *filename, Table *t) {
+    if (!filename || !t) return 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening CSV");
+        return 0;
+    }
+
+    int key_count;
+    KeyDecl *keys = table_take_keys(t, &key_count);
+    free_table(t);
+    init_table(t);
+
+    int ok = 0;
+    int loaded = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, size, MADV_SEQUENTIAL);
+            t->map = (const char *)map;
+            t->map_len = size;
+            ok = load_csv_buffer(t, t->map, size);
+            loaded = 1;
+        }
+    }
+
+    if (!loaded) {
+        FILE *f = fdopen(fd, "r");
+        if (!f) {
+            perror("Error opening CSV");
+            close(fd);
+            free_keys(keys, key_count);
+            return 0;
+        }
+        ok = load_csv_stream(t, f);
+        fclose(f);
+    } else {
+        close(fd);
+    }
+
+    if (!ok) {
+        free_table(t);
+        free_keys(keys, key_count);
+        return 0;
+    }
+    table_infer_types_parallel(t);
+    table_restore_keys(t, keys, key_count);
+    free_keys(keys, key_count);
+    printf("Loaded %d rows with %d columns from '%s'.\n",
+           t->row_count, t->col_count, filename);
+    return 1;
+}
+
+static void show_summary(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    printf("\n=== CSV Summary ===\n");
+    printf("Rows:   %d\n", table_live_rows(t));
+    if (t->dead_count > 0) printf("Deleted: %d row(s) not compacted yet\n", t->dead_count);
+    printf("Cols:   %d\n", t->col_count);
+    printf("Header: ");
+    for (int i = 0; i < t->col_count; i++) {
+        printf("%s", t->col_names[i] ? t->col_names[i] : "(col)");
+        if (i + 1 < t->col_count) printf(", ");
+    }
+    printf("\nTypes:  ");
+    for (int i = 0; i < t->col_count; i++) {
+        printf("%s", column_type_name(t->cols[i].type));
+        if (i + 1 < t->col_count) printf(", ");
+    }
+    int indexed = 0;
+    for (int i = 0; i < t->col_count; i++) {
+        if (t->cols[i].index) {
+            printf("%s%s", indexed++ ? ", " : "\nIndex:  ", t->col_names[i]);
+        }
+        if (t->cols[i].range) {
+            printf("%s%s (ordered)", indexed++ ? ", " : "\nIndex:  ", t->col_names[i]);
+        }
+        if (t->cols[i].grams) {
+            printf("%s%s (trigram)", indexed++ ? ", " : "\nIndex:  ", t->col_names[i]);
+        }
+    }
+    int keyed = 0;
+    for (int i = 0; i < t->col_count; i++) {
+        if (t->cols[i].key != KEY_NONE) {
+            printf("%s%s (%s)", keyed++ ? ", " : "\nKeys:   ", t->col_names[i],
+                   key_name(t->cols[i].key));
+        }
+    }
+    printf("\n===================\n");
+}
+
+static void view_first_n(const Table *t, int n) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    int rows = table_live_rows(t);
+    if (n <= 0 || n > rows) n = rows;
+    printf("\n-- First %d row(s) --\n", n);
+    print_header(t);
+    for (int i = table_next_live(t, 0), shown = 0; shown < n; i = table_next_live(t, i + 1), shown++) {
+        print_row(t, i);
+    }
+}
+
+static void view_last_n(const Table *t, int n) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    int rows = table_live_rows(t);
+    if (n <= 0 || n > rows) n = rows;
+    int start = t->row_count;
+    for (int seen = 0; seen < n; start--) {
+        if (table_row_live(t, start - 1)) seen++;
+    }
+    printf("\n-- Last %d row(s) --\n", n);
+    print_header(t);
+    for (int i = table_next_live(t, start); i < t->row_count; i = table_next_live(t, i + 1)) {
+        print_row(t, i);
+    }
+}
+
+/* Whether `value` may go into row `row` (-1 for a new row) of column `c`
+ * under the column's key constraint; says why not when it may not. */
+static int key_allows(const Table *t, int c, int row, const char *value) {
+    KeyConstraint key = t->cols[c].key;
+    if (key == KEY_NONE) return 1;
+    size_t len = strlen(value);
+    if (key == KEY_PRIMARY && len == 0) {
+        printf("Column '%s' is the PRIMARY KEY and cannot be empty.\n", t->col_names[c]);
+        return 0;
+    }
+    int other = table_key_conflict(t, c, row, value, len);
+    if (other >= 0) {
+        printf("Value '%s' already exists in %s column '%s' (row %d).\n",
+               value, key_name(key), t->col_names[c], other);
+        return 0;
+    }
+    return 1;
+}
+
+static void insert_row(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char *values = (char *)malloc((size_t)t->col_count * MAX_FIELD_LEN);
+    if (!values) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Inserting new row:\n");
+    for (int i = 0; i < t->col_count; i++) {
+        printf("Enter value for column '%s': ", t->col_names[i]);
+        read_line_stdin(values + (size_t)i * MAX_FIELD_LEN, MAX_FIELD_LEN);
+    }
+    for (int i = 0; i < t->col_count; i++) {
+        if (!key_allows(t, i, -1, values + (size_t)i * MAX_FIELD_LEN)) {
+            printf("Row not inserted.\n");
+            free(values);
+            return;
+        }
+    }
+
+    int row = table_new_row(t);
+    if (row < 0) {
+        printf("Out of memory.\n");
+        free(values);
+        return;
+    }
+    for (int i = 0; i < t->col_count; i++) {
+        const char *v = values + (size_t)i * MAX_FIELD_LEN;
+        table_set_cell(t, row, i, arena_cell(&t->strings, v, strlen(v)));
+    }
+    free(values);
+    printf("Row inserted at index %d.\n", t->row_count - 1);
+}
+
+/* Rows of an indexed column whose cell equals `value`, in row order, in a
+ * malloc'd array; returns the count, or -1 when out of memory. */
+static int table_index_rows(const Table *t, int col, const char *value, size_t len, int **out) {
+    const HashIndex *ix = t->cols[col].index;
+    uint32_t hash = (uint32_t)hash_bytes(value, len);
+    size_t pos = hash & ix->mask;
+    int *rows = NULL;
+    int count = 0, cap = 0, row;
+    while ((row = index_next(ix, t->cols[col].cells, hash, value, len, &pos)) >= 0) {
+        if (count == cap) {
+            cap = cap ? cap * 2 : 16;
+            int *grown = (int *)realloc(rows, (size_t)cap * sizeof(int));
+            if (!grown) {
+                free(rows);
+                return -1;
+            }
+            rows = grown;
+        }
+        rows[count++] = row;
+    }
+    if (!sort_row_ids(rows, (size_t)count)) {
+        free(rows);
+        return -1;
+    }
+    *out = rows;
+    return count;
+}
+
+static int find_row_index_by_value(const Table *t, int col_index, const char *value) {
+    if (!t || col_index < 0 || col_index >= t->col_count || !value) return -1;
+    const Cell *cells = t->cols[col_index].cells;
+    size_t value_len = strlen(value);
+    const HashIndex *ix = t->cols[col_index].index;
+    if (ix) {
+        uint32_t hash = (uint32_t)hash_bytes(value, value_len);
+        size_t pos = hash & ix->mask;
+        int first = -1, row;
+        while ((row = index_next(ix, cells, hash, value, value_len, &pos)) >= 0) {
+            if (first < 0 || row < first) first = row;
+        }
+        return first;
+    }
+    for (int i = table_next_live(t, 0); i < t->row_count; i = table_next_live(t, i + 1)) {
+        if (cell_equals(cells[i], value, value_len)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Every live row whose cell in column `col` equals `value`, ascending, in
+ * a malloc'd selection vector: the index's matches, or one pass over the
+ * column. Returns the count, or -1 when out of memory. */
+static int table_select_equal(const Table *t, int col, const char *value, int **out) {
+    size_t len = strlen(value);
+    if (t->cols[col].index) return table_index_rows(t, col, value, len, out);
+    const Cell *cells = t->cols[col].cells;
+    int *rows = NULL;
+    int count = 0, cap = 0;
+    for (int i = table_next_live(t, 0); i < t->row_count; i = table_next_live(t, i + 1)) {
+        if (!cell_equals(cells[i], value, len)) continue;
+        if (count == cap) {
+            cap = cap ? cap * 2 : 16;
+            int *grown = (int *)realloc(rows, (size_t)cap * sizeof(int));
+            if (!grown) {
+                free(rows);
+                return -1;
+            }
+            rows = grown;
+        }
+        rows[count++] = i;
+    }
+    *out = rows;
+    return count;
+}
+
+/* Read "WHERE col = value" from stdin; returns the column, or -1 after
+ * saying why not. */
+static int read_where_equal(const Table *t, char *value, size_t size) {
+    char buf[64];
+    printf("Enter column index for condition (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return -1;
+    }
+    printf("Enter value to match: ");
+    read_line_stdin(value, size);
+    return col;
+}
+
+/* DELETE FROM t WHERE col = value: every matching row, compacted at most
+ * once. */
+static void delete_rows_where(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char value[MAX_FIELD_LEN];
+    int col = read_where_equal(t, value, sizeof(value));
+    if (col < 0) return;
+
+    int *rows = NULL;
+    int n = table_select_equal(t, col, value, &rows);
+    if (n < 0 || !table_delete_rows(t, rows, n)) {
+        printf("Out of memory.\n");
+        free(rows);
+        return;
+    }
+    free(rows);
+    printf("Deleted %d row(s) where col[%d] = '%s'.\n", n, col, value);
+}
+
+/* UPDATE t SET ... WHERE col = value: the new values are asked for once
+ * and written to every matching row. */
+static void update_rows_where(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char value[MAX_FIELD_LEN];
+    int col = read_where_equal(t, value, sizeof(value));
+    if (col < 0) return;
+
+    int *rows = NULL;
+    int n = table_select_equal(t, col, value, &rows);
+    if (n < 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    if (n == 0) {
+        printf("No row found where col[%d] = '%s'.\n", col, value);
+        free(rows);
+        return;
+    }
+    char *text = (char *)malloc((size_t)t->col_count * MAX_FIELD_LEN);
+    const char **values = (const char **)malloc((size_t)t->col_count * sizeof(char *));
+    if (!text || !values) {
+        printf("Out of memory.\n");
+        free(text);
+        free(values);
+        free(rows);
+        return;
+    }
+    printf("%d row(s) match. Enter new values (leave empty to keep current):\n", n);
+    for (int i = 0; i < t->col_count; i++) {
+        printf("Column '%s': ", t->col_names[i]);
+        read_line_stdin(text + (size_t)i * MAX_FIELD_LEN, MAX_FIELD_LEN);
+        values[i] = text[(size_t)i * MAX_FIELD_LEN] ? text + (size_t)i * MAX_FIELD_LEN : NULL;
+    }
+    int ok = 1;
+    for (int i = 0; i < t->col_count && ok; i++) {
+        if (!values[i] || t->cols[i].key == KEY_NONE) continue;
+        /* One value in several rows duplicates the key. */
+        if (n > 1) {
+            printf("Value '%s' would repeat in %d rows of %s column '%s'.\n", values[i], n,
+                   key_name(t->cols[i].key), t->col_names[i]);
+            ok = 0;
+        } else {
+            ok = key_allows(t, i, rows[0], values[i]);
+        }
+    }
+    if (!ok) {
+        printf("No rows updated.\n");
+    } else if (!table_update_rows(t, rows, n, values)) {
+        printf("Out of memory.\n");
+    } else {
+        printf("Updated %d row(s).\n", n);
+    }
+    free(text);
+    free(values);
+    free(rows);
+}
+
+static void delete_one_row(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index for condition (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    printf("Enter value to match: ");
+    char value[MAX_FIELD_LEN];
+    read_line_stdin(value, sizeof(value));
+
+    int idx = find_row_index_by_value(t, col, value);
+    if (idx < 0) {
+        printf("No row found where col[%d] = '%s'.\n", col, value);
+        return;
+    }
+
+    printf("Deleting row %d:\n", idx);
+    print_row(t, idx);
+
+    if (!table_delete_row(t, idx)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Row deleted.\n");
+}
+
+static void update_one_row(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index for condition (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    printf("Enter value to match: ");
+    char value[MAX_FIELD_LEN];
+    read_line_stdin(value, sizeof(value));
+
+    int idx = find_row_index_by_value(t, col, value);
+    if (idx < 0) {
+        printf("No row found where col[%d] = '%s'.\n", col, value);
+        return;
+    }
+
+    printf("Current row:\n");
+    print_row(t, idx);
+
+    char *values = (char *)malloc((size_t)t->col_count * sizeof(buf));
+    if (!values) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Enter new values (leave empty to keep current):\n");
+    for (int i = 0; i < t->col_count; i++) {
+        Cell cell = t->cols[i].cells[idx];
+        printf("Column '%s' [%.*s]: ", t->col_names[i], (int)cell.len,
+               cell.ptr ? cell.ptr : "");
+        read_line_stdin(values + (size_t)i * sizeof(buf), sizeof(buf));
+    }
+    for (int i = 0; i < t->col_count; i++) {
+        const char *v = values + (size_t)i * sizeof(buf);
+        if (v[0] != '\0' && !key_allows(t, i, idx, v)) {
+            printf("Row not updated.\n");
+            free(values);
+            return;
+        }
+    }
+    for (int i = 0; i < t->col_count; i++) {
+        const char *v = values + (size_t)i * sizeof(buf);
+        if (v[0] != '\0') {
+            table_release_cell(t, t->cols[i].cells[idx]);
+            table_set_cell(t, idx, i, arena_cell(&t->strings, v, strlen(v)));
+        }
+    }
+    free(values);
+    table_maybe_compact(t);
+
+    printf("Row updated:\n");
+    print_row(t, idx);
+}
+
+/* Purge the deleted rows now rather than at the next threshold; the rows
+ * that remain are renumbered. */
+static void compact_table(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    int dead = t->dead_count;
+    table_compact_rows(t);
+    printf("Purged %d deleted row(s); %d row(s) remain.\n", dead, t->row_count);
+}
+
+static void find_rows_by_value(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index to search (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    printf("Enter value to search: ");
+    char value[MAX_FIELD_LEN];
+    read_line_stdin(value, sizeof(value));
+
+    int found = 0;
+    const Cell *cells = t->cols[col].cells;
+    size_t value_len = strlen(value);
+    if (t->cols[col].index) {
+        int *rows;
+        int n = table_index_rows(t, col, value, value_len, &rows);
+        if (n < 0) {
+            printf("Out of memory.\n");
+            return;
+        }
+        print_header(t);
+        for (int i = 0; i < n; i++) {
+            print_row(t, rows[i]);
+        }
+        free(rows);
+        found = n > 0;
+    } else {
+        print_header(t);
+        for (int i = table_next_live(t, 0); i < t->row_count; i = table_next_live(t, i + 1)) {
+            if (cell_equals(cells[i], value, value_len)) {
+                print_row(t, i);
+                found = 1;
+            }
+        }
+    }
+    if (!found) {
+        printf("No rows found.\n");
+    }
+}
+
+static void create_index(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index to index (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    if (t->cols[col].index) {
+        printf("Column '%s' is already indexed.\n", t->col_names[col]);
+        return;
+    }
+    if (!table_create_index(t, col)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Created hash index on column '%s' (%d rows).\n", t->col_names[col], t->row_count);
+}
+
+static void create_range_index(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter numeric column index to index (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    if (t->cols[col].range) {
+        printf("Column '%s' already has an ordered index.\n", t->col_names[col]);
+        return;
+    }
+    if (!table_create_range_index(t, col)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Created ordered index on column '%s' (%zu numeric values).\n",
+           t->col_names[col], t->cols[col].range->count);
+}
+
+/* Keep the rows of a[0..n) that also appear in b[0..m); both ascending.
+ * A much longer b is galloped through instead of merged. */
+static size_t intersect_rows(int *a, size_t n, const int *b, size_t m) {
+    size_t kept = 0, j = 0;
+    if (m / 4 <= n) {
+        for (size_t i = 0; i < n && j < m; i++) {
+            while (j < m && b[j] < a[i]) j++;
+            if (j < m && b[j] == a[i]) a[kept++] = a[i];
+        }
+        return kept;
+    }
+    for (size_t i = 0; i < n && j < m; i++) {
+        size_t bound = 1;
+        while (j + bound < m && b[j + bound] < a[i]) bound *= 2;
+        size_t lo = j + bound / 2, hi = j + bound + 1 < m ? j + bound + 1 : m;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (b[mid] < a[i]) lo = mid + 1;
+            else hi = mid;
+        }
+        j = lo;
+        if (j < m && b[j] == a[i]) a[kept++] = a[i];
+    }
+    return kept;
+}
+
+static int compare_gram_lists(const void *a, const void *b) {
+    const GramSlot *x = *(const GramSlot *const *)a, *y = *(const GramSlot *const *)b;
+    if (x->count != y->count) return x->count < y->count ? -1 : 1;
+    return (x > y) - (x < y);
+}
+
+/* find_rows_by_substring() through the trigram index, for patterns of at
+ * least three bytes: intersect the posting lists of the pattern's
+ * trigrams, shortest first, verify the survivors, then test the logged
+ * rows directly. Returns -1 when out of memory. */
+static int trigram_lookup(const Table *t, int col, const char *pattern, size_t len,
+                          int out_indices[], int max_out) {
+    const TrigramIndex *ix = t->cols[col].grams;
+    const Cell *cells = t->cols[col].cells;
+    const RowLog *log = &ix->log;
+    size_t nl = len - 2;
+    const GramSlot **lists = (const GramSlot **)malloc(nl * sizeof(GramSlot *));
+    if (!lists) return -1;
+    int missing = 0;
+    for (size_t i = 0; i < nl && !missing; i++) {
+        lists[i] = gram_find(ix, gram_at(pattern + i));
+        missing = lists[i] == NULL;
+    }
+    if (!missing) qsort(lists, nl, sizeof(GramSlot *), compare_gram_lists);
+
+    size_t first = missing ? 0 : lists[0]->count;
+    int *rows = (int *)malloc((first + log->len + 1) * sizeof(int));
+    if (!rows) {
+        free(lists);
+        return -1;
+    }
+    size_t n = 0;
+    if (!missing) {
+        const int *list = ix->postings + lists[0]->start;
+        for (size_t k = 0; k < first; k++) {
+            if (log->len == 0 || !log->stale[list[k]]) rows[n++] = list[k];
+        }
+        /* Once few candidates are left, verifying them beats intersecting. */
+        for (size_t l = 1; l < nl && n > 32; l++) {
+            if (lists[l] == lists[l - 1]) continue;
+            n = intersect_rows(rows, n, ix->postings + lists[l]->start, lists[l]->count);
+        }
+        /* Sharing every trigram does not make the pattern a substring. */
+        size_t kept = 0;
+        for (size_t k = 0; k < n; k++) {
+            if (cell_contains(cells[rows[k]], pattern, len)) rows[kept++] = rows[k];
+        }
+        n = kept;
+    }
+    free(lists);
+
+    size_t indexed = n;
+    for (size_t i = 0; i < log->len; i++) {
+        if (cell_contains(cells[log->rows[i]], pattern, len)) rows[n++] = log->rows[i];
+    }
+    if (n > indexed && !sort_row_ids(rows, n)) {
+        free(rows);
+        return -1;
+    }
+    memcpy(out_indices, rows, (n < (size_t)max_out ? n : (size_t)max_out) * sizeof(int));
+    free(rows);
+    return (int)n;
+}
+
+static void create_trigram_index(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter text column index to index (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    if (t->cols[col].grams) {
+        printf("Column '%s' already has a trigram index.\n", t->col_names[col]);
+        return;
+    }
+    if (!table_create_trigram_index(t, col)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Created trigram index on column '%s' (%zu distinct trigrams).\n",
+           t->col_names[col], t->cols[col].grams->grams);
 }
 
 int find_rows_by_substring(const Table *t,
@@ -419,180 +3419,2491 @@ int find_rows_by_substring(const Table *t,
                            int max_out) {
     if (!t || !pattern || !out_indices || max_out <= 0) return 0;
     if (col < 0 || col >= t->col_count) return 0;
-    if (pattern[0] == '\0') return 0;
+    if (pattern[0] == '\0') return 0;
+
+    int count = 0;
+    const Cell *cells = t->cols[col].cells;
+    size_t pattern_len = strlen(pattern);
+
+    /* Patterns shorter than a trigram scan. */
+    if (t->cols[col].grams && pattern_len >= 3) {
+        count = trigram_lookup(t, col, pattern, pattern_len, out_indices, max_out);
+        if (count >= 0) return count;
+        count = 0;
+    }
+
+    for (int i = 0; i < t->row_count; i++) {
+        if (cell_contains(cells[i], pattern, pattern_len)) {
+            if (count < max_out) {
+                out_indices[count] = i;
+            }
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* find_rows_in_range() through the ordered index: binary search to the
+ * first value >= min_val, a contiguous scan up to max_val, then the logged
+ * rows; returns -1 when out of memory. */
+static int range_index_lookup(const Table *t, int col, double min_val, double max_val,
+                              int out_indices[], int max_out) {
+    const RangeIndex *ix = t->cols[col].range;
+    if (!(min_val <= max_val)) return 0;   /* a NaN bound matches nothing */
+    size_t lo = 0, hi = ix->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ix->entries[mid].value < min_val) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t end = lo;
+    while (end < ix->count && ix->entries[end].value <= max_val) end++;
+
+    const RowLog *log = &ix->log;
+    int *rows = (int *)malloc((end - lo + log->len + 1) * sizeof(int));
+    if (!rows) return -1;
+    size_t n = 0;
+    for (size_t i = lo; i < end; i++) {
+        if (log->len == 0 || !log->stale[ix->entries[i].row]) rows[n++] = ix->entries[i].row;
+    }
+    for (size_t i = 0; i < log->len; i++) {
+        double v;
+        if (table_cell_number(t, log->rows[i], col, &v) && v >= min_val && v <= max_val) {
+            rows[n++] = log->rows[i];
+        }
+    }
+    if (!sort_row_ids(rows, n)) {
+        free(rows);
+        return -1;
+    }
+    memcpy(out_indices, rows, (n < (size_t)max_out ? n : (size_t)max_out) * sizeof(int));
+    free(rows);
+    return (int)n;
+}
+
+int find_rows_in_range(const Table *t,
+                       int col,
+                       double min_val,
+                       double max_val,
+                       int out_indices[],
+                       int max_out) {
+    if (!t || !out_indices || max_out <= 0) return 0;
+    if (col < 0 || col >= t->col_count) return 0;
+
+    if (min_val > max_val) {
+        double tmp = min_val;
+        min_val = max_val;
+        max_val = tmp;
+    }
+
+    int count = 0;
+    const Column *c = &t->cols[col];
+    if (c->range) {
+        count = range_index_lookup(t, col, min_val, max_val, out_indices, max_out);
+        if (count >= 0) return count;
+        count = 0;
+    }
+
+    switch (c->type) {
+    case COL_INT64:
+        for (int i = 0; i < t->row_count; i++) {
+            double v = (double)c->ints[i];
+            if (c->valid[i] && v >= min_val && v <= max_val) {
+                if (count < max_out) out_indices[count] = i;
+                count++;
+            }
+        }
+        break;
+    case COL_DOUBLE:
+        for (int i = 0; i < t->row_count; i++) {
+            double v = c->nums[i];
+            if (c->valid[i] && v >= min_val && v <= max_val) {
+                if (count < max_out) out_indices[count] = i;
+                count++;
+            }
+        }
+        break;
+    default:
+        for (int i = 0; i < t->row_count; i++) {
+            double v;
+            if (!parse_cell_double(c->cells[i], &v)) {
+                continue;
+            }
+
+            if (v >= min_val && v <= max_val) {
+                if (count < max_out) {
+                    out_indices[count] = i;
+                }
+                count++;
+            }
+        }
+        break;
+    }
+
+    return count;
+}
+
+static void find_rows_like(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char buf[64];
+    printf("Enter column index for LIKE (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    char pattern[MAX_FIELD_LEN];
+    printf("Enter substring pattern: ");
+    read_line_stdin(pattern, sizeof(pattern));
+
+    if (pattern[0] == '\0') {
+        printf("Empty pattern; nothing to search.\n");
+        return;
+    }
+
+    if (t->row_count == 0) {
+        printf("No rows matched pattern '%s' in column %d.\n", pattern, col);
+        return;
+    }
+    int *indices = (int *)malloc((size_t)t->row_count * sizeof(int));
+    if (!indices) {
+        printf("Out of memory.\n");
+        return;
+    }
+    int count = find_rows_by_substring(t, col, pattern, indices, t->row_count);
+
+    if (count == 0) {
+        printf("No rows matched pattern '%s' in column %d.\n", pattern, col);
+        free(indices);
+        return;
+    }
+
+    printf("\nRows where col[%d] CONTAINS \"%s\":\n", col, pattern);
+    print_header(t);
+    for (int i = 0; i < count; i++) {
+        print_row(t, indices[i]);
+    }
+    free(indices);
+}
+
+static void find_rows_between(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char buf[64];
+    printf("Enter column index for BETWEEN (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    char min_str[64], max_str[64];
+    double min_val, max_val;
+
+    printf("Enter MIN value: ");
+    read_line_stdin(min_str, sizeof(min_str));
+    if (!parse_double(min_str, &min_val)) {
+        printf("Invalid MIN value.\n");
+        return;
+    }
+
+    printf("Enter MAX value: ");
+    read_line_stdin(max_str, sizeof(max_str));
+    if (!parse_double(max_str, &max_val)) {
+        printf("Invalid MAX value.\n");
+        return;
+    }
+
+    int *indices = NULL;
+    int count = 0;
+    if (t->row_count > 0) {
+        indices = (int *)malloc((size_t)t->row_count * sizeof(int));
+        if (!indices) {
+            printf("Out of memory.\n");
+            return;
+        }
+        count = find_rows_in_range(t, col, min_val, max_val, indices, t->row_count);
+    }
+
+    if (count == 0) {
+        if (min_val > max_val) {
+            double tmp = min_val;
+            min_val = max_val;
+            max_val = tmp;
+        }
+        printf("No rows found with col[%d] in [%.3f, %.3f].\n",
+               col, min_val, max_val);
+        free(indices);
+        return;
+    }
+
+    if (min_val > max_val) {
+        double tmp = min_val;
+        min_val = max_val;
+        max_val = tmp;
+    }
+
+    printf("\nRows where col[%d] is BETWEEN %.3f AND %.3f:\n",
+           col, min_val, max_val);
+    print_header(t);
+    for (int i = 0; i < count; i++) {
+        print_row(t, indices[i]);
+    }
+    free(indices);
+}
+
+/* COUNT, SUM, AVG, MIN and MAX of a column's numeric cells, and the count
+ * of its non-empty cells that are not numbers, from one pass over the
+ * column (column_stats()). NaN cells count and poison the sum, but MIN
+ * and MAX skip them; the first row holding the extreme wins ties. */
+typedef struct {
+    int count;          /* numeric cells */
+    int non_numeric;    /* non-empty cells that are not numbers */
+    double sum;
+    double min, max;
+    int min_row, max_row;   /* -1 when no value compares */
+} ColumnStats;
+
+/* Kernels over a typed column's values and validity bytes. Integers are
+ * summed exactly and rounded once; doubles are summed with Neumaier's
+ * compensation, so the error stays about one rounding of the result
+ * however long the column, where a plain loop drifts by one per row. */
+typedef struct {
+    void (*ints)(const int64_t *v, const uint8_t *valid, int n, ColumnStats *s);
+    void (*nums)(const double *v, const uint8_t *valid, int n, ColumnStats *s);
+    const char *name;
+} StatsKernels;
+
+static void neumaier_add(double *sum, double *comp, double x) {
+    double t = *sum + x;
+    if (fabs(*sum) >= fabs(x)) *comp += (*sum - t) + x;
+    else *comp += (x - t) + *sum;
+    *sum = t;
+}
+
+/* Once the sum is infinite or NaN it stays so, and the compensation is
+ * meaningless. */
+static double neumaier_result(double sum, double comp) {
+    return isfinite(sum) ? sum + comp : sum;
+}
+
+/* An int64 total kept as hi * 2^32 + lo, with lo summing low halves
+ * (below 2^63 for any int row count) and hi the signed high halves. */
+static double split_sum_value(int64_t hi, uint64_t lo) {
+    hi += (int64_t)(lo >> 32);
+    return (double)hi * 4294967296.0 + (double)(uint32_t)lo;
+}
+
+static void stats_ints_scalar(const int64_t *v, const uint8_t *valid, int n, ColumnStats *s) {
+    int64_t hi = 0;
+    uint64_t lo = 0;
+    int count = 0, lo_row = -1, hi_row = -1;
+    for (int i = 0; i < n; i++) {
+        if (!valid[i]) continue;
+        hi += v[i] >> 32;
+        lo += (uint32_t)v[i];
+        count++;
+        if (lo_row < 0 || v[i] < v[lo_row]) lo_row = i;
+        if (hi_row < 0 || v[i] > v[hi_row]) hi_row = i;
+    }
+    s->count = count;
+    s->sum = split_sum_value(hi, lo);
+    s->min_row = lo_row;
+    s->max_row = hi_row;
+    s->min = lo_row < 0 ? 0.0 : (double)v[lo_row];
+    s->max = hi_row < 0 ? 0.0 : (double)v[hi_row];
+}
+
+static void stats_nums_scalar(const double *v, const uint8_t *valid, int n, ColumnStats *s) {
+    double sum = 0.0, comp = 0.0;
+    int count = 0, lo_row = -1, hi_row = -1;
+    for (int i = 0; i < n; i++) {
+        if (!valid[i]) continue;
+        neumaier_add(&sum, &comp, v[i]);
+        count++;
+        if (isnan(v[i])) continue;
+        if (lo_row < 0 || v[i] < v[lo_row]) lo_row = i;
+        if (hi_row < 0 || v[i] > v[hi_row]) hi_row = i;
+    }
+    s->count = count;
+    s->sum = neumaier_result(sum, comp);
+    s->min_row = lo_row;
+    s->max_row = hi_row;
+    s->min = lo_row < 0 ? 0.0 : v[lo_row];
+    s->max = hi_row < 0 ? 0.0 : v[hi_row];
+}
+
+static const StatsKernels stats_kernels_scalar = { stats_ints_scalar, stats_nums_scalar, "scalar" };
+
+#ifdef CSV_HAVE_X86_SIMD
+/* Four rows per step. Each lane keeps its own count, sum, and best value
+ * and row for MIN and MAX, taking a row only when it beats the lane's
+ * best, so each lane holds its first extreme; the lanes are merged at
+ * the end, lowest row first among equals, and the tail rows after them. */
+__attribute__((target("avx2")))
+static inline __m256i stats_valid_mask4(const uint8_t *valid) {
+    int32_t w;
+    memcpy(&w, valid, sizeof(w));
+    return _mm256_cmpgt_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(w)), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static void stats_ints_avx2(const int64_t *v, const uint8_t *valid, int n, ColumnStats *s) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i low32 = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i lo = zero, hi = zero, neg = zero, count = zero;
+    __m256i vmin = zero, vmax = zero;
+    __m256i rmin = _mm256_set1_epi64x(-1), rmax = rmin;
+    __m256i row = _mm256_setr_epi64x(0, 1, 2, 3);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i m = stats_valid_mask4(valid + i);
+        __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+        __m256i xm = _mm256_and_si256(x, m);
+        lo = _mm256_add_epi64(lo, _mm256_and_si256(xm, low32));
+        hi = _mm256_add_epi64(hi, _mm256_srli_epi64(xm, 32));
+        neg = _mm256_sub_epi64(neg, _mm256_cmpgt_epi64(zero, xm));
+        count = _mm256_sub_epi64(count, m);
+        __m256i first = _mm256_cmpgt_epi64(zero, rmin);
+        __m256i take = _mm256_and_si256(m, _mm256_or_si256(first, _mm256_cmpgt_epi64(vmin, x)));
+        vmin = _mm256_blendv_epi8(vmin, x, take);
+        rmin = _mm256_blendv_epi8(rmin, row, take);
+        take = _mm256_and_si256(m, _mm256_or_si256(first, _mm256_cmpgt_epi64(x, vmax)));
+        vmax = _mm256_blendv_epi8(vmax, x, take);
+        rmax = _mm256_blendv_epi8(rmax, row, take);
+        row = _mm256_add_epi64(row, step);
+    }
+    int64_t l_lo[4], l_hi[4], l_neg[4], l_count[4], l_vmin[4], l_vmax[4], l_rmin[4], l_rmax[4];
+    _mm256_storeu_si256((__m256i *)l_lo, lo);
+    _mm256_storeu_si256((__m256i *)l_hi, hi);
+    _mm256_storeu_si256((__m256i *)l_neg, neg);
+    _mm256_storeu_si256((__m256i *)l_count, count);
+    _mm256_storeu_si256((__m256i *)l_vmin, vmin);
+    _mm256_storeu_si256((__m256i *)l_vmax, vmax);
+    _mm256_storeu_si256((__m256i *)l_rmin, rmin);
+    _mm256_storeu_si256((__m256i *)l_rmax, rmax);
+
+    /* The lanes summed high halves as unsigned: take 2^32 back per negative. */
+    int64_t sum_hi = 0;
+    uint64_t sum_lo = 0;
+    int total = 0, lo_row = -1, hi_row = -1;
+    for (int k = 0; k < 4; k++) {
+        sum_hi += l_hi[k] - (l_neg[k] << 32);
+        sum_lo += (uint64_t)l_lo[k];
+        total += (int)l_count[k];
+        int r = (int)l_rmin[k];
+        if (r >= 0 && (lo_row < 0 || l_vmin[k] < v[lo_row] || (l_vmin[k] == v[lo_row] && r < lo_row))) lo_row = r;
+        r = (int)l_rmax[k];
+        if (r >= 0 && (hi_row < 0 || l_vmax[k] > v[hi_row] || (l_vmax[k] == v[hi_row] && r < hi_row))) hi_row = r;
+    }
+    for (; i < n; i++) {
+        if (!valid[i]) continue;
+        sum_hi += v[i] >> 32;
+        sum_lo += (uint32_t)v[i];
+        total++;
+        if (lo_row < 0 || v[i] < v[lo_row]) lo_row = i;
+        if (hi_row < 0 || v[i] > v[hi_row]) hi_row = i;
+    }
+    s->count = total;
+    s->sum = split_sum_value(sum_hi, sum_lo);
+    s->min_row = lo_row;
+    s->max_row = hi_row;
+    s->min = lo_row < 0 ? 0.0 : (double)v[lo_row];
+    s->max = hi_row < 0 ? 0.0 : (double)v[hi_row];
+}
+
+__attribute__((target("avx2")))
+static void stats_nums_avx2(const double *v, const uint8_t *valid, int n, ColumnStats *s) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256d sum = _mm256_setzero_pd(), comp = sum;
+    __m256d vmin = sum, vmax = sum;
+    __m256i count = zero;
+    __m256i rmin = _mm256_set1_epi64x(-1), rmax = rmin;
+    __m256i row = _mm256_setr_epi64x(0, 1, 2, 3);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i mi = stats_valid_mask4(valid + i);
+        __m256d m = _mm256_castsi256_pd(mi);
+        __m256d x = _mm256_loadu_pd(v + i);
+        __m256d xm = _mm256_and_pd(x, m);
+        count = _mm256_sub_epi64(count, mi);
+
+        /* Neumaier, lane by lane: the smaller addend's lost bits go to comp. */
+        __m256d t = _mm256_add_pd(sum, xm);
+        __m256d sum_bigger = _mm256_cmp_pd(_mm256_andnot_pd(sign, sum), _mm256_andnot_pd(sign, xm), _CMP_GE_OQ);
+        __m256d big = _mm256_blendv_pd(xm, sum, sum_bigger);
+        __m256d small = _mm256_blendv_pd(sum, xm, sum_bigger);
+        comp = _mm256_add_pd(comp, _mm256_add_pd(_mm256_sub_pd(big, t), small));
+        sum = t;
+
+        /* NaN compares false everywhere, so it is never taken. */
+        __m256d ordered = _mm256_and_pd(m, _mm256_cmp_pd(x, x, _CMP_ORD_Q));
+        __m256d first = _mm256_castsi256_pd(_mm256_cmpgt_epi64(zero, rmin));
+        __m256d take = _mm256_and_pd(ordered, _mm256_or_pd(first, _mm256_cmp_pd(x, vmin, _CMP_LT_OQ)));
+        vmin = _mm256_blendv_pd(vmin, x, take);
+        rmin = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(rmin), _mm256_castsi256_pd(row), take));
+        take = _mm256_and_pd(ordered, _mm256_or_pd(first, _mm256_cmp_pd(x, vmax, _CMP_GT_OQ)));
+        vmax = _mm256_blendv_pd(vmax, x, take);
+        rmax = _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(rmax), _mm256_castsi256_pd(row), take));
+        row = _mm256_add_epi64(row, step);
+    }
+    double l_sum[4], l_comp[4], l_vmin[4], l_vmax[4];
+    int64_t l_count[4], l_rmin[4], l_rmax[4];
+    _mm256_storeu_pd(l_sum, sum);
+    _mm256_storeu_pd(l_comp, comp);
+    _mm256_storeu_pd(l_vmin, vmin);
+    _mm256_storeu_pd(l_vmax, vmax);
+    _mm256_storeu_si256((__m256i *)l_count, count);
+    _mm256_storeu_si256((__m256i *)l_rmin, rmin);
+    _mm256_storeu_si256((__m256i *)l_rmax, rmax);
+
+    double total_sum = 0.0, total_comp = 0.0;
+    int total = 0, lo_row = -1, hi_row = -1;
+    for (int k = 0; k < 4; k++) {
+        neumaier_add(&total_sum, &total_comp, l_sum[k]);
+        total_comp += l_comp[k];
+        total += (int)l_count[k];
+        int r = (int)l_rmin[k];
+        if (r >= 0 && (lo_row < 0 || l_vmin[k] < v[lo_row] || (l_vmin[k] == v[lo_row] && r < lo_row))) lo_row = r;
+        r = (int)l_rmax[k];
+        if (r >= 0 && (hi_row < 0 || l_vmax[k] > v[hi_row] || (l_vmax[k] == v[hi_row] && r < hi_row))) hi_row = r;
+    }
+    for (; i < n; i++) {
+        if (!valid[i]) continue;
+        neumaier_add(&total_sum, &total_comp, v[i]);
+        total++;
+        if (isnan(v[i])) continue;
+        if (lo_row < 0 || v[i] < v[lo_row]) lo_row = i;
+        if (hi_row < 0 || v[i] > v[hi_row]) hi_row = i;
+    }
+    s->count = total;
+    s->sum = neumaier_result(total_sum, total_comp);
+    s->min_row = lo_row;
+    s->max_row = hi_row;
+    s->min = lo_row < 0 ? 0.0 : v[lo_row];
+    s->max = hi_row < 0 ? 0.0 : v[hi_row];
+}
+
+static const StatsKernels stats_kernels_avx2 = { stats_ints_avx2, stats_nums_avx2, "avx2" };
+#endif
+
+static const StatsKernels *stats_kernels = NULL;
+
+static const StatsKernels *column_stats_kernels(void) {
+    if (!stats_kernels) {
+        const StatsKernels *k = &stats_kernels_scalar;
+#ifdef CSV_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) k = &stats_kernels_avx2;
+#endif
+        stats_kernels = k;
+    }
+    return stats_kernels;
+}
+
+/* All of ColumnStats for column `col`. Typed columns go through the
+ * kernels; text columns parse each cell once. */
+static void column_stats(const Table *t, int col, ColumnStats *s) {
+    const Column *c = &t->cols[col];
+    memset(s, 0, sizeof(*s));
+    s->min_row = s->max_row = -1;
+    if (c->type == COL_INT64) {
+        column_stats_kernels()->ints(c->ints, c->valid, t->row_count, s);
+        return;
+    }
+    if (c->type == COL_DOUBLE) {
+        column_stats_kernels()->nums(c->nums, c->valid, t->row_count, s);
+        return;
+    }
+    double sum = 0.0, comp = 0.0;
+    for (int i = 0; i < t->row_count; i++) {
+        double v;
+        if (!parse_cell_double(c->cells[i], &v)) {
+            if (c->cells[i].len > 0) s->non_numeric++;
+            continue;
+        }
+        neumaier_add(&sum, &comp, v);
+        s->count++;
+        if (isnan(v)) continue;
+        if (s->min_row < 0 || v < s->min) {
+            s->min_row = i;
+            s->min = v;
+        }
+        if (s->max_row < 0 || v > s->max) {
+            s->max_row = i;
+            s->max = v;
+        }
+    }
+    s->sum = neumaier_result(sum, comp);
+}
+
+static void max_by_column(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index for MAX (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    ColumnStats s;
+    column_stats(t, col, &s);
+
+    if (s.max_row == -1) {
+        printf("No numeric values in column %d.\n", col);
+    } else {
+        printf("Row with MAX col[%d]=%.3f:\n", col, s.max);
+        print_header(t);
+        print_row(t, s.max_row);
+    }
+}
+
+static void sum_avg_column(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char buf[64];
+    printf("Enter column index for SUM/AVG (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    ColumnStats s;
+    column_stats(t, col, &s);
+
+    if (s.count == 0) {
+        printf("No numeric values found in column %d.\n", col);
+        return;
+    }
+
+    double avg = s.sum / (double)s.count;
+
+    printf("\nSUM/AVG for column %d (%s):\n",
+           col, t->col_names[col] ? t->col_names[col] : "(col)");
+    printf("Numeric cells: %d\n", s.count);
+    printf("Sum: %.6f\n", s.sum);
+    printf("Avg: %.6f\n", avg);
+    if (s.non_numeric > 0) {
+        printf("Non-numeric (ignored) cells: %d\n", s.non_numeric);
+    }
+    printf("\n");
+}
+
+/* COUNT, SUM, AVG, MIN and MAX of a column at once, from one
+ * column_stats() pass. */
+static void column_stats_report(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char buf[64];
+    printf("Enter column index for stats (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    ColumnStats s;
+    column_stats(t, col, &s);
+
+    printf("\nStats for column %d (%s, %s):\n", col,
+           t->col_names[col] ? t->col_names[col] : "(col)",
+           t->cols[col].type == COL_STRING ? "text, parsed" :
+           t->cols[col].type == COL_INT64 ? "int64" : "double");
+    printf("Rows: %d\n", table_live_rows(t));
+    printf("Numeric cells (COUNT): %d\n", s.count);
+    printf("Non-numeric cells: %d\n", s.non_numeric);
+    printf("Empty cells: %d\n", table_live_rows(t) - s.count - s.non_numeric);
+    if (s.count == 0) {
+        printf("No numeric values found in column %d.\n\n", col);
+        return;
+    }
+    printf("SUM: %.6f\n", s.sum);
+    printf("AVG: %.6f\n", s.sum / (double)s.count);
+    if (s.min_row == -1) {
+        printf("MIN / MAX: none (every value is NaN)\n\n");
+        return;
+    }
+    printf("MIN: %.6f (row %d)\n", s.min, s.min_row);
+    printf("MAX: %.6f (row %d)\n", s.max, s.max_row);
+    printf("\n");
+}
+
+#define DUPLICATE_ROWS_SHOWN 20
+
+/* Print each value of column `col` that more than one row holds, with its
+ * rows. Returns the number of such values, or -1 when out of memory. */
+static int print_duplicates(const Table *t, int col) {
+    int *heads, *next;
+    int dups = column_duplicates(t, col, &heads, &next, NULL);
+    if (dups < 0) {
+        printf("Out of memory.\n");
+        return -1;
+    }
+    if (dups > 0) printf("Duplicates found:\n");
+    const Cell *cells = t->cols[col].cells;
+    for (int i = 0; i < dups; i++) {
+        Cell v = cells[heads[i]];
+        int rows = 0;
+        printf("  Value '%.*s' at rows", (int)v.len, v.ptr);
+        for (int r = heads[i]; r >= 0; r = next[r]) {
+            if (rows < DUPLICATE_ROWS_SHOWN) printf("%s %d", rows ? "," : "", r);
+            rows++;
+        }
+        if (rows > DUPLICATE_ROWS_SHOWN) printf(", ...");
+        printf(" (%d rows)\n", rows);
+    }
+    free(heads);
+    free(next);
+    return dups;
+}
+
+static void check_column_unique(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+
+    char buf[64];
+    printf("Enter column index to check for duplicates (0..%d): ",
+           t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    printf("\nChecking duplicates in column %d (%s):\n",
+           col, t->col_names[col] ? t->col_names[col] : "(col)");
+
+    int dups = print_duplicates(t, col);
+    if (dups == 0) {
+        printf("No duplicates; column %d can be a UNIQUE / PRIMARY KEY.\n", col);
+    } else if (dups > 0) {
+        printf("%d duplicated value(s).\n", dups);
+    }
+
+    printf("\n");
+}
+
+static void add_key_constraint(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index for the key (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    printf("Enter 1 for UNIQUE, 2 for PRIMARY KEY: ");
+    read_line_stdin(buf, sizeof(buf));
+    int choice = atoi(buf);
+    if (choice != 1 && choice != 2) {
+        printf("Invalid constraint.\n");
+        return;
+    }
+    KeyConstraint key = choice == 2 ? KEY_PRIMARY : KEY_UNIQUE;
+    if (t->cols[col].key >= key) {
+        printf("Column '%s' is already %s.\n", t->col_names[col], key_name(t->cols[col].key));
+        return;
+    }
+    for (int c = 0; key == KEY_PRIMARY && c < t->col_count; c++) {
+        if (t->cols[c].key == KEY_PRIMARY) {
+            printf("Table already has a PRIMARY KEY ('%s').\n", t->col_names[c]);
+            return;
+        }
+    }
+
+    int ok = table_add_key(t, col, key);
+    if (ok == 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    if (ok < 0) {
+        int empty = 0;
+        for (int r = table_next_live(t, 0); key == KEY_PRIMARY && r < t->row_count;
+             r = table_next_live(t, r + 1)) {
+            if (t->cols[col].cells[r].len == 0) empty++;
+        }
+        if (empty > 0) printf("Column '%s' has %d empty cell(s).\n", t->col_names[col], empty);
+        print_duplicates(t, col);
+        printf("%s not added.\n", key_name(key));
+        return;
+    }
+    printf("Added %s on column '%s'.\n", key_name(key), t->col_names[col]);
+}
+
+static void min_by_column(const Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[64];
+    printf("Enter column index for MIN (0..%d): ", t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    int col = atoi(buf);
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+
+    ColumnStats s;
+    column_stats(t, col, &s);
+
+    if (s.min_row == -1) {
+        printf("No numeric values in column %d.\n", col);
+    } else {
+        printf("Row with MIN col[%d]=%.3f:\n", col, s.min);
+        print_header(t);
+        print_row(t, s.min_row);
+    }
+}
+
+/* Sort order of a column's cells: empty and missing cells first, then
+ * numbers by value, then the remaining text in strcmp() order ("nan"
+ * counts as text). Unlike comparing numerically only when both cells
+ * parse, this is a total order, so every sort agrees on the result. */
+enum { SORT_EMPTY, SORT_NUMBER, SORT_TEXT };
+
+static int sort_class(const Table *t, int row, int c, double *num) {
+    if (t->cols[c].cells[row].len == 0) return SORT_EMPTY;
+    if (table_cell_number(t, row, c, num) && *num == *num) return SORT_NUMBER;
+    return SORT_TEXT;
+}
+
+#if defined(FUZZING) || defined(BENCHMARK)
+/* That order for two rows, cell by cell; the sorts themselves compare
+ * normalized keys, and the fuzzers and benchmarks check them against it. */
+static int compare_rows_by_col(const Table *t, int a, int b, int col, int asc) {
+    int col_ok = t && col >= 0 && col < t->col_count;
+    double va = 0.0, vb = 0.0;
+    int ka = col_ok && a >= 0 && a < t->row_count ? sort_class(t, a, col, &va) : SORT_EMPTY;
+    int kb = col_ok && b >= 0 && b < t->row_count ? sort_class(t, b, col, &vb) : SORT_EMPTY;
+
+    int cmp;
+    if (ka != kb) {
+        cmp = (ka > kb) - (ka < kb);
+    } else if (ka == SORT_TEXT) {
+        cmp = cell_compare(t->cols[col].cells[a], t->cols[col].cells[b]);
+    } else if (ka == SORT_EMPTY) {
+        cmp = 0;
+    } else if (t->cols[col].type == COL_INT64) {
+        const int64_t *ints = t->cols[col].ints;
+        cmp = (ints[a] > ints[b]) - (ints[a] < ints[b]);
+    } else {
+        cmp = (va > vb) - (va < vb);
+    }
+    return asc ? cmp : -cmp;
+}
+#endif
+
+/* Sorting. Rows are sorted as SortEntry records: a 64-bit key that
+ * orders like the row's sort key, and the row number. The records are
+ * sorted stably on the keys alone, by LSD radix sort (skipping bytes that
+ * are the same in every key) or, for short ranges, by merge sort; only
+ * the final permutation touches the columns. */
+typedef struct {
+    uint64_t key;
+    int row;
+    uint32_t len;       /* string keys: bytes from the key's start, capped at 9 */
+} SortEntry;
+
+#define SORT_RUN 16             /* rows insertion-sorted before merging */
+#define SORT_RADIX_MIN 1024     /* shorter ranges are merge sorted */
+
+static size_t sort_radix_min = SORT_RADIX_MIN;
+
+/* Eight bytes of a string from `skip` on, big-endian and zero-padded. */
+static uint64_t text_sort_key(Cell c, size_t skip) {
+    uint64_t v = 0;
+    size_t n = c.len - skip;
+    memcpy(&v, c.ptr + skip, n < 8 ? n : 8);
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static void merge_sort_entries(SortEntry *e, SortEntry *tmp, size_t n) {
+    for (size_t lo = 0; lo < n; lo += SORT_RUN) {
+        size_t hi = lo + SORT_RUN < n ? lo + SORT_RUN : n;
+        for (size_t i = lo + 1; i < hi; i++) {
+            SortEntry x = e[i];
+            size_t j = i;
+            while (j > lo && x.key < e[j - 1].key) {
+                e[j] = e[j - 1];
+                j--;
+            }
+            e[j] = x;
+        }
+    }
+    SortEntry *src = e, *dst = tmp;
+    for (size_t width = SORT_RUN; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = mid + width < n ? mid + width : n;
+            size_t i = lo, j = mid, k = lo;
+            if (mid < hi && src[mid].key >= src[mid - 1].key) {
+                /* Already in order: the runs just concatenate. */
+                memcpy(&dst[lo], &src[lo], (hi - lo) * sizeof(SortEntry));
+                continue;
+            }
+            while (i < mid && j < hi) {
+                dst[k++] = src[j].key < src[i].key ? src[j++] : src[i++];
+            }
+            while (i < mid) dst[k++] = src[i++];
+            while (j < hi) dst[k++] = src[j++];
+        }
+        SortEntry *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != e) memcpy(e, src, n * sizeof(SortEntry));
+}
+
+/* Stable sort of e[0 .. n) by key, using tmp[0 .. n) as scratch. */
+static void sort_entries(SortEntry *e, SortEntry *tmp, size_t n) {
+    if (n < sort_radix_min) {
+        merge_sort_entries(e, tmp, n);
+        return;
+    }
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = e[i].key;
+        for (int b = 0; b < 8; b++) counts[b][(key >> (8 * b)) & 0xFF]++;
+    }
+    SortEntry *src = e, *dst = tmp;
+    for (int b = 0; b < 8; b++) {
+        if (counts[b][(src[0].key >> (8 * b)) & 0xFF] == n) continue;
+        size_t pos = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t m = counts[b][d];
+            counts[b][d] = pos;
+            pos += m;
+        }
+        for (size_t i = 0; i < n; i++) {
+            dst[counts[b][(src[i].key >> (8 * b)) & 0xFF]++] = src[i];
+        }
+        SortEntry *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != e) memcpy(e, src, n * sizeof(SortEntry));
+}
+
+/* Stable sort of e[0 .. n) by strings[e[i].row], none of which is a
+ * proper prefix of another. Keys hold eight bytes of each string from
+ * `depth` on. With no string a prefix of another, records with equal
+ * keys either hold the same string or both go on past the key: such runs
+ * get their next eight bytes and are sorted again, using a stack of
+ * ranges rather than recursion. Returns 0 when out of memory. */
+static int sort_strings(SortEntry *e, SortEntry *tmp, size_t n, const Cell *strings, size_t depth) {
+    typedef struct {
+        size_t start, count, depth;
+    } SortRange;
+    size_t cap = 64, top = 0;
+    SortRange *stack = (SortRange *)malloc(cap * sizeof(SortRange));
+    if (!stack) return 0;
+    stack[top++] = (SortRange){ 0, n, depth };
+    while (top > 0) {
+        SortRange r = stack[--top];
+        SortEntry *run = e + r.start;
+        for (size_t i = 0; i < r.count; i++) {
+            Cell c = strings[run[i].row];
+            size_t len = c.len - r.depth;
+            run[i].key = text_sort_key(c, r.depth);
+            run[i].len = len > 8 ? 9 : (uint32_t)len;
+        }
+        sort_entries(run, tmp, r.count);
+        for (size_t i = 0, j; i < r.count; i = j) {
+            for (j = i + 1; j < r.count && run[j].key == run[i].key; j++) {}
+            if (j - i < 2 || run[i].len <= 8) continue;
+            if (top == cap) {
+                SortRange *grown = (SortRange *)realloc(stack, cap * 2 * sizeof(SortRange));
+                if (!grown) {
+                    free(stack);
+                    return 0;
+                }
+                stack = grown;
+                cap *= 2;
+            }
+            stack[top++] = (SortRange){ r.start + i, j - i, r.depth + 8 };
+        }
+    }
+    free(stack);
+    return 1;
+}
+
+/* ORDER BY. A column holding only numbers and nulls (INT64, or DOUBLE
+ * without NaN) has keys of one width, so when every key column is such
+ * the rows are LSD radix sorted on the keys directly: key columns from
+ * last to first, each by its 64-bit keys, then its nulls moved to the
+ * front, or the back for DESC. Every step is stable, which makes the
+ * whole sort stable.
+ *
+ * Otherwise each row's keys are encoded into one byte string that
+ * memcmp() orders like compare_rows_by_col() on each key column in turn:
+ * per key a class byte, then eight big-endian bytes for a number or, for
+ * text, the bytes with 0x00 escaped as 0x00 0xFF and ended by 0x00 0x00,
+ * so no key is a prefix of another. DESC keys have every byte inverted.
+ * The strings are sorted with sort_strings(), from past the prefix they
+ * all share. */
+typedef struct {
+    int col;
+    int asc;
+} SortKey;
+
+#define SORT_MAX_KEYS 16
+
+/* 1 when the column's keys are all fixed-width numbers or nulls. */
+static int sort_key_fixed(const Table *t, int c) {
+    const Column *col = &t->cols[c];
+    if (col->type == COL_INT64) return 1;
+    if (col->type != COL_DOUBLE) return 0;
+    for (int r = 0; r < t->row_count; r++) {
+        if (col->valid[r] && col->nums[r] != col->nums[r]) return 0;
+    }
+    return 1;
+}
+
+/* What an ORDER BY sorts by: the key columns, all fixed, or each row's
+ * encoded key string, which all share their first `depth` bytes. */
+typedef struct {
+    const Table *t;
+    const SortKey *keys;
+    int count;
+    const Cell *strings;    /* NULL on the radix path */
+    size_t depth;
+} SortContext;
+
+/* 64-bit key of a non-null number in a fixed key column. */
+static uint64_t fixed_sort_key(const Column *c, int r) {
+    if (c->type == COL_INT64) return (uint64_t)c->ints[r] ^ 0x8000000000000000ULL;
+    return range_key(c->nums[r]);
+}
+
+/* Negative, zero or positive as row `a` sorts before, with or after `b`. */
+static int sort_compare(const SortContext *s, int a, int b) {
+    if (s->strings) return cell_compare(s->strings[a], s->strings[b]);
+    for (int k = 0; k < s->count; k++) {
+        const Column *c = &s->t->cols[s->keys[k].col];
+        int asc = s->keys[k].asc;
+        if (c->valid[a] != c->valid[b]) return (c->valid[a] < c->valid[b]) == asc ? -1 : 1;
+        if (!c->valid[a]) continue;
+        uint64_t x = fixed_sort_key(c, a), y = fixed_sort_key(c, b);
+        if (x != y) return (x < y) == asc ? -1 : 1;
+    }
+    return 0;
+}
+
+/* Stable sort of rows[0 .. n) in ORDER BY order, with e and tmp (n
+ * records each) as scratch. Returns 0 when out of memory. */
+static int sort_rows(const SortContext *s, int *rows, size_t n, SortEntry *e, SortEntry *tmp) {
+    if (s->strings) {
+        for (size_t i = 0; i < n; i++) e[i].row = rows[i];
+        if (!sort_strings(e, tmp, n, s->strings, s->depth)) return 0;
+        for (size_t i = 0; i < n; i++) rows[i] = e[i].row;
+        return 1;
+    }
+    for (int k = s->count - 1; k >= 0; k--) {
+        const Column *c = &s->t->cols[s->keys[k].col];
+        uint64_t flip = s->keys[k].asc ? 0 : ~0ULL;
+        size_t nulls = 0;
+        for (size_t i = 0; i < n; i++) {
+            int r = rows[i];
+            if (c->valid[r]) {
+                e[i].key = fixed_sort_key(c, r) ^ flip;
+            } else {
+                e[i].key = flip;
+                nulls++;
+            }
+            e[i].row = r;
+            e[i].len = 0;
+        }
+        sort_entries(e, tmp, n);
+        size_t null_pos = s->keys[k].asc ? 0 : n - nulls;
+        size_t value_pos = s->keys[k].asc ? nulls : 0;
+        for (size_t i = 0; i < n; i++) {
+            int r = e[i].row;
+            rows[c->valid[r] ? value_pos++ : null_pos++] = r;
+        }
+    }
+    return 1;
+}
+
+/* Parallel sorting. With T threads the rows are split into T buckets by
+ * T - 1 splitters taken from a sorted sample: a row goes to the first
+ * bucket whose splitter does not sort before it, so rows with equal keys
+ * always share a bucket. Each thread classifies a range of rows, the
+ * rows are scattered bucket by bucket, each thread's range after the
+ * previous one's, and every bucket is then sorted on its own. Buckets
+ * hold rows in their original order and are sorted stably, so the order
+ * is the same for any number of threads. */
+#define SORT_PARALLEL_MIN_ROWS 65536
+#define SORT_SAMPLES 32         /* sampled rows per bucket */
+
+/* Rows each sorting thread gets at least; lowered by the fuzzers. */
+static int sort_parallel_min_rows = SORT_PARALLEL_MIN_ROWS;
+
+static int sort_thread_count(size_t rows) {
+    size_t min_rows = sort_parallel_min_rows > 0 ? (size_t)sort_parallel_min_rows : 1;
+    return worker_count(rows / min_rows);
+}
+
+typedef struct {
+    const SortContext *s;
+    const int *splitters;   /* buckets - 1 rows, sorted */
+    int buckets;
+    uint8_t *bucket;        /* per row */
+    int *order;
+    size_t begin, end;      /* rows to classify and scatter, or a bucket's slots */
+    size_t *offsets;        /* per bucket: this job's next slot */
+    SortEntry *e, *tmp;
+    int ok;
+} SortJob;
+
+static void *sort_classify_worker(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    memset(job->offsets, 0, (size_t)job->buckets * sizeof(size_t));
+    for (size_t r = job->begin; r < job->end; r++) {
+        int lo = 0, hi = job->buckets - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (sort_compare(job->s, job->splitters[mid], (int)r) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        job->bucket[r] = (uint8_t)lo;
+        job->offsets[lo]++;
+    }
+    return NULL;
+}
+
+static void *sort_scatter_worker(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    for (size_t r = job->begin; r < job->end; r++) {
+        job->order[job->offsets[job->bucket[r]]++] = (int)r;
+    }
+    return NULL;
+}
+
+static void *sort_bucket_worker(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    size_t n = job->end - job->begin;
+    job->ok = sort_rows(job->s, job->order + job->begin, n, job->e + job->begin, job->tmp + job->begin);
+    return NULL;
+}
+
+/* Sort all n rows into order[] on `threads` threads (at most 256, so a
+ * bucket number fits a byte). Returns 0 when out of memory. */
+static int parallel_sort_rows(const SortContext *s, int *order, size_t n, SortEntry *e,
+                              SortEntry *tmp, int threads) {
+    size_t samples = (size_t)threads * SORT_SAMPLES;
+    int *sample = (int *)malloc(samples * sizeof(int));
+    SortEntry *sample_e = (SortEntry *)malloc(2 * samples * sizeof(SortEntry));
+    uint8_t *bucket = (uint8_t *)malloc(n + 1);
+    size_t *offsets = (size_t *)malloc((size_t)threads * threads * sizeof(size_t));
+    int splitters[CSV_MAX_THREADS];
+    int ok = sample && sample_e && bucket && offsets;
+    if (ok) {
+        for (size_t i = 0; i < samples; i++) sample[i] = (int)((2 * i + 1) * n / (2 * samples));
+        ok = sort_rows(s, sample, samples, sample_e, sample_e + samples);
+    }
+    if (!ok) {
+        free(sample);
+        free(sample_e);
+        free(bucket);
+        free(offsets);
+        return 0;
+    }
+    for (int b = 0; b + 1 < threads; b++) splitters[b] = sample[(size_t)(b + 1) * SORT_SAMPLES];
+    free(sample);
+    free(sample_e);
+
+    SortJob jobs[CSV_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (SortJob){ s, splitters, threads, bucket, order,
+                             n * i / threads, n * (i + 1) / threads,
+                             offsets + (size_t)i * threads, e, tmp, 0 };
+    }
+    run_jobs(jobs, sizeof(SortJob), threads, sort_classify_worker);
+
+    /* Counts to slots: bucket by bucket, each job's rows after the
+     * previous job's. */
+    size_t pos = 0;
+    for (int b = 0; b < threads; b++) {
+        for (int i = 0; i < threads; i++) {
+            size_t m = jobs[i].offsets[b];
+            jobs[i].offsets[b] = pos;
+            pos += m;
+        }
+    }
+    run_jobs(jobs, sizeof(SortJob), threads, sort_scatter_worker);
+
+    for (int b = 0; b < threads; b++) {
+        jobs[b].begin = b > 0 ? jobs[b - 1].end : 0;
+        jobs[b].end = jobs[threads - 1].offsets[b];
+    }
+    run_jobs(jobs, sizeof(SortJob), threads, sort_bucket_worker);
+    free(bucket);
+    free(offsets);
+    for (int i = 0; i < threads; i++) ok = ok && jobs[i].ok;
+    return ok;
+}
+
+/* All rows in ORDER BY order, as a malloc'd array, or NULL when out of
+ * memory. */
+static int *sort_order(const SortContext *s) {
+    size_t n = (size_t)s->t->row_count;
+    SortEntry *e = (SortEntry *)malloc((n + 1) * sizeof(SortEntry));
+    SortEntry *tmp = (SortEntry *)malloc((n + 1) * sizeof(SortEntry));
+    int *order = (int *)malloc((n + 1) * sizeof(int));
+    int ok = e && tmp && order;
+    if (ok) {
+        int threads = sort_thread_count(n);
+        if (threads > 1) {
+            ok = parallel_sort_rows(s, order, n, e, tmp, threads);
+        } else {
+            for (size_t i = 0; i < n; i++) order[i] = (int)i;
+            ok = sort_rows(s, order, n, e, tmp);
+        }
+    }
+    free(e);
+    free(tmp);
+    if (!ok) {
+        free(order);
+        return NULL;
+    }
+    return order;
+}
+
+static int *radix_sort_order(const Table *t, const SortKey *keys, int count) {
+    SortContext s = { t, keys, count, NULL, 0 };
+    return sort_order(&s);
+}
+
+/* Append the byte-comparable form of row `r`'s key to `out`, which has
+ * room for 12 + 2 * the cell's length bytes; returns the bytes written. */
+static size_t sort_key_encode(const Table *t, int r, SortKey key, unsigned char *out) {
+    const Column *col = &t->cols[key.col];
+    unsigned char *p = out;
+    double v;
+    int cls = sort_class(t, r, key.col, &v);
+    *p++ = (unsigned char)cls;
+    if (cls == SORT_NUMBER) {
+        uint64_t bits = col->type == COL_INT64 ? (uint64_t)col->ints[r] ^ 0x8000000000000000ULL
+                                               : range_key(v);
+        for (int b = 7; b >= 0; b--) *p++ = (unsigned char)(bits >> (8 * b));
+    } else if (cls == SORT_TEXT) {
+        Cell cell = col->cells[r];
+        for (size_t i = 0; i < cell.len; i++) {
+            *p++ = (unsigned char)cell.ptr[i];
+            if (cell.ptr[i] == '\0') *p++ = 0xFF;
+        }
+        *p++ = 0;
+        *p++ = 0;
+    }
+    if (!key.asc) {
+        for (unsigned char *q = out; q < p; q++) *q = (unsigned char)~*q;
+    }
+    return (size_t)(p - out);
+}
+
+/* Key strings of the rows begin .. end, encoded into a buffer of the
+ * job's own. */
+typedef struct {
+    const Table *t;
+    const SortKey *keys;
+    int count;
+    size_t begin, end;
+    Cell *strings;
+    unsigned char *bytes;
+    size_t common;          /* bytes all of the job's strings share */
+    int ok;
+} SortEncodeJob;
+
+static void *sort_encode_worker(void *arg) {
+    SortEncodeJob *job = (SortEncodeJob *)arg;
+    size_t cap = (job->end - job->begin) * 16 + 64, used = 0;
+    job->bytes = (unsigned char *)malloc(cap);
+    job->ok = job->bytes != NULL;
+    for (size_t r = job->begin; r < job->end && job->ok; r++) {
+        size_t start = used;
+        for (int k = 0; k < job->count; k++) {
+            size_t need = used + 12 + 2 * job->t->cols[job->keys[k].col].cells[r].len;
+            if (need > cap) {
+                while (cap < need) cap *= 2;
+                unsigned char *grown = (unsigned char *)realloc(job->bytes, cap);
+                if (!grown) {
+                    job->ok = 0;
+                    break;
+                }
+                job->bytes = grown;
+            }
+            used += sort_key_encode(job->t, (int)r, job->keys[k], job->bytes + used);
+        }
+        job->strings[r].len = used - start;
+    }
+    if (!job->ok) return NULL;
+
+    /* The buffer has stopped moving: point the cells into it. */
+    used = 0;
+    job->common = job->begin < job->end ? job->strings[job->begin].len : 0;
+    for (size_t r = job->begin; r < job->end; r++) {
+        job->strings[r].ptr = (const char *)job->bytes + used;
+        used += job->strings[r].len;
+        const Cell *first = &job->strings[job->begin];
+        size_t i = 0;
+        while (i < job->common && i < job->strings[r].len && job->strings[r].ptr[i] == first->ptr[i]) i++;
+        job->common = i;
+    }
+    return NULL;
+}
+
+/* Every row's key strings, encoded by sort_key_encode() into one buffer
+ * per thread. */
+typedef struct {
+    Cell *strings;
+    size_t common;          /* bytes all the strings share */
+    unsigned char *bytes[CSV_MAX_THREADS];
+    int parts;
+} SortKeyStrings;
+
+static void sort_key_strings_free(SortKeyStrings *ks) {
+    for (int i = 0; i < ks->parts; i++) free(ks->bytes[i]);
+    free(ks->strings);
+    ks->strings = NULL;
+    ks->parts = 0;
+}
+
+/* Returns 0 when out of memory, leaving `ks` empty. */
+static int sort_key_strings(SortKeyStrings *ks, const Table *t, const SortKey *keys, int count) {
+    size_t n = (size_t)t->row_count;
+    ks->parts = 0;
+    ks->strings = (Cell *)malloc((n + 1) * sizeof(Cell));
+    if (!ks->strings) return 0;
+    int threads = sort_thread_count(n);
+    SortEncodeJob jobs[CSV_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (SortEncodeJob){ t, keys, count, n * i / threads, n * (i + 1) / threads,
+                                   ks->strings, NULL, 0, 0 };
+    }
+    run_jobs(jobs, sizeof(SortEncodeJob), threads, sort_encode_worker);
+
+    /* The prefix all strings share: each job's, cut to what its first
+     * string shares with the very first. */
+    int ok = 1;
+    size_t common = n > 0 ? ks->strings[0].len : 0;
+    for (int i = 0; i < threads; i++) {
+        ks->bytes[ks->parts++] = jobs[i].bytes;
+        ok = ok && jobs[i].ok;
+        if (!ok || jobs[i].begin == jobs[i].end) continue;
+        Cell first = ks->strings[jobs[i].begin];
+        size_t m = 0;
+        while (m < common && m < first.len && first.ptr[m] == ks->strings[0].ptr[m]) m++;
+        common = m < jobs[i].common ? m : jobs[i].common;
+    }
+    ks->common = common;
+    if (!ok) sort_key_strings_free(ks);
+    return ok;
+}
+
+static int *normalized_sort_order(const Table *t, const SortKey *keys, int count) {
+    SortKeyStrings ks;
+    if (!sort_key_strings(&ks, t, keys, count)) return NULL;
+    SortContext s = { t, keys, count, ks.strings, ks.common };
+    int *order = sort_order(&s);
+    sort_key_strings_free(&ks);
+    return order;
+}
+
+/* Row numbers in ORDER BY order: by keys[0], ties by keys[1], and so on,
+ * rows tied on every key in their current order. Returns a malloc'd
+ * array, or NULL when out of memory. */
+static int *table_sort_order(const Table *t, const SortKey *keys, int count) {
+    int fixed = 1;
+    for (int k = 0; k < count && fixed; k++) fixed = sort_key_fixed(t, keys[k].col);
+    if (fixed) return radix_sort_order(t, keys, count);
+    return normalized_sort_order(t, keys, count);
+}
+
+/* One thread's rows of a column being permuted: gathered into scratch,
+ * then, once every thread has gathered, copied back. */
+typedef struct {
+    Column *col;
+    const int *order;
+    size_t begin, end;
+    size_t n;
+    unsigned char *scratch; /* n cells, n values, n validity bytes */
+} PermuteJob;
+
+static void *permute_gather_worker(void *arg) {
+    PermuteJob *job = (PermuteJob *)arg;
+    const Column *col = job->col;
+    Cell *cells = (Cell *)job->scratch;
+    int64_t *ints = (int64_t *)(cells + job->n);
+    double *nums = (double *)(cells + job->n);
+    uint8_t *valid = (uint8_t *)(ints + job->n);
+    for (size_t i = job->begin; i < job->end; i++) cells[i] = col->cells[job->order[i]];
+    if (col->type == COL_STRING) return NULL;
+    for (size_t i = job->begin; i < job->end; i++) valid[i] = col->valid[job->order[i]];
+    if (col->type == COL_INT64) {
+        for (size_t i = job->begin; i < job->end; i++) ints[i] = col->ints[job->order[i]];
+    } else {
+        for (size_t i = job->begin; i < job->end; i++) nums[i] = col->nums[job->order[i]];
+    }
+    return NULL;
+}
+
+static void *permute_copy_worker(void *arg) {
+    PermuteJob *job = (PermuteJob *)arg;
+    Column *col = job->col;
+    size_t m = job->end - job->begin;
+    Cell *cells = (Cell *)job->scratch;
+    int64_t *ints = (int64_t *)(cells + job->n);
+    double *nums = (double *)(cells + job->n);
+    uint8_t *valid = (uint8_t *)(ints + job->n);
+    memcpy(col->cells + job->begin, cells + job->begin, m * sizeof(Cell));
+    if (col->type == COL_STRING) return NULL;
+    memcpy(col->valid + job->begin, valid + job->begin, m);
+    if (col->type == COL_INT64) memcpy(col->ints + job->begin, ints + job->begin, m * sizeof(int64_t));
+    else memcpy(col->nums + job->begin, nums + job->begin, m * sizeof(double));
+    return NULL;
+}
+
+/* Reorder the rows so that row i is the old row order[i]; tombstones move
+ * with them. Indexes are rebuilt. Returns 0 when out of memory, leaving
+ * the table unchanged. */
+static int table_permute_rows(Table *t, const int *order) {
+    size_t n = (size_t)t->row_count;
+    unsigned char *scratch = (unsigned char *)malloc(n * (sizeof(Cell) + sizeof(int64_t) + 1) + 1);
+    if (!scratch) return 0;
+    if (t->live) {
+        uint64_t *live = (uint64_t *)calloc(((size_t)t->row_cap + 63) / 64 + 1, sizeof(uint64_t));
+        if (!live) {
+            free(scratch);
+            return 0;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (table_row_live(t, order[i])) live[i >> 6] |= 1ULL << (i & 63);
+        }
+        free(t->live);
+        t->live = live;
+    }
+    int threads = sort_thread_count(n);
+    PermuteJob jobs[CSV_MAX_THREADS];
+    for (int c = 0; c < t->col_count; c++) {
+        for (int i = 0; i < threads; i++) {
+            jobs[i] = (PermuteJob){ &t->cols[c], order, n * i / threads, n * (i + 1) / threads,
+                                    n, scratch };
+        }
+        run_jobs(jobs, sizeof(PermuteJob), threads, permute_gather_worker);
+        run_jobs(jobs, sizeof(PermuteJob), threads, permute_copy_worker);
+    }
+    free(scratch);
+    table_rebuild_indexes(t);
+    return 1;
+}
+
+/* Sort the rows in ORDER BY order, compacting tombstones away first since
+ * every row moves anyway. Returns 0 when out of memory, leaving the table
+ * as it was. */
+static int table_sort(Table *t, const SortKey *keys, int count) {
+    table_compact_rows(t);
+    if (t->row_count <= 1) return 1;
+    int *order = table_sort_order(t, keys, count);
+    int ok = order && table_permute_rows(t, order);
+    free(order);
+    return ok;
+}
+
+static void sort_by_column(Table *t, int col, int asc) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    if (col < 0 || col >= t->col_count) {
+        printf("Invalid column index.\n");
+        return;
+    }
+    if (t->row_count <= 1) return;
 
-    int count = 0;
+    SortKey key = { col, asc };
+    if (!table_sort(t, &key, 1)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Sorted by column %d (%s).\n", col, asc ? "ASC" : "DESC");
+}
 
-    for (int i = 0; i < t->row_count; i++) {
-        const Row *r = &t->rows[i];
-        const char *cell = (col < r->cell_count && r->cells[col])
-                           ? r->cells[col] : "";
+/* Parse an ORDER BY list such as "2, 5, 3 DESC" into keys[0 .. max);
+ * returns the count, or -1 (after saying why) when it is not valid. */
+static int parse_order_by(const Table *t, const char *s, SortKey *keys, int max) {
+    int n = 0;
+    while (*s) {
+        while (*s == ' ' || *s == ',') s++;
+        if (!*s) break;
+        char *end;
+        long col = strtol(s, &end, 10);
+        if (end == s || col < 0 || col >= t->col_count) {
+            printf("Invalid column at '%s'.\n", s);
+            return -1;
+        }
+        if (n == max) {
+            printf("At most %d ORDER BY columns.\n", max);
+            return -1;
+        }
+        s = end;
+        while (*s == ' ') s++;
+        int asc = 1;
+        if (strncasecmp(s, "DESC", 4) == 0) {
+            asc = 0;
+            s += 4;
+        } else if (strncasecmp(s, "ASC", 3) == 0) {
+            s += 3;
+        }
+        while (*s == ' ') s++;
+        if (*s && *s != ',') {
+            printf("Invalid ORDER BY at '%s'.\n", s);
+            return -1;
+        }
+        keys[n].col = (int)col;
+        keys[n].asc = asc;
+        n++;
+    }
+    return n;
+}
 
-        if (strstr(cell, pattern) != NULL) {
-            if (count < max_out) {
-                out_indices[count] = i;
-            }
-            count++;
+static void order_by_columns(Table *t) {
+    if (!t || t->col_count == 0) {
+        printf("No table loaded.\n");
+        return;
+    }
+    char buf[256];
+    printf("Enter ORDER BY column indexes (0..%d), each optionally ASC or DESC, e.g. 2, 5, 3 DESC: ",
+           t->col_count - 1);
+    read_line_stdin(buf, sizeof(buf));
+    SortKey keys[SORT_MAX_KEYS];
+    int count = parse_order_by(t, buf, keys, SORT_MAX_KEYS);
+    if (count < 0) return;
+    if (count == 0) {
+        printf("No ORDER BY columns given.\n");
+        return;
+    }
+    if (!table_sort(t, keys, count)) {
+        printf("Out of memory.\n");
+        return;
+    }
+    printf("Sorted by");
+    for (int k = 0; k < count; k++) {
+        printf("%s column %d (%s)", k ? "," : "", keys[k].col, keys[k].asc ? "ASC" : "DESC");
+    }
+    printf(".\n");
+}
+
+/*
+ * Hash aggregation. Rows are grouped by the values of one or more key
+ * columns in an open-addressing table of (hash, group) slots, probed
+ * linearly and kept at most half full; because a slot carries its key's
+ * full hash, key cells are only compared on a probable match. Groups are
+ * numbered in order of first appearance and each keeps its first row.
+ * Group keys are copied into an arena of their own, so matching a row
+ * against its group reads densely packed keys rather than cells
+ * scattered over the table.
+ *
+ * Aggregates are computed over value columns in the same pass. Each group
+ * owns one flat run of doubles holding, for every value column, the
+ * count of numeric cells, their sum, minimum and maximum; COUNT, SUM,
+ * AVG, MIN and MAX are all read off that state, and a row updates it with
+ * the same four operations across all value columns.
+ *
+ * Large tables are aggregated in row ranges on several threads and the
+ * partial results merged in range order, which gives the same groups, in
+ * the same order, as a serial pass (sums may differ in the last bits).
+ */
+#define AGG_MAX_KEYS   8
+#define AGG_MAX_VALUES 16
+
+typedef enum {
+    AGG_COUNT,
+    AGG_SUM,
+    AGG_AVG,
+    AGG_MIN,
+    AGG_MAX
+} AggFunc;
+
+typedef struct {
+    uint32_t hash;
+    int group;          /* -1 marks an empty slot */
+} AggSlot;
+
+typedef struct {
+    const Table *t;
+    int key_cols[AGG_MAX_KEYS];
+    int key_count;
+    int value_cols[AGG_MAX_VALUES];
+    int value_count;
+    AggSlot *slots;
+    size_t mask;        /* slot count - 1; the count is a power of two */
+    int groups;
+    int cap;            /* room in the per-group arrays */
+    int *first;         /* per group: first row */
+    Cell *keys;         /* per group: key_count keys, in key_bytes */
+    uint32_t *hashes;   /* per group: key hash */
+    int *counts;        /* per group: rows */
+    double *states;     /* per group: count, sum, min, max runs of value_count */
+    Arena key_bytes;
+} Aggregate;
+
+#define AGG_PARALLEL_MIN_ROWS 65536
+
+/* Rows each aggregation thread gets at least; lowered by the fuzzers. */
+static int agg_parallel_min_rows = AGG_PARALLEL_MIN_ROWS;
+
+static int agg_init(Aggregate *a, const Table *t, const int *key_cols, int key_count,
+                    const int *value_cols, int value_count) {
+    memset(a, 0, sizeof(*a));
+    a->t = t;
+    memcpy(a->key_cols, key_cols, (size_t)key_count * sizeof(int));
+    a->key_count = key_count;
+    if (value_count > 0) memcpy(a->value_cols, value_cols, (size_t)value_count * sizeof(int));
+    a->value_count = value_count;
+    arena_init(&a->key_bytes);
+    a->slots = (AggSlot *)malloc(16 * sizeof(AggSlot));
+    if (!a->slots) return 0;
+    for (int i = 0; i < 16; i++) a->slots[i].group = -1;
+    a->mask = 15;
+    return 1;
+}
+
+static void agg_free(Aggregate *a) {
+    free(a->slots);
+    free(a->first);
+    free(a->keys);
+    free(a->hashes);
+    free(a->counts);
+    free(a->states);
+    arena_free(&a->key_bytes);
+    memset(a, 0, sizeof(*a));
+}
+
+/* Double the slots and re-place every group from its stored hash. */
+static int agg_grow_slots(Aggregate *a) {
+    size_t cap = (a->mask + 1) * 2;
+    AggSlot *slots = (AggSlot *)malloc(cap * sizeof(AggSlot));
+    if (!slots) return 0;
+    for (size_t i = 0; i < cap; i++) slots[i].group = -1;
+    for (int g = 0; g < a->groups; g++) {
+        size_t i = a->hashes[g] & (cap - 1);
+        while (slots[i].group >= 0) i = (i + 1) & (cap - 1);
+        slots[i].hash = a->hashes[g];
+        slots[i].group = g;
+    }
+    free(a->slots);
+    a->slots = slots;
+    a->mask = cap - 1;
+    return 1;
+}
+
+static int agg_grow_groups(Aggregate *a) {
+    int cap = a->cap ? a->cap * 2 : 64;
+    size_t width = 4 * (size_t)a->value_count;
+    int *first = (int *)realloc(a->first, (size_t)cap * sizeof(int));
+    if (first) a->first = first;
+    Cell *keys = (Cell *)realloc(a->keys, (size_t)cap * a->key_count * sizeof(Cell));
+    if (keys) a->keys = keys;
+    uint32_t *hashes = (uint32_t *)realloc(a->hashes, (size_t)cap * sizeof(uint32_t));
+    if (hashes) a->hashes = hashes;
+    int *counts = (int *)realloc(a->counts, (size_t)cap * sizeof(int));
+    if (counts) a->counts = counts;
+    double *states = width ? (double *)realloc(a->states, (size_t)cap * width * sizeof(double))
+                           : a->states;
+    if (states) a->states = states;
+    if (!first || !keys || !hashes || !counts || (width && !states)) return 0;
+    a->cap = cap;
+    return 1;
+}
+
+/* Hash of row `row`'s key; for a single key column, the cell's own hash. */
+static uint32_t agg_row_hash(const Aggregate *a, int row) {
+    uint32_t hash = 0;
+    for (int k = 0; k < a->key_count; k++) {
+        hash = hash * 0x9E3779B1u + index_hash(a->t->cols[a->key_cols[k]].cells[row]);
+    }
+    return hash;
+}
+
+static int agg_key_equals(const Aggregate *a, int g, int row) {
+    const Cell *key = &a->keys[(size_t)g * a->key_count];
+    for (int k = 0; k < a->key_count; k++) {
+        if (cell_compare(key[k], a->t->cols[a->key_cols[k]].cells[row]) != 0) return 0;
+    }
+    return 1;
+}
+
+/* The group of row `row`, whose key hashes to `hash`, created empty if
+ * the key is new; -1 when out of memory. */
+static int agg_group(Aggregate *a, uint32_t hash, int row) {
+    size_t i = hash & a->mask;
+    for (; a->slots[i].group >= 0; i = (i + 1) & a->mask) {
+        int g = a->slots[i].group;
+        if (a->slots[i].hash == hash && agg_key_equals(a, g, row)) return g;
+    }
+    if (a->groups == a->cap && !agg_grow_groups(a)) return -1;
+    if ((size_t)(a->groups + 1) * 2 > a->mask + 1) {
+        if (!agg_grow_slots(a)) return -1;
+        i = hash & a->mask;
+        while (a->slots[i].group >= 0) i = (i + 1) & a->mask;
+    }
+    int g = a->groups;
+    Cell *key = &a->keys[(size_t)g * a->key_count];
+    for (int k = 0; k < a->key_count; k++) {
+        Cell cell = a->t->cols[a->key_cols[k]].cells[row];
+        key[k] = arena_cell(&a->key_bytes, cell.ptr, cell.len);
+        if (cell.ptr && !key[k].ptr) return -1;
+    }
+    a->groups++;
+    a->slots[i].hash = hash;
+    a->slots[i].group = g;
+    a->first[g] = row;
+    a->hashes[g] = hash;
+    a->counts[g] = 0;
+    int n = a->value_count;
+    double *s = a->states + (size_t)g * 4 * n;
+    for (int v = 0; v < n; v++) {
+        s[v] = 0.0;
+        s[n + v] = 0.0;
+        s[2 * n + v] = INFINITY;
+        s[3 * n + v] = -INFINITY;
+    }
+    return g;
+}
+
+static int agg_rows(Aggregate *a, int begin, int end) {
+    int n = a->value_count;
+    double x[AGG_MAX_VALUES], ok[AGG_MAX_VALUES];
+    for (int r = table_next_live(a->t, begin); r < end; r = table_next_live(a->t, r + 1)) {
+        int g = agg_group(a, agg_row_hash(a, r), r);
+        if (g < 0) return 0;
+        a->counts[g]++;
+        if (n == 0) continue;
+        for (int v = 0; v < n; v++) {
+            ok[v] = table_cell_number(a->t, r, a->value_cols[v], &x[v]) && x[v] == x[v];
+            if (ok[v] == 0.0) x[v] = 0.0;
+        }
+        double *s = a->states + (size_t)g * 4 * n;
+        for (int v = 0; v < n; v++) {
+            double lo = ok[v] != 0.0 ? x[v] : INFINITY;
+            double hi = ok[v] != 0.0 ? x[v] : -INFINITY;
+            s[v] += ok[v];
+            s[n + v] += x[v];
+            s[2 * n + v] = lo < s[2 * n + v] ? lo : s[2 * n + v];
+            s[3 * n + v] = hi > s[3 * n + v] ? hi : s[3 * n + v];
         }
     }
+    return 1;
+}
 
-    return count;
+/* Fold `src`, aggregated over later rows than `dst`, into `dst`. */
+static int agg_merge(Aggregate *dst, const Aggregate *src) {
+    int n = src->value_count;
+    for (int g = 0; g < src->groups; g++) {
+        int d = agg_group(dst, src->hashes[g], src->first[g]);
+        if (d < 0) return 0;
+        dst->counts[d] += src->counts[g];
+        double *s = dst->states + (size_t)d * 4 * n;
+        const double *o = src->states + (size_t)g * 4 * n;
+        for (int v = 0; v < n; v++) {
+            s[v] += o[v];
+            s[n + v] += o[n + v];
+            s[2 * n + v] = o[2 * n + v] < s[2 * n + v] ? o[2 * n + v] : s[2 * n + v];
+            s[3 * n + v] = o[3 * n + v] > s[3 * n + v] ? o[3 * n + v] : s[3 * n + v];
+        }
+    }
+    return 1;
 }
 
-int find_rows_in_range(const Table *t,
-                       int col,
-                       double min_val,
-                       double max_val,
-                       int out_indices[],
-                       int max_out) {
-    if (!t || !out_indices || max_out <= 0) return 0;
-    if (col < 0 || col >= t->col_count) return 0;
+/* `func` over value column `v` of group `g`. Returns 0 when it is NULL:
+ * the group has no numeric cells there (COUNT is then 0, not NULL). */
+static int agg_result(const Aggregate *a, int g, int v, AggFunc func, double *out) {
+    int n = a->value_count;
+    const double *s = a->states + (size_t)g * 4 * n;
+    double count = s[v];
+    switch (func) {
+    case AGG_COUNT: *out = count; return 1;
+    case AGG_SUM:   *out = s[n + v]; break;
+    case AGG_AVG:   *out = count > 0 ? s[n + v] / count : 0.0; break;
+    case AGG_MIN:   *out = s[2 * n + v]; break;
+    default:        *out = s[3 * n + v]; break;
+    }
+    return count > 0;
+}
 
-    if (min_val > max_val) {
-        double tmp = min_val;
-        min_val = max_val;
-        max_val = tmp;
+typedef struct {
+    Aggregate agg;
+    int begin, end;
+    int ok;
+} AggJob;
+
+static void *agg_worker(void *arg) {
+    AggJob *job = (AggJob *)arg;
+    job->ok = agg_rows(&job->agg, job->begin, job->end);
+    return NULL;
+}
+
+/* Group the rows of `t` by the key columns into `a`, aggregating the value
+ * columns. Returns 0 when out of memory, leaving `a` empty. */
+static int table_aggregate(Aggregate *a, const Table *t, const int *key_cols, int key_count,
+                           const int *value_cols, int value_count) {
+    size_t min_rows = agg_parallel_min_rows > 0 ? (size_t)agg_parallel_min_rows : 1;
+    int n = worker_count((size_t)t->row_count / min_rows);
+    AggJob jobs[CSV_MAX_THREADS];
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        jobs[i].begin = (int)((int64_t)t->row_count * i / n);
+        jobs[i].end = (int)((int64_t)t->row_count * (i + 1) / n);
+        jobs[i].ok = 0;
+        if (!agg_init(&jobs[i].agg, t, key_cols, key_count, value_cols, value_count)) ok = 0;
+    }
+    if (ok) run_jobs(jobs, sizeof(AggJob), n, agg_worker);
+    for (int i = 0; i < n; i++) {
+        if (!jobs[i].ok || (i > 0 && ok && !agg_merge(&jobs[0].agg, &jobs[i].agg))) ok = 0;
+        if (i > 0) agg_free(&jobs[i].agg);
+    }
+    if (!ok) {
+        agg_free(&jobs[0].agg);
+        memset(a, 0, sizeof(*a));
+        return 0;
     }
+    *a = jobs[0].agg;
+    return 1;
+}
 
-    int count = 0;
+/* One key of a group, parsed once for sorting. A group's keys sit next to
+ * each other, the first one counting how many follow. */
+typedef struct {
+    Cell cell;
+    double num;
+    int64_t ival;
+    int cls;            /* SORT_EMPTY, SORT_NUMBER or SORT_TEXT */
+    int exact;          /* a number from an INT64 column: compare ival */
+    int more;           /* keys of the same group after this one */
+    int group;
+} GroupKey;
 
-    for (int i = 0; i < t->row_count; i++) {
-        const Row *r = &t->rows[i];
-        const char *cell = (col < r->cell_count && r->cells[col])
-                           ? r->cells[col] : "";
+/* compare_rows_by_col() on each key column in turn; ties go to the group
+ * seen first. */
+static int compare_group_keys(const void *pa, const void *pb) {
+    const GroupKey *a = *(const GroupKey *const *)pa, *b = *(const GroupKey *const *)pb;
+    int group_a = a->group, group_b = b->group;
+    for (;;) {
+        int cmp;
+        if (a->cls != b->cls) {
+            cmp = (a->cls > b->cls) - (a->cls < b->cls);
+        } else if (a->cls == SORT_TEXT) {
+            cmp = cell_compare(a->cell, b->cell);
+        } else if (a->cls == SORT_EMPTY) {
+            cmp = 0;
+        } else if (a->exact) {
+            cmp = (a->ival > b->ival) - (a->ival < b->ival);
+        } else {
+            cmp = (a->num > b->num) - (a->num < b->num);
+        }
+        if (cmp) return cmp;
+        if (a->more == 0) break;
+        a++;
+        b++;
+    }
+    return (group_a > group_b) - (group_a < group_b);
+}
 
-        double v;
-        if (!parse_double(cell, &v)) {
-            continue;
+/* Group numbers ordered by key, as Sort ASC orders the key columns (the
+ * first one, then the next on ties); groups whose keys compare equal stay
+ * in order of first appearance. Returns a malloc'd array, or NULL when
+ * out of memory. */
+static int *agg_sorted_groups(const Aggregate *a) {
+    size_t n = (size_t)a->groups;
+    int kc = a->key_count;
+    int *order = (int *)malloc((n + 1) * sizeof(int));
+    GroupKey *keys = (GroupKey *)malloc((n * kc + 1) * sizeof(GroupKey));
+    const GroupKey **sorted = (const GroupKey **)malloc((n + 1) * sizeof(GroupKey *));
+    if (!order || !keys || !sorted) {
+        free(order);
+        free(keys);
+        free(sorted);
+        return NULL;
+    }
+    for (size_t g = 0; g < n; g++) {
+        int row = a->first[g];
+        for (int k = 0; k < kc; k++) {
+            const Column *col = &a->t->cols[a->key_cols[k]];
+            GroupKey *key = &keys[g * kc + k];
+            key->cell = a->keys[g * kc + k];
+            key->more = kc - 1 - k;
+            key->group = (int)g;
+            key->cls = sort_class(a->t, row, a->key_cols[k], &key->num);
+            key->exact = key->cls == SORT_NUMBER && col->type == COL_INT64;
+            if (key->exact) key->ival = col->ints[row];
         }
+        sorted[g] = &keys[g * kc];
+    }
+    if (n > 1) qsort(sorted, n, sizeof(GroupKey *), compare_group_keys);
+    for (size_t i = 0; i < n; i++) order[i] = sorted[i]->group;
+    free(sorted);
+    free(keys);
+    return order;
+}
 
-        if (v >= min_val && v <= max_val) {
-            if (count < max_out) {
-                out_indices[count] = i;
+/* Parse a comma-separated list of column indexes into cols[0 .. max);
+ * returns the count, or -1 when an entry is not a valid column. */
+static int parse_column_list(const Table *t, const char *s, int *cols, int max) {
+    int n = 0;
+    while (*s) {
+        char *end;
+        long col = strtol(s, &end, 10);
+        if (end == s || col < 0 || col >= t->col_count || n == max) return -1;
+        cols[n++] = (int)col;
+        s = end;
+        while (*s == ' ') s++;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    return n;
+}
+
+typedef struct {
+    AggFunc func;
+    int value;          /* index into the aggregate's value columns */
+} AggOutput;
+
+static const char *const agg_func_names[] = { "COUNT", "SUM", "AVG", "MIN", "MAX" };
+
+/* Parse aggregates such as "SUM(3), avg(3), MAX(4)". Each distinct column
+ * becomes one value column of the aggregation. Returns the number of
+ * aggregates, or -1 (after saying why) when the list is malformed. */
+static int parse_aggregates(const Table *t, const char *s, AggOutput *out, int max,
+                            int *value_cols, int *value_count) {
+    int n = 0;
+    *value_count = 0;
+    while (*s) {
+        while (*s == ' ' || *s == ',') s++;
+        if (!*s) break;
+        int f = 0;
+        size_t len = 0;
+        while (isalpha((unsigned char)s[len])) len++;
+        while (f < 5 && !(strlen(agg_func_names[f]) == len &&
+                          strncasecmp(s, agg_func_names[f], len) == 0)) {
+            f++;
+        }
+        char *end;
+        long col = f < 5 && s[len] == '(' ? strtol(s + len + 1, &end, 10) : -1;
+        if (f == 5 || col < 0 || col >= t->col_count || end == s + len + 1 || *end != ')') {
+            printf("Invalid aggregate at '%s'.\n", s);
+            return -1;
+        }
+        if (n == max) {
+            printf("At most %d aggregates.\n", max);
+            return -1;
+        }
+        int v = 0;
+        while (v < *value_count && value_cols[v] != col) v++;
+        if (v == *value_count) {
+            if (v == AGG_MAX_VALUES) {
+                printf("At most %d aggregated columns.\n", AGG_MAX_VALUES);
+                return -1;
             }
-            count++;
+            value_cols[(*value_count)++] = (int)col;
         }
+        out[n].func = (AggFunc)f;
+        out[n].value = v;
+        n++;
+        s = end + 1;
     }
+    return n;
+}
 
-    return count;
+/* Read the order for GROUP BY / DISTINCT and aggregate; returns 0 (after
+ * saying why) when there is nothing to print. */
+static int aggregate_for_output(const Table *t, const int *key_cols, int key_count,
+                                const int *value_cols, int value_count,
+                                Aggregate *a, int **order) {
+    char buf[64];
+    printf("Order: 0 = first appearance, 1 = sorted by value: ");
+    read_line_stdin(buf, sizeof(buf));
+    int sorted = atoi(buf) == 1;
+    *order = NULL;
+    if (!table_aggregate(a, t, key_cols, key_count, value_cols, value_count)) {
+        printf("Out of memory.\n");
+        return 0;
+    }
+    if (sorted && !(*order = agg_sorted_groups(a))) {
+        printf("Out of memory.\n");
+        agg_free(a);
+        return 0;
+    }
+    return 1;
 }
 
-static void find_rows_like(const Table *t) {
+#define GROUP_BY_MAX_OUTPUTS 32
+
+static void group_by_column(const Table *t) {
     if (!t || t->col_count == 0) {
         printf("No table loaded.\n");
         return;
     }
-
-    char buf[64];
-    printf("Enter column index for LIKE (0..%d): ", t->col_count - 1);
+    char buf[256];
+    int key_cols[AGG_MAX_KEYS];
+    printf("Enter column index(es) to GROUP BY (0..%d, comma-separated): ", t->col_count - 1);
     read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
+    int key_count = parse_column_list(t, buf, key_cols, AGG_MAX_KEYS);
+    if (key_count <= 0) {
         printf("Invalid column index.\n");
         return;
     }
+    printf("Enter aggregates, e.g. SUM(3), AVG(3), MAX(4) (empty for COUNT only): ");
+    read_line_stdin(buf, sizeof(buf));
+    AggOutput outputs[GROUP_BY_MAX_OUTPUTS];
+    int value_cols[AGG_MAX_VALUES], value_count;
+    int output_count = parse_aggregates(t, buf, outputs, GROUP_BY_MAX_OUTPUTS,
+                                        value_cols, &value_count);
+    if (output_count < 0) return;
 
-    char pattern[MAX_FIELD_LEN];
-    printf("Enter substring pattern: ");
-    read_line_stdin(pattern, sizeof(pattern));
-
-    if (pattern[0] == '\0') {
-        printf("Empty pattern; nothing to search.\n");
+    Aggregate agg;
+    int *order;
+    if (!aggregate_for_output(t, key_cols, key_count, value_cols, value_count, &agg, &order)) {
         return;
     }
 
-    int indices[MAX_ROWS];
-    int count = find_rows_by_substring(t, col, pattern, indices, MAX_ROWS);
+    printf("\nGROUP BY");
+    for (int k = 0; k < key_count; k++) {
+        printf("%s col[%d] (%s)", k ? "," : "", key_cols[k],
+               t->col_names[key_cols[k]] ? t->col_names[key_cols[k]] : "(col)");
+    }
+    printf(":\n");
+    if (key_count == 1) {
+        printf("Value");
+    }
+    for (int k = 0; key_count > 1 && k < key_count; k++) {
+        printf("%s%s", k ? " | " : "", t->col_names[key_cols[k]]);
+    }
+    printf(" | Count");
+    for (int i = 0; i < output_count; i++) {
+        printf(" | %s(%s)", agg_func_names[outputs[i].func],
+               t->col_names[value_cols[outputs[i].value]]);
+    }
+    printf("\n--------------\n");
+    for (int i = 0; i < agg.groups; i++) {
+        int g = order ? order[i] : i;
+        for (int k = 0; k < key_count; k++) {
+            Cell value = agg.keys[(size_t)g * key_count + k];
+            printf("%s%.*s", k ? " | " : "", (int)value.len, value.ptr ? value.ptr : "");
+        }
+        printf(" | %d", agg.counts[g]);
+        for (int j = 0; j < output_count; j++) {
+            double v;
+            if (!agg_result(&agg, g, outputs[j].value, outputs[j].func, &v)) printf(" | NULL");
+            else if (outputs[j].func == AGG_COUNT) printf(" | %.0f", v);
+            else printf(" | %.6f", v);
+        }
+        printf("\n");
+    }
+    free(order);
+    agg_free(&agg);
+}
+
+/*
+ * APPROX_COUNT_DISTINCT: a HyperLogLog sketch of a column's cell texts.
+ *
+ * Each value's 64-bit hash picks one of 2^precision registers by its top
+ * bits, and the register keeps the largest count of leading zeros (plus
+ * one) seen in the remaining bits. Memory is the registers alone, however
+ * many rows or distinct values, and two sketches of the same precision
+ * merge by taking the larger register, so row ranges are sketched on
+ * separate threads and folded together. The estimate is Ertl's improved
+ * estimator ("New cardinality estimation algorithms for HyperLogLog
+ * sketches", 2017), which needs no bias tables or switch to linear
+ * counting; its relative standard error is about 1.04 / sqrt(2^precision).
+ */
+#define HLL_MIN_PRECISION 4
+#define HLL_MAX_PRECISION 18
+#define HLL_PRECISION     14
 
-    if (count == 0) {
-        printf("No rows matched pattern '%s' in column %d.\n", pattern, col);
-        return;
+typedef struct {
+    int precision;
+    uint8_t *registers;     /* 2^precision */
+} HyperLogLog;
+
+static int hll_init(HyperLogLog *h, int precision) {
+    h->precision = precision;
+    h->registers = (uint8_t *)calloc((size_t)1 << precision, 1);
+    return h->registers != NULL;
+}
+
+static void hll_free(HyperLogLog *h) {
+    free(h->registers);
+    h->registers = NULL;
+}
+
+static void hll_add_hash(HyperLogLog *h, uint64_t hash) {
+    int p = h->precision;
+    uint64_t rest = hash << p;
+    uint8_t rank = (uint8_t)(rest ? __builtin_clzll(rest) + 1 : 64 - p + 1);
+    uint8_t *reg = &h->registers[hash >> (64 - p)];
+    if (rank > *reg) *reg = rank;
+}
+
+static void hll_merge(HyperLogLog *dst, const HyperLogLog *src) {
+    size_t m = (size_t)1 << dst->precision;
+    for (size_t i = 0; i < m; i++) {
+        if (src->registers[i] > dst->registers[i]) dst->registers[i] = src->registers[i];
     }
+}
 
-    printf("\nRows where col[%d] CONTAINS \"%s\":\n", col, pattern);
-    print_header(t);
-    int to_print = (count < MAX_ROWS) ? count : MAX_ROWS;
-    for (int i = 0; i < to_print; i++) {
-        print_row(t, &t->rows[indices[i]]);
+/* Ertl's sigma(x) = x + sum over k >= 1 of x^(2^k) * 2^(k-1), for x < 1. */
+static double hll_sigma(double x) {
+    double y = 1.0, z = x, prev;
+    do {
+        x *= x;
+        prev = z;
+        z += x * y;
+        y += y;
+    } while (z != prev);
+    return z;
+}
+
+/* Square root of 0 <= x <= 1 by Newton's method from above, which keeps
+ * the program free of libm. */
+static double unit_sqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r = 1.0, next = 0.5 * (1.0 + x);
+    while (next < r) {
+        r = next;
+        next = 0.5 * (r + x / r);
     }
-    if (count > MAX_ROWS) {
-        printf("(Only first %d matches shown; total matches: %d)\n",
-               MAX_ROWS, count);
+    return r;
+}
+
+/* Ertl's tau(x) = (1 - x - sum over k >= 1 of (1 - x^(2^-k))^2 * 2^-k) / 3. */
+static double hll_tau(double x) {
+    if (x == 0.0 || x == 1.0) return 0.0;
+    double y = 1.0, z = 1.0 - x, prev;
+    do {
+        x = unit_sqrt(x);
+        prev = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != prev);
+    return z / 3.0;
+}
+
+static double hll_estimate(const HyperLogLog *h) {
+    int p = h->precision, q = 64 - p;
+    size_t m = (size_t)1 << p;
+    double counts[64 + 2] = { 0 };      /* registers holding each rank */
+    for (size_t i = 0; i < m; i++) counts[h->registers[i]] += 1.0;
+    if (counts[0] == (double)m) return 0.0;
+    double z = (double)m * hll_tau(1.0 - counts[q + 1] / (double)m);
+    for (int k = q; k >= 1; k--) z = 0.5 * (z + counts[k]);
+    z += (double)m * hll_sigma(counts[0] / (double)m);
+    return (double)m * (double)m / (2.0 * 0.69314718055994530942 * z);
+}
+
+/* Relative standard error of the estimate at `precision`: 1.04 / sqrt(2^precision). */
+static double hll_std_error(int precision) {
+    double err = 1.04 / (double)((size_t)1 << (precision / 2));
+    return precision % 2 ? err * 0.70710678118654752440 : err;
+}
+
+typedef struct {
+    const Table *t;
+    int col;
+    int begin, end;
+    HyperLogLog hll;
+} HllJob;
+
+static void *hll_worker(void *arg) {
+    HllJob *job = (HllJob *)arg;
+    const Table *t = job->t;
+    const Cell *cells = t->cols[job->col].cells;
+    for (int r = table_next_live(t, job->begin); r < job->end; r = table_next_live(t, r + 1)) {
+        hll_add_hash(&job->hll, hash_bytes(cells[r].ptr, cells[r].len));
     }
+    return NULL;
 }
 
-static void find_rows_between(const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* Sketch the live cells of column `col` into `h`, a new sketch of
+ * `precision`, on threads over row ranges as table_aggregate() splits
+ * them. Empty cells count as one value, as in DISTINCT. Returns 0 when
+ * out of memory. */
+static int table_approx_distinct(const Table *t, int col, int precision, HyperLogLog *h) {
+    size_t min_rows = agg_parallel_min_rows > 0 ? (size_t)agg_parallel_min_rows : 1;
+    int n = worker_count((size_t)t->row_count / min_rows);
+    HllJob jobs[CSV_MAX_THREADS];
+    int ok = 1;
+    for (int i = 0; i < n; i++) {
+        jobs[i].t = t;
+        jobs[i].col = col;
+        jobs[i].begin = (int)((int64_t)t->row_count * i / n);
+        jobs[i].end = (int)((int64_t)t->row_count * (i + 1) / n);
+        if (!hll_init(&jobs[i].hll, precision)) ok = 0;
+    }
+    if (ok) run_jobs(jobs, sizeof(HllJob), n, hll_worker);
+    for (int i = 1; i < n; i++) {
+        if (ok) hll_merge(&jobs[0].hll, &jobs[i].hll);
+        hll_free(&jobs[i].hll);
+    }
+    if (!ok) {
+        hll_free(&jobs[0].hll);
+        return 0;
     }
+    *h = jobs[0].hll;
+    return 1;
+}
 
-    char buf[64];
-    printf("Enter column index for BETWEEN (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+/* Quantiles of a numeric column, interpolated between the two nearest ranks:
+ * exact by selection over 64-bit keys, or approximate from a t-digest. */
+#define QUANTILE_MAX        32
+#define TDIGEST_COMPRESSION 100
+#define TDIGEST_BUFFER      4096
+
+#define SELECT_DEPTH        2
+
+/* Values a t-digest buffers between merges; lowered by the fuzzers. */
+static int tdigest_buffer = TDIGEST_BUFFER;
+/* Partitions per log2(n) before selection sorts instead; lowered by the
+ * fuzzers. */
+static int select_depth = SELECT_DEPTH;
+
+#define INT64_KEY_SIGN 0x8000000000000000ULL
+
+/* The double range_key() was made from. */
+static double range_key_value(uint64_t key) {
+    uint64_t bits = (key >> 63) ? key ^ INT64_KEY_SIGN : ~key;
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static int compare_keys(const void *pa, const void *pb) {
+    uint64_t a = *(const uint64_t *)pa, b = *(const uint64_t *)pb;
+    return (a > b) - (a < b);
+}
+
+static int compare_sizes(const void *pa, const void *pb) {
+    size_t a = *(const size_t *)pa, b = *(const size_t *)pb;
+    return (a > b) - (a < b);
+}
+
+static void swap_keys(uint64_t *a, size_t i, size_t j) {
+    uint64_t x = a[i];
+    a[i] = a[j];
+    a[j] = x;
+}
+
+/* Introselect: leave in a[k] what sorting a[lo .. hi) would put there, nothing
+ * larger before it and nothing smaller after it; lo <= k < hi. */
+static void select_key(uint64_t *a, size_t lo, size_t hi, size_t k) {
+    int budget = select_depth * (64 - __builtin_clzll((unsigned long long)(hi - lo) | 1));
+    while (hi - lo > 16) {
+        if (budget-- == 0) {
+            qsort(a + lo, hi - lo, sizeof(uint64_t), compare_keys);
+            return;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        if (a[mid] < a[lo]) swap_keys(a, lo, mid);
+        if (a[hi - 1] < a[lo]) swap_keys(a, lo, hi - 1);
+        if (a[hi - 1] < a[mid]) swap_keys(a, mid, hi - 1);
+        uint64_t pivot = a[mid];
+        /* a[lo] <= pivot <= a[hi - 1] bound both scans, and the split
+         * lands in [lo, hi - 2], so both sides shrink. */
+        size_t i = lo, j = hi - 1;
+        for (;;) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i >= j) break;
+            swap_keys(a, i, j);
+            i++;
+            j--;
+        }
+        if (k <= j) hi = j + 1;
+        else lo = j + 1;
+    }
+    for (size_t i = lo + 1; i < hi; i++) {
+        uint64_t x = a[i];
+        size_t j = i;
+        while (j > lo && x < a[j - 1]) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
     }
+}
 
-    char min_str[64], max_str[64];
-    double min_val, max_val;
+/* a + f * (b - a) kept within [a, b], infinite ends included; needs a <= b
+ * and 0 <= f <= 1. */
+static double quantile_lerp(double a, double b, double f) {
+    if (f == 0.0 || a == b) return a;
+    if (isinf(a) && isinf(b)) return f < 0.5 ? a : b;
+    if (isinf(a) || isinf(b)) return isinf(a) ? a : b;
+    double v = a + f * (b - a);
+    if (!isfinite(v)) v = a * (1.0 - f) + b * f;
+    return v < a ? a : v > b ? b : v;
+}
 
-    printf("Enter MIN value: ");
-    read_line_stdin(min_str, sizeof(min_str));
-    if (!parse_double(min_str, &min_val)) {
-        printf("Invalid MIN value.\n");
-        return;
+/* Exact quantiles qs[0 .. count) (each in [0, 1]) of column `col` into
+ * out[]. Returns the number of values, 0 when there are none, or -1 when
+ * out of memory. */
+static int column_quantiles(const Table *t, int col, const double *qs, int count, double *out) {
+    const Column *c = &t->cols[col];
+    uint64_t *keys = (uint64_t *)malloc(((size_t)t->row_count + 1) * sizeof(uint64_t));
+    if (!keys) return -1;
+    size_t n = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        double v;
+        if (c->type == COL_INT64) {
+            if (c->valid[r]) keys[n++] = (uint64_t)c->ints[r] ^ INT64_KEY_SIGN;
+        } else if (table_cell_number(t, r, col, &v) && v == v) {
+            keys[n++] = range_key(v);
+        }
+    }
+    if (n == 0) {
+        free(keys);
+        return 0;
     }
 
-    printf("Enter MAX value: ");
-    read_line_stdin(max_str, sizeof(max_str));
-    if (!parse_double(max_str, &max_val)) {
-        printf("Invalid MAX value.\n");
-        return;
+    /* The ranks to select: below and above each (n - 1) * q. */
+    size_t ranks[2 * QUANTILE_MAX];
+    int rank_count = 0;
+    for (int i = 0; i < count; i++) {
+        size_t r = (size_t)(qs[i] * (double)(n - 1));
+        ranks[rank_count++] = r;
+        if (r + 1 < n) ranks[rank_count++] = r + 1;
+    }
+    qsort(ranks, (size_t)rank_count, sizeof(size_t), compare_sizes);
+    size_t lo = 0;
+    for (int i = 0; i < rank_count; i++) {
+        if (ranks[i] < lo) continue;    /* selected already */
+        select_key(keys, lo, n, ranks[i]);
+        lo = ranks[i] + 1;
     }
 
-    int indices[MAX_ROWS];
-    int count = find_rows_in_range(t, col, min_val, max_val, indices, MAX_ROWS);
+    for (int i = 0; i < count; i++) {
+        double h = qs[i] * (double)(n - 1);
+        size_t r = (size_t)h;
+        double below, above;
+        if (c->type == COL_INT64) {
+            below = (double)(int64_t)(keys[r] ^ INT64_KEY_SIGN);
+            above = r + 1 < n ? (double)(int64_t)(keys[r + 1] ^ INT64_KEY_SIGN) : below;
+        } else {
+            below = range_key_value(keys[r]);
+            above = r + 1 < n ? range_key_value(keys[r + 1]) : below;
+        }
+        out[i] = quantile_lerp(below, above, h - (double)r);
+    }
+    free(keys);
+    return (int)n;
+}
 
-    if (count == 0) {
-        if (min_val > max_val) {
-            double tmp = min_val;
-            min_val = max_val;
-            max_val = tmp;
+typedef struct {
+    double mean;
+    double weight;
+} Centroid;
+
+typedef struct {
+    int compression;
+    Centroid *centroids;    /* sorted by mean */
+    Centroid *spare;        /* the next merge's output */
+    int count, cap;         /* centroids; cap is compression + 2 */
+    double total;           /* weight of the centroids */
+    SortEntry *buffer;      /* range_key() of values not merged yet */
+    SortEntry *scratch;
+    int buffered, buffer_cap;
+    double min, max;        /* of the finite values */
+    double neg_inf, pos_inf;    /* infinities, counted apart */
+} TDigest;
+
+static int tdigest_init(TDigest *td, int compression) {
+    memset(td, 0, sizeof(*td));
+    td->compression = compression;
+    td->cap = compression + 2;
+    td->buffer_cap = tdigest_buffer > 0 ? tdigest_buffer : 1;
+    td->centroids = (Centroid *)malloc((size_t)td->cap * sizeof(Centroid));
+    td->spare = (Centroid *)malloc((size_t)td->cap * sizeof(Centroid));
+    td->buffer = (SortEntry *)malloc((size_t)td->buffer_cap * sizeof(SortEntry));
+    td->scratch = (SortEntry *)malloc((size_t)td->buffer_cap * sizeof(SortEntry));
+    td->min = INFINITY;
+    td->max = -INFINITY;
+    return td->centroids && td->spare && td->buffer && td->scratch;
+}
+
+static void tdigest_free(TDigest *td) {
+    free(td->centroids);
+    free(td->spare);
+    free(td->buffer);
+    free(td->scratch);
+    memset(td, 0, sizeof(*td));
+}
+
+/* The t-digest scale function for compression d, at q in [0, 1]. */
+static double tdigest_k(double q, double d) {
+    if (q <= 0.5) return 0.5 * d * unit_sqrt(0.5 * q);
+    return 0.5 * d - 0.5 * d * unit_sqrt(0.5 * (1.0 - q));
+}
+
+/* Inverse of tdigest_k(), 1 past the top. */
+static double tdigest_q(double k, double d) {
+    if (k >= 0.5 * d) return 1.0;
+    double s = 2.0 * k / d;
+    if (k <= 0.25 * d) return 2.0 * s * s;
+    s = 1.0 - s;
+    return 1.0 - 2.0 * s * s;
+}
+
+/* Merge the buffered values into the centroids in one sweep over both,
+ * in order of value. */
+static void tdigest_flush(TDigest *td) {
+    if (td->buffered == 0) return;
+    sort_entries(td->buffer, td->scratch, (size_t)td->buffered);
+    double d = (double)td->compression;
+    double total = td->total + (double)td->buffered;
+    double before = 0.0;    /* weight of the centroids written */
+    double limit = tdigest_q(1.0, d) * total;
+    int out = 0, i = 0, j = 0;
+    Centroid cur = { 0.0, 0.0 };
+    while (i < td->count || j < td->buffered) {
+        Centroid next;
+        if (j == td->buffered ||
+            (i < td->count && td->centroids[i].mean <= range_key_value(td->buffer[j].key))) {
+            next = td->centroids[i++];
+        } else {
+            next.mean = range_key_value(td->buffer[j++].key);
+            next.weight = 1.0;
         }
-        printf("No rows found with col[%d] in [%.3f, %.3f].\n",
-               col, min_val, max_val);
+        if (cur.weight == 0.0) {
+            cur = next;
+        } else if (before + cur.weight + next.weight <= limit || out == td->cap - 1) {
+            cur.weight += next.weight;
+            cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+        } else {
+            td->spare[out++] = cur;
+            before += cur.weight;
+            limit = tdigest_q(tdigest_k(before / total, d) + 1.0, d) * total;
+            cur = next;
+        }
+    }
+    td->spare[out++] = cur;
+    Centroid *swap = td->centroids;
+    td->centroids = td->spare;
+    td->spare = swap;
+    td->count = out;
+    td->total = total;
+    td->buffered = 0;
+}
+
+static void tdigest_add(TDigest *td, double v) {
+    if (isinf(v)) {
+        if (v < 0) td->neg_inf += 1.0;
+        else td->pos_inf += 1.0;
         return;
     }
+    if (td->buffered == td->buffer_cap) tdigest_flush(td);
+    td->buffer[td->buffered++].key = range_key(v);
+    if (v < td->min) td->min = v;
+    if (v > td->max) td->max = v;
+}
 
-    if (min_val > max_val) {
-        double tmp = min_val;
-        min_val = max_val;
-        max_val = tmp;
+/* Quantile q (in [0, 1]) of the values added, interpolated between
+ * centroid centers; 0 when none were added. */
+static double tdigest_quantile(TDigest *td, double q) {
+    tdigest_flush(td);
+    double all = td->neg_inf + td->total + td->pos_inf;
+    if (all == 0.0) return 0.0;
+    double h = q * (all - 1.0);
+    if (td->neg_inf > 0.0 && (q <= 0.0 || h < td->neg_inf)) return -INFINITY;
+    if (td->pos_inf > 0.0 && (q >= 1.0 || h > td->neg_inf + td->total - 1.0)) return INFINITY;
+    if (q <= 0.0) return td->min;
+    if (q >= 1.0) return td->max;
+    h -= td->neg_inf;
+    double prev_at = 0.0, prev = td->min, before = 0.0;
+    double next_at = td->total - 1.0, next = td->max;
+    for (int i = 0; i < td->count; i++) {
+        const Centroid *c = &td->centroids[i];
+        double at = before + 0.5 * (c->weight - 1.0);
+        if (h < at) {
+            next_at = at;
+            next = c->mean;
+            break;
+        }
+        prev_at = at;
+        prev = c->mean;
+        before += c->weight;
     }
+    if (next_at <= prev_at) return prev;
+    return quantile_lerp(prev, next, (h - prev_at) / (next_at - prev_at));
+}
 
-    printf("\nRows where col[%d] is BETWEEN %.3f AND %.3f:\n",
-           col, min_val, max_val);
-    print_header(t);
-    int to_print = (count < MAX_ROWS) ? count : MAX_ROWS;
-    for (int i = 0; i < to_print; i++) {
-        print_row(t, &t->rows[indices[i]]);
+/* Quantiles qs[0 .. count) of column `col` from one pass into a t-digest
+ * of `compression`. Returns the number of values, 0 when there are none,
+ * or -1 when out of memory. */
+static int column_quantiles_approx(const Table *t, int col, int compression,
+                                   const double *qs, int count, double *out) {
+    TDigest td;
+    if (!tdigest_init(&td, compression)) {
+        tdigest_free(&td);
+        return -1;
     }
-    if (count > MAX_ROWS) {
-        printf("(Only first %d matches shown; total matches: %d)\n",
-               MAX_ROWS, count);
+    int n = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        double v;
+        if (table_cell_number(t, r, col, &v) && v == v) {
+            tdigest_add(&td, v);
+            n++;
+        }
     }
+    for (int i = 0; n > 0 && i < count; i++) out[i] = tdigest_quantile(&td, qs[i]);
+    tdigest_free(&td);
+    return n;
 }
 
-static void max_by_column(const Table *t) {
+static void show_distinct_values(const Table *t) {
     if (!t || t->col_count == 0) {
         printf("No table loaded.\n");
         return;
     }
     char buf[64];
-    printf("Enter column index for MAX (0..%d): ", t->col_count - 1);
+    printf("Enter column index for DISTINCT (0..%d): ", t->col_count - 1);
     read_line_stdin(buf, sizeof(buf));
     int col = atoi(buf);
     if (col < 0 || col >= t->col_count) {
@@ -600,340 +5911,572 @@ static void max_by_column(const Table *t) {
         return;
     }
 
-    int best_idx = -1;
-    double best_val = 0.0;
+    Aggregate agg;
+    int *order;
+    if (!aggregate_for_output(t, &col, 1, NULL, 0, &agg, &order)) return;
 
-    for (int i = 0; i < t->row_count; i++) {
-        const char *cell = (col < t->rows[i].cell_count && t->rows[i].cells[col])
-                           ? t->rows[i].cells[col] : "";
-        double v;
-        if (!parse_double(cell, &v)) continue;
-        if (best_idx == -1 || v > best_val) {
-            best_idx = i;
-            best_val = v;
-        }
-    }
-
-    if (best_idx == -1) {
-        printf("No numeric values in column %d.\n", col);
-    } else {
-        printf("Row with MAX col[%d]=%.3f:\n", col, best_val);
-        print_header(t);
-        print_row(t, &t->rows[best_idx]);
+    printf("\nDISTINCT values of column %d (%s):\n",
+           col, t->col_names[col] ? t->col_names[col] : "(col)");
+    for (int i = 0; i < agg.groups; i++) {
+        Cell value = agg.keys[order ? order[i] : i];
+        printf("%.*s\n", (int)value.len, value.ptr ? value.ptr : "");
     }
+    printf("Total distinct values: %d\n", agg.groups);
+    free(order);
+    agg_free(&agg);
 }
 
-static void sum_avg_column(const Table *t) {
+static void approx_count_distinct(const Table *t) {
     if (!t || t->col_count == 0) {
         printf("No table loaded.\n");
         return;
     }
-
     char buf[64];
-    printf("Enter column index for SUM/AVG (0..%d): ", t->col_count - 1);
+    printf("Enter column index for APPROX_COUNT_DISTINCT (0..%d): ", t->col_count - 1);
     read_line_stdin(buf, sizeof(buf));
     int col = atoi(buf);
     if (col < 0 || col >= t->col_count) {
         printf("Invalid column index.\n");
         return;
     }
-
-    double sum = 0.0;
-    int count = 0;
-    int non_numeric = 0;
-
-    for (int i = 0; i < t->row_count; i++) {
-        const Row *r = &t->rows[i];
-        const char *cell = (col < r->cell_count && r->cells[col])
-                           ? r->cells[col] : "";
-
-        double v;
-        if (parse_double(cell, &v)) {
-            sum += v;
-            count++;
-        } else {
-            if (cell[0] != '\0') {
-                non_numeric++;
-            }
-        }
+    printf("Precision (%d..%d, empty for %d): ", HLL_MIN_PRECISION, HLL_MAX_PRECISION, HLL_PRECISION);
+    read_line_stdin(buf, sizeof(buf));
+    int precision = buf[0] ? atoi(buf) : HLL_PRECISION;
+    if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+        printf("Invalid precision.\n");
+        return;
     }
 
-    if (count == 0) {
-        printf("No numeric values found in column %d.\n", col);
+    HyperLogLog h;
+    if (!table_approx_distinct(t, col, precision, &h)) {
+        printf("Out of memory.\n");
         return;
     }
+    double estimate = hll_estimate(&h);
+    double err = hll_std_error(precision);
+    hll_free(&h);
 
-    double avg = sum / (double)count;
+    printf("\nAPPROX_COUNT_DISTINCT of column %d (%s): %.0f\n",
+           col, t->col_names[col] ? t->col_names[col] : "(col)", estimate);
+    printf("Error bound: +-%.2f%% standard error, +-%.2f%% at 95%% confidence (+-%.0f values)\n",
+           100.0 * err, 200.0 * err, 2.0 * err * estimate);
+    printf("Sketch: precision %d, %zu registers (%zu bytes)\n\n",
+           precision, (size_t)1 << precision, (size_t)1 << precision);
+}
 
-    printf("\nSUM/AVG for column %d (%s):\n",
-           col, t->col_names[col] ? t->col_names[col] : "(col)");
-    printf("Numeric cells: %d\n", count);
-    printf("Sum: %.6f\n", sum);
-    printf("Avg: %.6f\n", avg);
-    if (non_numeric > 0) {
-        printf("Non-numeric (ignored) cells: %d\n", non_numeric);
+/* Parse percentiles such as "50, 95, 99.9" into fractions qs[0 .. max);
+ * returns the count, or -1 when one is not a number from 0 to 100. */
+static int parse_percentiles(const char *s, double *qs, int max) {
+    int n = 0;
+    while (*s) {
+        while (*s == ' ' || *s == ',') s++;
+        if (!*s) break;
+        const char *start = s;
+        while (*s && *s != ',' && *s != ' ') s++;
+        double p;
+        if (n == max || !parse_number(start, (size_t)(s - start), &p) || !(p >= 0.0 && p <= 100.0)) {
+            return -1;
+        }
+        qs[n++] = p / 100.0;
     }
-    printf("\n");
+    return n;
 }
 
-static void check_column_unique(const Table *t) {
+static void percentiles_column(const Table *t) {
     if (!t || t->col_count == 0) {
         printf("No table loaded.\n");
         return;
     }
-
-    char buf[64];
-    printf("Enter column index to check for duplicates (0..%d): ",
-           t->col_count - 1);
+    char buf[256];
+    printf("Enter column index for PERCENTILES (0..%d): ", t->col_count - 1);
     read_line_stdin(buf, sizeof(buf));
     int col = atoi(buf);
     if (col < 0 || col >= t->col_count) {
         printf("Invalid column index.\n");
         return;
     }
+    printf("Percentiles, comma-separated (empty for 50, 95, 99): ");
+    read_line_stdin(buf, sizeof(buf));
+    double qs[QUANTILE_MAX] = { 0.50, 0.95, 0.99 };
+    int count = buf[0] ? parse_percentiles(buf, qs, QUANTILE_MAX) : 3;
+    if (count <= 0) {
+        printf("Invalid percentiles (0 to 100, at most %d).\n", QUANTILE_MAX);
+        return;
+    }
+    printf("Mode: 0 = exact, 1 = approximate (t-digest, %d centroids at most): ",
+           TDIGEST_COMPRESSION + 1);
+    read_line_stdin(buf, sizeof(buf));
+    int approx = atoi(buf) == 1;
 
-    int has_duplicates = 0;
-
-    printf("\nChecking duplicates in column %d (%s):\n",
-           col, t->col_names[col] ? t->col_names[col] : "(col)");
-
-    for (int i = 0; i < t->row_count; i++) {
-        const Row *ri = &t->rows[i];
-        const char *vi = (col < ri->cell_count && ri->cells[col])
-                         ? ri->cells[col] : "";
-
-        if (vi[0] == '\0') {
-            continue;
-        }
-
-        for (int j = i + 1; j < t->row_count; j++) {
-            const Row *rj = &t->rows[j];
-            const char *vj = (col < rj->cell_count && rj->cells[col])
-                             ? rj->cells[col] : "";
+    double values[QUANTILE_MAX];
+    int n = approx ? column_quantiles_approx(t, col, TDIGEST_COMPRESSION, qs, count, values)
+                   : column_quantiles(t, col, qs, count, values);
+    if (n < 0) {
+        printf("Out of memory.\n");
+        return;
+    }
+    if (n == 0) {
+        printf("No numeric values found in column %d.\n", col);
+        return;
+    }
+    printf("\n%s percentiles of column %d (%s), %d values:\n", approx ? "Approximate" : "Exact",
+           col, t->col_names[col] ? t->col_names[col] : "(col)", n);
+    for (int i = 0; i < count; i++) {
+        printf("p%g: %.6f\n", qs[i] * 100.0, values[i]);
+    }
+    printf("\n");
+}
 
-            if (strcmp(vi, vj) == 0) {
-                if (!has_duplicates) {
-                    printf("Duplicates found:\n");
-                }
-                has_duplicates = 1;
-                printf("  Value '%s' at rows %d and %d\n", vi, i, j);
-            }
+/* Write one field, quoting it when it holds a comma, quote or line break. */
+static void write_csv_field(FILE *f, const char *p, size_t len) {
+    int needs_quotes = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] == ',' || p[i] == '"' || p[i] == '\n' || p[i] == '\r') {
+            needs_quotes = 1;
+            break;
         }
     }
+    if (!needs_quotes) {
+        fwrite(p, 1, len, f);
+        return;
+    }
+    fputc('"', f);
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] == '"') fputc('"', f);
+        fputc(p[i], f);
+    }
+    fputc('"', f);
+}
 
-    if (!has_duplicates) {
-        printf("No duplicates; column %d can be a UNIQUE / PRIMARY KEY.\n", col);
+static void write_csv_header(FILE *f, const Table *t) {
+    for (int i = 0; i < t->col_count; i++) {
+        const char *name = t->col_names[i] ? t->col_names[i] : "";
+        write_csv_field(f, name, strlen(name));
+        if (i + 1 < t->col_count) fputc(',', f);
     }
+    fputc('\n', f);
+}
 
-    printf("\n");
+static void write_csv_row(FILE *f, const Table *t, int row) {
+    for (int c = 0; c < t->col_count; c++) {
+        Cell cell = table_cell(t, row, c);
+        if (cell.ptr) write_csv_field(f, cell.ptr, cell.len);
+        if (c + 1 < t->col_count) fputc(',', f);
+    }
+    fputc('\n', f);
 }
 
-static void min_by_column(const Table *t) {
+static void save_csv(const char *filename, const Table *t) {
     if (!t || t->col_count == 0) {
         printf("No table loaded.\n");
         return;
     }
-    char buf[64];
-    printf("Enter column index for MIN (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        perror("Error opening output CSV");
         return;
     }
+    write_csv_header(f, t);
+    for (int i = table_next_live(t, 0); i < t->row_count; i = table_next_live(t, i + 1)) {
+        write_csv_row(f, t, i);
+    }
+    fclose(f);
+    printf("Saved table to '%s'.\n", filename);
+}
 
-    int best_idx = -1;
-    double best_val = 0.0;
+/* External sort: ORDER BY of a CSV file larger than memory into another CSV
+ * file, through sorted runs merged by a loser tree; numbers compare as doubles. */
+#define EXTSORT_MEMORY       (1024u * 1024u * 1024u)
+#define EXTSORT_MERGE_BUFFER (64u * 1024u)
+#define EXTSORT_MAX_FAN_IN   256
+#define EXTSORT_ROW_BYTES    72  /* sort scratch per row on top of the cells */
 
-    for (int i = 0; i < t->row_count; i++) {
-        const char *cell = (col < t->rows[i].cell_count && t->rows[i].cells[col])
-                           ? t->rows[i].cells[col] : "";
-        double v;
-        if (!parse_double(cell, &v)) continue;
-        if (best_idx == -1 || v < best_val) {
-            best_idx = i;
-            best_val = v;
-        }
-    }
+/* Smallest read buffer of a run being merged; lowered by the fuzzers. */
+static size_t extsort_merge_buffer = EXTSORT_MERGE_BUFFER;
 
-    if (best_idx == -1) {
-        printf("No numeric values in column %d.\n", col);
-    } else {
-        printf("Row with MIN col[%d]=%.3f:\n", col, best_val);
-        print_header(t);
-        print_row(t, &t->rows[best_idx]);
-    }
+/* Each run's buffer: the budget shared by the widest merge, but no less
+ * than extsort_merge_buffer. */
+static size_t extsort_buffer(size_t memory) {
+    size_t size = memory / EXTSORT_MAX_FAN_IN;
+    if (size < extsort_merge_buffer) size = extsort_merge_buffer;
+    return size ? size : 1;
 }
 
-static int compare_rows_by_col(const Table *t, const Row *a, const Row *b, int col, int asc) {
-    const char *ca = (col < a->cell_count && a->cells[col]) ? a->cells[col] : "";
-    const char *cb = (col < b->cell_count && b->cells[col]) ? b->cells[col] : "";
+typedef struct {
+    size_t rows;
+    size_t runs;        /* sorted runs written */
+    int passes;         /* merge passes, the final one included */
+} ExtSortStats;
 
-    double va, vb;
-    int na = parse_double(ca, &va);
-    int nb = parse_double(cb, &vb);
-    int cmp;
-    if (na && nb) {
-        if (va < vb) cmp = -1;
-        else if (va > vb) cmp = 1;
-        else cmp = 0;
-    } else {
-        cmp = strcmp(ca, cb);
+/* Temporary files live in $TMPDIR (or /tmp) and are unlinked at once, so
+ * they go away with the process. */
+static FILE *extsort_temp_file(size_t buffer) {
+    const char *dir = getenv("TMPDIR");
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/csv_sql_run_XXXXXX", dir && *dir ? dir : "/tmp");
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Error creating temporary file");
+        return NULL;
     }
-    return asc ? cmp : -cmp;
+    unlink(path);
+    FILE *f = fdopen(fd, "w+b");
+    if (!f) {
+        perror("Error creating temporary file");
+        close(fd);
+        return NULL;
+    }
+    setvbuf(f, NULL, _IOFBF, buffer);
+    return f;
 }
 
-static void sort_by_column(Table *t, int col, int asc) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* A run record: key length, fields length, the key, then per field its
+ * length and bytes. */
+static void extsort_write_record(FILE *f, const Table *t, int row, Cell key) {
+    uint32_t head[2] = { (uint32_t)key.len, 0 };
+    for (int c = 0; c < t->col_count; c++) {
+        head[1] += (uint32_t)(sizeof(uint32_t) + t->cols[c].cells[row].len);
     }
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+    fwrite(head, sizeof(head), 1, f);
+    fwrite(key.ptr, 1, key.len, f);
+    for (int c = 0; c < t->col_count; c++) {
+        Cell cell = t->cols[c].cells[row];
+        uint32_t len = (uint32_t)cell.len;
+        fwrite(&len, sizeof(len), 1, f);
+        if (len) fwrite(cell.ptr, 1, len, f);
     }
-    if (t->row_count <= 1) return;
+}
 
-    for (int i = 0; i < t->row_count - 1; i++) {
-        for (int j = 0; j < t->row_count - 1 - i; j++) {
-            if (compare_rows_by_col(t, &t->rows[j], &t->rows[j + 1], col, asc) > 0) {
-                Row tmp = t->rows[j];
-                t->rows[j] = t->rows[j + 1];
-                t->rows[j + 1] = tmp;
-            }
+/* Sort the run in `t` and write it to `f`: as run records or, when the
+ * whole input fit in one run, as CSV rows. Returns 0 when out of memory
+ * or on a write error. */
+static int extsort_write_run(FILE *f, const Table *t, const SortKey *keys, int count, int csv) {
+    SortKeyStrings ks;
+    if (!sort_key_strings(&ks, t, keys, count)) return 0;
+    SortContext s = { t, keys, count, ks.strings, ks.common };
+    int *order = sort_order(&s);
+    if (order) {
+        for (int i = 0; i < t->row_count; i++) {
+            if (csv) write_csv_row(f, t, order[i]);
+            else extsort_write_record(f, t, order[i], ks.strings[order[i]]);
         }
     }
-    printf("Sorted by column %d (%s).\n", col, asc ? "ASC" : "DESC");
+    free(order);
+    sort_key_strings_free(&ks);
+    return order && fflush(f) == 0 && !ferror(f);
 }
 
 typedef struct {
-    char *value;
-    int count;
-} GroupEntry;
+    FILE *f;
+    unsigned char *rec;     /* key, then fields */
+    size_t cap;
+    uint32_t key_len;
+    uint32_t body_len;
+    int done;
+} ExtRun;
 
-static void group_by_column(const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
+/* Read the run's next record. Returns 0 on a read error or when out of
+ * memory; at the end of the run, sets `done`. */
+static int extsort_next(ExtRun *run) {
+    uint32_t head[2];
+    size_t got = fread(head, 1, sizeof(head), run->f);
+    if (got == 0 && !ferror(run->f)) {
+        run->done = 1;
+        return 1;
     }
-    char buf[64];
-    printf("Enter column index to GROUP BY (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+    if (got != sizeof(head)) return 0;
+    size_t need = (size_t)head[0] + head[1];
+    if (need > run->cap) {
+        size_t cap = run->cap ? run->cap : 256;
+        while (cap < need) cap *= 2;
+        unsigned char *grown = (unsigned char *)realloc(run->rec, cap);
+        if (!grown) return 0;
+        run->rec = grown;
+        run->cap = cap;
     }
+    if (fread(run->rec, 1, need, run->f) != need) return 0;
+    run->key_len = head[0];
+    run->body_len = head[1];
+    return 1;
+}
 
-    GroupEntry groups[MAX_ROWS];
-    int group_count = 0;
+/* 1 when run a's record goes first: the smaller key, ties to the earlier
+ * run; finished runs go last. */
+static int extsort_before(const ExtRun *runs, int a, int b) {
+    if (runs[a].done || runs[b].done) return runs[b].done && (!runs[a].done || a < b);
+    Cell ka = { (const char *)runs[a].rec, runs[a].key_len };
+    Cell kb = { (const char *)runs[b].rec, runs[b].key_len };
+    int cmp = cell_compare(ka, kb);
+    return cmp < 0 || (cmp == 0 && a < b);
+}
 
-    for (int i = 0; i < t->row_count; i++) {
-        const char *cell = (col < t->rows[i].cell_count && t->rows[i].cells[col])
-                           ? t->rows[i].cells[col] : "";
-        int found = -1;
-        for (int g = 0; g < group_count; g++) {
-            if (strcmp(groups[g].value, cell) == 0) {
-                found = g;
-                break;
-            }
+static void extsort_write_csv_fields(FILE *out, const unsigned char *p, int col_count) {
+    for (int c = 0; c < col_count; c++) {
+        uint32_t len;
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        write_csv_field(out, (const char *)p, len);
+        p += len;
+        if (c + 1 < col_count) fputc(',', out);
+    }
+    fputc('\n', out);
+}
+
+/* Merge k runs into `out`, as one run or, when csv is set, as CSV rows.
+ * tree[0] holds the run whose record goes next and tree[1 .. k) the
+ * loser of each match, leaves being runs at k .. 2k; taking a record
+ * replays only the matches on its run's path to the root. Returns 0 on
+ * an I/O error or when out of memory. */
+static int extsort_merge(FILE **files, int k, FILE *out, int col_count, int csv) {
+    ExtRun *runs = (ExtRun *)calloc((size_t)k, sizeof(ExtRun));
+    int *tree = (int *)malloc(3 * (size_t)k * sizeof(int));
+    int ok = runs && tree;
+    for (int i = 0; ok && i < k; i++) {
+        runs[i].f = files[i];
+        ok = fseek(files[i], 0, SEEK_SET) == 0 && extsort_next(&runs[i]);
+    }
+    if (ok) {
+        int *win = tree + k;
+        for (int i = 0; i < k; i++) win[k + i] = i;
+        for (int node = k - 1; node > 0; node--) {
+            int a = win[2 * node], b = win[2 * node + 1];
+            int first = extsort_before(runs, a, b);
+            win[node] = first ? a : b;
+            tree[node] = first ? b : a;
         }
-        if (found >= 0) {
-            groups[found].count++;
+        tree[0] = win[1];
+    }
+    while (ok && !runs[tree[0]].done) {
+        int w = tree[0];
+        ExtRun *run = &runs[w];
+        if (csv) {
+            extsort_write_csv_fields(out, run->rec + run->key_len, col_count);
         } else {
-            if (group_count >= MAX_ROWS) {
-                printf("Too many distinct groups; truncating.\n");
-                break;
+            uint32_t head[2] = { run->key_len, run->body_len };
+            fwrite(head, sizeof(head), 1, out);
+            fwrite(run->rec, 1, (size_t)run->key_len + run->body_len, out);
+        }
+        if (!extsort_next(run)) {
+            ok = 0;
+            break;
+        }
+        for (int node = (w + k) / 2; node > 0; node /= 2) {
+            if (extsort_before(runs, tree[node], w)) {
+                int swap = tree[node];
+                tree[node] = w;
+                w = swap;
             }
-            groups[group_count].value = (char *)cell; /* just reference; do not free */
-            groups[group_count].count = 1;
-            group_count++;
         }
+        tree[0] = w;
     }
+    for (int i = 0; runs && i < k; i++) free(runs[i].rec);
+    free(runs);
+    free(tree);
+    return ok && fflush(out) == 0 && !ferror(out);
+}
 
-    printf("\nGROUP BY col[%d] (%s):\n", col,
-           t->col_names[col] ? t->col_names[col] : "(col)");
-    printf("Value | Count\n");
-    printf("--------------\n");
-    for (int g = 0; g < group_count; g++) {
-        printf("%s | %d\n", groups[g].value, groups[g].count);
+/* Merge the runs, fan_in at a time, until one pass can write `out` as
+ * CSV. Closes the runs. */
+static int extsort_merge_runs(FILE **runs, size_t count, size_t fan_in, size_t buffer,
+                              FILE *out, int col_count, ExtSortStats *stats) {
+    int ok = 1;
+    while (ok && count > fan_in) {
+        size_t merged = 0;
+        for (size_t i = 0; i < count; i += fan_in) {
+            size_t k = count - i < fan_in ? count - i : fan_in;
+            if (k == 1) {
+                runs[merged++] = runs[i];
+                continue;
+            }
+            FILE *f = ok ? extsort_temp_file(buffer) : NULL;
+            ok = f && extsort_merge(runs + i, (int)k, f, col_count, 0);
+            for (size_t j = i; j < i + k; j++) fclose(runs[j]);
+            if (f) runs[merged++] = f;
+        }
+        count = merged;
+        stats->passes++;
     }
+    if (ok) {
+        ok = extsort_merge(runs, (int)count, out, col_count, 1);
+        stats->passes++;
+    }
+    for (size_t i = 0; i < count; i++) fclose(runs[i]);
+    return ok;
 }
 
-static void show_distinct_values(const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
-        return;
-    }
+/* Estimated memory a run table and its sort take. */
+static size_t extsort_run_bytes(const Table *t, size_t raw) {
+    return 2 * raw + (size_t)t->row_count * ((size_t)t->col_count * sizeof(Cell) + EXTSORT_ROW_BYTES);
+}
 
-    char buf[64];
-    printf("Enter column index for DISTINCT (0..%d): ", t->col_count - 1);
-    read_line_stdin(buf, sizeof(buf));
-    int col = atoi(buf);
-    if (col < 0 || col >= t->col_count) {
-        printf("Invalid column index.\n");
-        return;
+static int extsort_new_run(Table *run, const Table *header) {
+    init_table(run);
+    for (int c = 0; c < header->col_count; c++) {
+        if (!table_add_column(run, header->col_names[c])) return 0;
     }
+    return 1;
+}
 
-    const char *seen[MAX_ROWS];
-    int seen_count = 0;
+/* Sort the CSV read from `in` by the ORDER BY list `order_by` (as in
+ * order_by_columns()) within about `memory` bytes, writing the header and
+ * the sorted rows to `out`. Returns 0 after printing why on failure. */
+static int external_sort_csv(FILE *in, FILE *out, const char *order_by, size_t memory,
+                             ExtSortStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    /* Reads come in blocks of at most an eighth of the budget, so runs
+     * end close to it. */
+    CsvReader r;
+    size_t block = memory / 8 < csv_read_buffer ? memory / 8 : csv_read_buffer;
+    if (!csv_reader_init(&r, in, block)) {
+        printf("Out of memory.\n");
+        return 0;
+    }
+    size_t n = csv_reader_fill(&r);
+    if (n == 0) {
+        printf(r.error ? "Error reading CSV.\n" : "CSV file is empty.\n");
+        csv_reader_free(&r);
+        return 0;
+    }
+    Table header, run;
+    init_table(&header);
+    init_table(&run);
+    SortKey keys[SORT_MAX_KEYS];
+    int count = -1;
+    size_t header_len = csv_read_header(&header, r.buf, n);
+    if (header_len == 0) {
+        printf("Out of memory.\n");
+    } else {
+        csv_reader_consume(&r, header_len);
+        count = parse_order_by(&header, order_by, keys, SORT_MAX_KEYS);
+        if (count == 0) printf("No ORDER BY columns given.\n");
+    }
+    int ok = count > 0 && extsort_new_run(&run, &header);
+    if (count > 0 && !ok) printf("Out of memory.\n");
 
-    for (int i = 0; i < t->row_count; i++) {
-        const Row *r = &t->rows[i];
-        const char *cell = (col < r->cell_count && r->cells[col])
-                           ? r->cells[col] : "";
-
-        int already = 0;
-        for (int j = 0; j < seen_count; j++) {
-            if (strcmp(seen[j], cell) == 0) {
-                already = 1;
+    FILE **runs = NULL;
+    size_t run_cap = 0, raw = 0;
+    int last = 0;
+    while (ok && !last) {
+        n = csv_reader_fill(&r);
+        if (n > 0) {
+            Cell block = arena_cell(&run.strings, r.buf, n);
+            if (!block.ptr || !csv_parse_parallel(&run, block.ptr, n)) {
+                printf("Out of memory.\n");
+                ok = 0;
                 break;
             }
+            csv_reader_consume(&r, n);
+            raw += n;
         }
-        if (!already) {
-            if (seen_count < MAX_ROWS) {
-                seen[seen_count++] = cell;
-            } else {
-                printf("Too many distinct values; truncating.\n");
+        last = n == 0;
+        if (r.error) {
+            printf("Error reading CSV.\n");
+            ok = 0;
+            break;
+        }
+        if (!last && extsort_run_bytes(&run, raw) < memory) continue;
+        if (last && stats->runs == 0) {
+            /* Everything fit: sort in memory and write the CSV directly. */
+            write_csv_header(out, &header);
+            ok = extsort_write_run(out, &run, keys, count, 1);
+            if (!ok) printf("Error writing sorted CSV.\n");
+            stats->rows = (size_t)run.row_count;
+            break;
+        }
+        if (run.row_count == 0) continue;
+        if (stats->runs == run_cap) {
+            run_cap = run_cap ? run_cap * 2 : 16;
+            FILE **grown = (FILE **)realloc(runs, run_cap * sizeof(FILE *));
+            if (!grown) {
+                printf("Out of memory.\n");
+                ok = 0;
                 break;
             }
+            runs = grown;
+        }
+        FILE *f = extsort_temp_file(extsort_buffer(memory));
+        if (!f) {
+            ok = 0;
+            break;
+        }
+        runs[stats->runs++] = f;
+        if (!extsort_write_run(f, &run, keys, count, 0)) {
+            printf("Error writing sorted run.\n");
+            ok = 0;
+            break;
+        }
+        stats->rows += (size_t)run.row_count;
+        free_table(&run);
+        raw = 0;
+        if (!extsort_new_run(&run, &header)) {
+            printf("Out of memory.\n");
+            ok = 0;
         }
     }
+    free_table(&run);
+    csv_reader_free(&r);
 
-    printf("\nDISTINCT values of column %d (%s):\n",
-           col, t->col_names[col] ? t->col_names[col] : "(col)");
-    for (int i = 0; i < seen_count; i++) {
-        printf("%s\n", seen[i]);
+    if (stats->runs > 0) {
+        size_t buffer = extsort_buffer(memory);
+        size_t fan_in = memory / buffer;
+        if (fan_in < 2) fan_in = 2;
+        if (fan_in > EXTSORT_MAX_FAN_IN) fan_in = EXTSORT_MAX_FAN_IN;
+        if (ok) {
+            write_csv_header(out, &header);
+            ok = extsort_merge_runs(runs, stats->runs, fan_in, buffer, out, header.col_count, stats);
+            if (!ok) printf("Error merging sorted runs.\n");
+        } else {
+            for (size_t i = 0; i < stats->runs; i++) fclose(runs[i]);
+        }
     }
-    printf("Total distinct values: %d\n", seen_count);
+    free(runs);
+    free_table(&header);
+    return ok;
 }
 
-static void save_csv(const char *filename, const Table *t) {
-    if (!t || t->col_count == 0) {
-        printf("No table loaded.\n");
+static void external_sort_file(void) {
+    char in_name[256], out_name[256], order_by[256], buf[64];
+    printf("Enter CSV filename to sort: ");
+    read_line_stdin(in_name, sizeof(in_name));
+    printf("Enter ORDER BY column indexes, each optionally ASC or DESC, e.g. 2, 5, 3 DESC: ");
+    read_line_stdin(order_by, sizeof(order_by));
+    printf("Enter filename for the sorted CSV: ");
+    read_line_stdin(out_name, sizeof(out_name));
+    printf("Enter memory budget in MB (default %u): ", EXTSORT_MEMORY >> 20);
+    read_line_stdin(buf, sizeof(buf));
+    if (in_name[0] == '\0' || out_name[0] == '\0') {
+        printf("No filename.\n");
         return;
     }
-    FILE *f = fopen(filename, "w");
-    if (!f) {
+    if (strcmp(in_name, out_name) == 0) {
+        printf("Output must be a different file.\n");
+        return;
+    }
+    long mb = atol(buf);
+    size_t memory = mb > 0 ? (size_t)mb << 20 : EXTSORT_MEMORY;
+
+    FILE *in = fopen(in_name, "r");
+    if (!in) {
+        perror("Error opening CSV");
+        return;
+    }
+    FILE *out = fopen(out_name, "w");
+    if (!out) {
         perror("Error opening output CSV");
+        fclose(in);
         return;
     }
-    for (int i = 0; i < t->col_count; i++) {
-        fprintf(f, "%s", t->col_names[i] ? t->col_names[i] : "");
-        if (i + 1 < t->col_count) fputc(',', f);
+    ExtSortStats stats;
+    int ok = external_sort_csv(in, out, order_by, memory, &stats);
+    fclose(in);
+    if (fclose(out) != 0 && ok) {
+        printf("Error writing sorted CSV.\n");
+        return;
     }
-    fputc('\n', f);
-    for (int i = 0; i < t->row_count; i++) {
-        Row const *r = &t->rows[i];
-        for (int c = 0; c < t->col_count; c++) {
-            const char *cell = (c < r->cell_count && r->cells[c]) ? r->cells[c] : "";
-            fprintf(f, "%s", cell);
-            if (c + 1 < t->col_count) fputc(',', f);
-        }
-        fputc('\n', f);
+    if (ok) {
+        printf("Sorted %zu rows into '%s' (%zu runs, %d merge passes).\n", stats.rows, out_name,
+               stats.runs, stats.passes);
     }
-    fclose(f);
-    printf("Saved table to '%s'.\n", filename);
 }
 
 static void print_menu(void) {
@@ -957,14 +6500,46 @@ static void print_menu(void) {
     printf("17. Find rows where column CONTAINS substring (LIKE)\n");
     printf("18. Find rows where numeric column is BETWEEN min and max\n");
     printf("19. Save table to CSV\n");
-    printf("20. Exit\n");
+    printf("20. CREATE INDEX on column (WHERE col = value lookups)\n");
+    printf("21. CREATE ORDERED INDEX on numeric column (BETWEEN lookups)\n");
+    printf("22. CREATE TRIGRAM INDEX on text column (LIKE lookups)\n");
+    printf("23. Add UNIQUE / PRIMARY KEY constraint on column\n");
+    printf("24. ORDER BY columns (multi-key, ASC / DESC each)\n");
+    printf("25. External sort of a CSV file larger than memory (ORDER BY)\n");
+    printf("26. Compact table (purge deleted rows)\n");
+    printf("27. DELETE all rows WHERE col = value\n");
+    printf("28. UPDATE all rows WHERE col = value\n");
+    printf("29. All stats of numeric column (COUNT / SUM / AVG / MIN / MAX)\n");
+    printf("30. APPROX_COUNT_DISTINCT of a column (HyperLogLog)\n");
+    printf("31. PERCENTILES of numeric column (p50 / p95 / p99, exact or t-digest)\n");
+    printf("32. Exit\n");
 
     printf("====================================\n");
     printf("Enter choice: ");
 }
 
-#ifndef FUZZING
-int main(void) {
+#if !defined(FUZZING) && !defined(BENCHMARK)
+static void print_usage(const char *prog) {
+    printf("Usage: %s [-t threads]\n", prog);
+    printf("  -t, --threads N   threads used to load, group and sort (default: one per CPU)\n");
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            char *endp;
+            long n = strtol(argv[++i], &endp, 10);
+            if (*endp != '\0' || n < 1 || n > CSV_MAX_THREADS) {
+                printf("Thread count must be between 1 and %d.\n", CSV_MAX_THREADS);
+                return 1;
+            }
+            csv_load_threads = (int)n;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
     Table table;
     init_table(&table);
 
@@ -1079,7 +6654,55 @@ int main(void) {
                 }
                 break;
             }
-            case 20:{
+            case 20: {
+                create_index(&table);
+                break;
+            }
+            case 21: {
+                create_range_index(&table);
+                break;
+            }
+            case 22: {
+                create_trigram_index(&table);
+                break;
+            }
+            case 23: {
+                add_key_constraint(&table);
+                break;
+            }
+            case 24: {
+                order_by_columns(&table);
+                break;
+            }
+            case 25: {
+                external_sort_file();
+                break;
+            }
+            case 26: {
+                compact_table(&table);
+                break;
+            }
+            case 27: {
+                delete_rows_where(&table);
+                break;
+            }
+            case 28: {
+                update_rows_where(&table);
+                break;
+            }
+            case 29: {
+                column_stats_report(&table);
+                break;
+            }
+            case 30: {
+                approx_count_distinct(&table);
+                break;
+            }
+            case 31: {
+                percentiles_column(&table);
+                break;
+            }
+            case 32:{
                 running = 0;
                 break;
                 }
@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_approx_distinct()
+#include "fuzz_table.h"
+
+/* Values "v<k>" with k below a range from data[2], so the cardinality runs
+ * from one to every row; with data[3] bit 1 some cells are empty. */
+static Cell distinct_cell(FuzzInput *in, int r, int c, char *buf) {
+    uint32_t range = 1 + (in->data[2] * 37u) % (FUZZ_MAX_ROWS + 1);
+    uint32_t k = (fuzz_byte(in, r, c) * 977u + (uint32_t)r * (in->data[3] | 1)) % range;
+    if (k == 0 && (in->data[3] & 2)) return fuzz_text("");
+    snprintf(buf, FUZZ_CELL_MAX, "v%u", k);
+    return fuzz_text(buf);
+}
+
+/* The sketch of a column must not depend on how its rows are split across
+ * threads, must be the sketch of its distinct values alone, and must
+ * estimate the exact DISTINCT count within a few standard errors. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 4) return 0;
+
+    FuzzInput in = { data, size, 4, NULL, 0, 0, 0 };
+    Table t;
+    fuzz_table_build(&t, 1, fuzz_count(data[0] * 16 + data[1], 0, FUZZ_MAX_ROWS), distinct_cell, &in);
+    /* Some rows are deleted. */
+    tombstone_min_dead = FUZZ_MAX_ROWS + 1;
+    for (int r = data[1] % 5; (data[3] & 4) && r < t.row_count; r += 2 + data[2] % 7) {
+        table_delete_row(&t, r);
+    }
+
+    int precision = HLL_MIN_PRECISION + data[3] % (HLL_MAX_PRECISION - HLL_MIN_PRECISION + 1);
+    size_t m = (size_t)1 << precision;
+
+    /* One thread, then row ranges on several threads, merged. */
+    HyperLogLog serial, parallel;
+    csv_load_threads = 1;
+    if (!table_approx_distinct(&t, 0, precision, &serial)) abort();
+    csv_load_threads = 1 + data[0] % 7;
+    agg_parallel_min_rows = 1 + data[1] % 64;
+    if (!table_approx_distinct(&t, 0, precision, &parallel)) abort();
+    csv_load_threads = 0;
+    agg_parallel_min_rows = AGG_PARALLEL_MIN_ROWS;
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+    if (serial.precision != precision || memcmp(serial.registers, parallel.registers, m) != 0) abort();
+
+    /* Duplicates change nothing: sketching each distinct value once gives
+     * the same registers. */
+    Aggregate agg;
+    int key = 0;
+    if (!table_aggregate(&agg, &t, &key, 1, NULL, 0)) abort();
+    HyperLogLog distinct;
+    if (!hll_init(&distinct, precision)) abort();
+    for (int g = 0; g < agg.groups; g++) {
+        hll_add_hash(&distinct, hash_bytes(agg.keys[g].ptr, agg.keys[g].len));
+    }
+    if (memcmp(serial.registers, distinct.registers, m) != 0) abort();
+
+    double estimate = hll_estimate(&serial);
+    double exact = (double)agg.groups;
+    if (exact == 0.0 && estimate != 0.0) abort();
+    if (fabs(estimate - exact) > 1.0 + 5.0 * hll_std_error(precision) * exact) abort();
+
+    /* The square root the estimator takes of register fractions. */
+    double x = (double)(1 + data[2]) / (double)(2 + data[2] + data[0] * 1024);
+    double root = unit_sqrt(x);
+    if (fabs(root * root - x) > 4 * DBL_EPSILON * x) abort();
+
+    /* Merging with an empty sketch changes nothing, either way round. */
+    HyperLogLog empty;
+    if (!hll_init(&empty, precision)) abort();
+    hll_merge(&parallel, &empty);
+    hll_merge(&empty, &serial);
+    if (memcmp(empty.registers, serial.registers, m) != 0) abort();
+    if (hll_estimate(&parallel) != estimate) abort();
+
+    hll_free(&empty);
+    hll_free(&distinct);
+    hll_free(&serial);
+    hll_free(&parallel);
+    agg_free(&agg);
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real column_stats()
+#include "fuzz_table.h"
+
+/* Integers and halves, some big enough that a plain sum loses the small
+ * ones, so a compensated sum is exact here and can be checked exactly.
+ * Whether a column ends up INT64, DOUBLE or text depends on the mix. */
+static const char *const vocab[] = {
+    "", "1", "-1", "3", "0", "-0", "10000000000000000", "-10000000000000000",
+    "9223372036854775807", "-9223372036854775808", "4611686018427387904",
+    "0.5", "-2.5", "1e16", "-1e16", "nan", "inf", "-inf", "abc",
+};
+
+/* Each column draws from a few vocab entries so some stay typed. */
+static Cell stats_cell(FuzzInput *in, int r, int c, char *buf) {
+    (void)buf;
+    int span = 2 + c * 4 + (in->data[0] >> 4) % 8;
+    return fuzz_text(vocab[(fuzz_byte(in, r, c) % span + in->data[2] * c) % COUNT_OF(vocab)]);
+}
+
+/* Twice the value of a cell, exactly; 0 with *special set for NaN and
+ * infinities. Every finite value here is a multiple of one half below
+ * 2^64, so twice it fits in an __int128. */
+static __int128 twice_value(const Table *t, int row, int c, double *v, int *special) {
+    const Column *col = &t->cols[c];
+    *special = 0;
+    if (col->type == COL_INT64) {
+        *v = (double)col->ints[row];
+        return (__int128)col->ints[row] * 2;
+    }
+    if (!isfinite(*v)) {
+        *special = 1;
+        return 0;
+    }
+    return (__int128)(*v * 2.0);
+}
+
+/* Brute force over table_cell_number() and the cell text. */
+static void reference(const Table *t, int c, ColumnStats *s) {
+    memset(s, 0, sizeof(*s));
+    s->min_row = s->max_row = -1;
+    __int128 twice = 0;
+    int nan = 0, pos_inf = 0, neg_inf = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        double v;
+        if (!table_cell_number(t, r, c, &v)) {
+            if (t->cols[c].cells[r].len > 0) s->non_numeric++;
+            continue;
+        }
+        s->count++;
+        int special;
+        twice += twice_value(t, r, c, &v, &special);
+        if (special) {
+            if (isnan(v)) nan = 1;
+            else if (v > 0) pos_inf = 1;
+            else neg_inf = 1;
+            if (isnan(v)) continue;
+        }
+        if (s->min_row < 0 || v < s->min) {
+            s->min_row = r;
+            s->min = v;
+        }
+        if (s->max_row < 0 || v > s->max) {
+            s->max_row = r;
+            s->max = v;
+        }
+    }
+    if (nan || (pos_inf && neg_inf)) s->sum = NAN;
+    else if (pos_inf) s->sum = INFINITY;
+    else if (neg_inf) s->sum = -INFINITY;
+    else s->sum = (double)twice / 2.0;
+}
+
+static int same_double(double a, double b) {
+    return (isnan(a) && isnan(b)) || a == b;
+}
+
+static void check(const Table *t, int c, const ColumnStats *want) {
+    ColumnStats got;
+    column_stats(t, c, &got);
+    if (got.count != want->count || got.non_numeric != want->non_numeric) abort();
+    if (!same_double(got.sum, want->sum)) abort();
+    if (got.min_row != want->min_row || got.max_row != want->max_row) abort();
+    if (got.min_row >= 0 && (got.min != want->min || got.max != want->max)) abort();
+}
+
+/* Every kernel must give the reference's stats, sum included bit for bit,
+ * on typed and text columns, with tombstones and with null cells. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 3) return 0;
+
+    int col_count = fuzz_count(data[0], 1, 3);
+    FuzzInput in = { data, size, 3, NULL, 0, 0, 0 };
+    Table t;
+    fuzz_table_build(&t, col_count, fuzz_count(data[1] * 4 + data[2], 0, 1024), stats_cell, &in);
+    if (data[0] & 4) table_infer_types(&t);
+
+    /* Tombstones: typed cells lose their value, text cells their text. */
+    tombstone_min_dead = FUZZ_MAX_ROWS + 1;
+    for (int r = data[1] % 7; (data[0] & 8) && r < t.row_count; r += 1 + data[1] % 5) {
+        table_delete_row(&t, r);
+    }
+
+    for (int c = 0; c < col_count; c++) {
+        ColumnStats want;
+        reference(&t, c, &want);
+        stats_kernels = &stats_kernels_scalar;
+        check(&t, c, &want);
+#ifdef CSV_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            stats_kernels = &stats_kernels_avx2;
+            check(&t, c, &want);
+        }
+#endif
+        stats_kernels = NULL;
+        check(&t, c, &want);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    free_table(&t);
+    return 0;
+}
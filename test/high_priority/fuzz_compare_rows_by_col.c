@@ -6,6 +6,7 @@
 
 /* Import REAL implementation */
 #include "../../csv_sql.c"
+#include "fuzz_table.h"
 
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
@@ -13,54 +14,20 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     /* Build a Table with 2 rows */
     Table t;
+    FuzzInput in = { data, size, 0, NULL, 0, 0, 0 };
+    fuzz_table_build(&t, fuzz_count(data[0], 1, 16), 2, fuzz_slice_cell, &in);
 
-    t.col_count = data[0] % (MAX_COLS + 1);
-    if (t.col_count == 0)
-        t.col_count = 1;
-
-    t.row_count = 2;
-
-    /* Allocate column names */
-    for (int i = 0; i < t.col_count; i++) {
-        t.col_names[i] = malloc(8);
-        strcpy(t.col_names[i], "col");
-    }
-
-    /* Build cell contents */
-    for (int r = 0; r < 2; r++) {
-        t.rows[r].cell_count = t.col_count;
-
-        for (int c = 0; c < t.col_count; c++) {
-
-            size_t alloc = 4 + ((r + c) % 32);
-            t.rows[r].cells[c] = malloc(alloc);
-
-            if (t.rows[r].cells[c]) {
-
-                size_t usable = alloc - 1;
-                size_t idx = (2 + r + c) % size;
-                size_t avail = size - idx;
-                size_t n = (usable < avail ? usable : avail);
-
-                memcpy(t.rows[r].cells[c], &data[idx], n);
-                t.rows[r].cells[c][n] = '\0';
-            }
-        }
-    }
+    /* Half the runs go through the typed-column paths */
+    if (data[size - 1] & 1) table_infer_types(&t);
 
     int col = data[1] % t.col_count;
     int asc = data[2] & 1;
 
     /* Call REAL project function */
-    compare_rows_by_col(&t, &t.rows[0], &t.rows[1], col, asc);
+    compare_rows_by_col(&t, 0, 1, col, asc);
 
     /* Cleanup */
-    for (int r = 0; r < 2; r++)
-        for (int c = 0; c < t.col_count; c++)
-            free(t.rows[r].cells[c]);
-
-    for (int i = 0; i < t.col_count; i++)
-        free(t.col_names[i]);
+    free_table(&t);
 
     return 0;
 }
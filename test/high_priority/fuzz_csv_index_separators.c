@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real csv_index_separators()
+
+/* Every block scanner must produce exactly the unquoted separator offsets
+ * of a byte-at-a-time reference, including on the padded tail block. The
+ * input is indexed in two halves so the quote state crosses a call. */
+static size_t index_with(CsvBlockScanner scan, const char *p, size_t len, uint32_t *pos) {
+    CsvScanState st = { 0, 0, 0 };
+    size_t half = len / 2;
+    csv_scanner = scan;
+    size_t n = csv_index_separators(p, half, pos, &st);
+    size_t m = csv_index_separators(p + half, len - half, pos + n, &st);
+    for (size_t i = n; i < n + m; i++) pos[i] += (uint32_t)half;
+    return n + m;
+}
+
+/* A quote opens a quoted section only at the start of a field or right
+ * after the quote that closed one; anywhere else it is literal. */
+static size_t index_reference(const char *p, size_t len, uint32_t *pos) {
+    size_t n = 0;
+    int quoted = 0, may_open = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (quoted) {
+            if (p[i] == '"') quoted = 0, may_open = 1;
+        } else if (p[i] == '"' && may_open) {
+            quoted = 1;
+        } else {
+            may_open = p[i] == ',' || p[i] == '\n';
+            if (may_open) pos[n++] = (uint32_t)i;
+        }
+    }
+    return n;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size == 0) return 0;
+    if (size > CSV_WINDOW) size = CSV_WINDOW;
+
+    const char *input = (const char *)data;
+    uint32_t *expected = malloc(size * sizeof(uint32_t));
+    uint32_t *actual = malloc(size * sizeof(uint32_t));
+    if (!expected || !actual) {
+        free(expected);
+        free(actual);
+        return 0;
+    }
+
+    size_t n = index_reference(input, size, expected);
+    size_t m = index_with(csv_scan_block_scalar, input, size, actual);
+    if (m != n || memcmp(expected, actual, n * sizeof(uint32_t)) != 0) abort();
+
+#ifdef CSV_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        m = index_with(csv_scan_block_sse2, input, size, actual);
+        if (m != n || memcmp(expected, actual, n * sizeof(uint32_t)) != 0) abort();
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        m = index_with(csv_scan_block_avx2, input, size, actual);
+        if (m != n || memcmp(expected, actual, n * sizeof(uint32_t)) != 0) abort();
+    }
+#endif
+
+    csv_scanner = NULL;
+    free(expected);
+    free(actual);
+    return 0;
+}
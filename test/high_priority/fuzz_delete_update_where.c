@@ -0,0 +1,176 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_select_equal(), table_delete_rows(), table_update_rows()
+#include "fuzz_table.h"
+
+/* Few values, so predicates match many rows; numbers keep columns typed. */
+static const char *const vocab[] = {
+    "", "1", "2", "2.0", "-3", "1.5", "abc", "ab", "xabcx", "nan",
+};
+
+/* Reference: the live rows in order, each cell a vocab index. */
+static int ref[FUZZ_GROW_ROWS][FUZZ_MAX_COLS];
+static int ref_rows;
+
+static Cell ref_cell(FuzzInput *in, int r, int c, char *buf) {
+    (void)buf;
+    ref[r][c] = fuzz_byte(in, r, c) % COUNT_OF(vocab);
+    return fuzz_text(vocab[ref[r][c]]);
+}
+
+static int cell_is(Cell c, const char *v) {
+    return cell_equals(c, v, strlen(v));
+}
+
+/* Live row `k` of the table holds ref[k], and no other row is live. */
+static void check_rows(const Table *t, int col_count) {
+    int k = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        if (!table_row_live(t, r)) {
+            for (int c = 0; c < col_count; c++) {
+                if (t->cols[c].cells[r].len != 0) abort();
+            }
+            continue;
+        }
+        if (k >= ref_rows) abort();
+        for (int c = 0; c < col_count; c++) {
+            if (!cell_is(t->cols[c].cells[r], vocab[ref[k][c]])) abort();
+        }
+        k++;
+    }
+    if (k != ref_rows || table_live_rows(t) != ref_rows) abort();
+}
+
+/* Every index created is still there (indexes are only dropped when out
+ * of memory) and agrees with a scan of the live rows. */
+static void check_indexes(const Table *t, int col_count, uint8_t indexes) {
+    int expected[FUZZ_GROW_ROWS], actual[FUZZ_GROW_ROWS];
+    for (int c = 0; c < col_count; c++) {
+        const Column *col = &t->cols[c];
+        if (!col->index != !(indexes & (1 << c))) abort();
+        if (!col->range != !(indexes & (8 << c))) abort();
+        if (!col->grams != ((indexes >> 6) != c + 1)) abort();
+        if (col->index && col->index->count != (size_t)table_live_rows(t)) abort();
+        for (int v = 0; v < COUNT_OF(vocab); v++) {
+            int *rows;
+            int n = table_select_equal(t, c, vocab[v], &rows);
+            if (n < 0) abort();
+            int m = 0;
+            for (int r = 0; r < t->row_count; r++) {
+                if (!table_row_live(t, r) || !cell_is(col->cells[r], vocab[v])) continue;
+                if (m >= n || rows[m] != r) abort();
+                m++;
+            }
+            if (m != n) abort();
+            free(rows);
+        }
+        if (col->range) {
+            int n = 0;
+            for (int r = 0; r < t->row_count; r++) {
+                double x;
+                if (table_row_live(t, r) && table_cell_number(t, r, c, &x) && x >= -3 && x <= 2) {
+                    expected[n++] = r;
+                }
+            }
+            if (find_rows_in_range(t, c, -3, 2, actual, FUZZ_GROW_ROWS) != n) abort();
+            if (memcmp(expected, actual, (size_t)n * sizeof(int)) != 0) abort();
+        }
+        if (col->grams) {
+            int n = 0;
+            for (int r = 0; r < t->row_count; r++) {
+                if (table_row_live(t, r) && cell_contains(col->cells[r], "abc", 3)) expected[n++] = r;
+            }
+            if (find_rows_by_substring(t, c, "abc", actual, FUZZ_GROW_ROWS) != n) abort();
+            if (memcmp(expected, actual, (size_t)n * sizeof(int)) != 0) abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 4) return 0;
+
+    int col_count = fuzz_count(data[0], 1, 3);
+    ref_rows = fuzz_count(data[1] * 2 + data[2], 0, FUZZ_GROW_ROWS);
+    FuzzInput in = { data, size, 4, NULL, 0, 0, 0 };
+    Table t;
+    fuzz_table_build(&t, col_count, ref_rows, ref_cell, &in);
+    if (data[1] & 1) table_infer_types(&t);
+
+    /* Indexes from the bits of data[3]: hash, ordered and trigram per column. */
+    for (int c = 0; c < col_count; c++) {
+        if (data[3] & (1 << c)) table_create_index(&t, c);
+        if (data[3] & (8 << c)) table_create_range_index(&t, c);
+        if ((data[3] >> 6) == c + 1) table_create_trigram_index(&t, c);
+    }
+    /* Some runs compact after every few deletes; some apply even small
+     * batches wholesale. */
+    tombstone_min_dead = (data[0] & 4) ? 1 + data[0] / 8 : TOMBSTONE_MIN_DEAD;
+    table_batch_min_rows = (data[0] & 8) ? data[2] % 8 : TABLE_BATCH_MIN_ROWS;
+    check_rows(&t, col_count);
+    check_indexes(&t, col_count, data[3]);
+
+    /* DELETE / UPDATE ... WHERE col = value, and single-row deletes in between. */
+    while (in.pos + 3 <= size) {
+        int op = data[in.pos] % 4;
+        int col = data[in.pos + 1] % col_count;
+        int v = data[in.pos + 2] % COUNT_OF(vocab);
+        int target = (data[in.pos] >> 2) % col_count;
+        int w = (data[in.pos + 2] / COUNT_OF(vocab) + data[in.pos + 1]) % COUNT_OF(vocab);
+        in.pos += 3;
+
+        if (op == 3) {
+            int r = table_next_live(&t, 0);
+            for (int k = data[in.pos - 2] % (ref_rows + 1); k > 0 && r < t.row_count; k--) {
+                r = table_next_live(&t, r + 1);
+            }
+            if (r >= t.row_count) continue;
+            int k = 0;
+            for (int i = table_next_live(&t, 0); i < r; i = table_next_live(&t, i + 1)) k++;
+            if (!table_delete_row(&t, r)) abort();
+            memmove(ref[k], ref[k + 1], (size_t)(ref_rows - k - 1) * sizeof(ref[0]));
+            ref_rows--;
+        } else {
+            int *rows;
+            int n = table_select_equal(&t, col, vocab[v], &rows);
+            if (n < 0) abort();
+            if (op == 0) {
+                if (!table_delete_rows(&t, rows, n)) abort();
+                int kept = 0;
+                for (int k = 0; k < ref_rows; k++) {
+                    if (ref[k][col] == v) continue;
+                    memmove(ref[kept], ref[k], sizeof(ref[0]));
+                    kept++;
+                }
+                if (ref_rows - kept != n) abort();
+                ref_rows = kept;
+            } else {
+                /* SET target = w, and for op 2 also the condition column. */
+                const char *set[FUZZ_MAX_COLS] = { NULL };
+                set[target] = vocab[w];
+                if (op == 2) set[col] = vocab[(w + 1) % COUNT_OF(vocab)];
+                if (!table_update_rows(&t, rows, n, set)) abort();
+                int matched = 0;
+                for (int k = 0; k < ref_rows; k++) {
+                    if (ref[k][col] != v) continue;
+                    matched++;
+                    ref[k][target] = w;
+                    if (op == 2) ref[k][col] = (w + 1) % COUNT_OF(vocab);
+                }
+                if (matched != n) abort();
+            }
+            free(rows);
+        }
+        check_rows(&t, col_count);
+        check_indexes(&t, col_count, data[3]);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+    table_batch_min_rows = TABLE_BATCH_MIN_ROWS;
+
+    free_table(&t);
+    return 0;
+}
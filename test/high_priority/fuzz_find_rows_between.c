@@ -6,6 +6,7 @@
 
 /* Use the REAL project implementation */
 #include "../../csv_sql.c"
+#include "fuzz_table.h"
 
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
@@ -19,39 +20,10 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 
     /* Build valid table */
     Table t;
+    fuzz_slice_table(&t, data, size, 1);
 
-    t.col_count = data[0] % (MAX_COLS + 1);
-    if (t.col_count == 0) t.col_count = 1;
-
-    t.row_count = data[1] % (MAX_ROWS + 1);
-    if (t.row_count == 0) t.row_count = 1;
-
-    /* Column names */
-    for (int i = 0; i < t.col_count; i++) {
-        t.col_names[i] = malloc(8);
-        strcpy(t.col_names[i], "col");
-    }
-
-    /* Rows and cells */
-    for (int r = 0; r < t.row_count; r++) {
-        t.rows[r].cell_count = t.col_count;
-
-        for (int c = 0; c < t.col_count; c++) {
-
-            size_t alloc = 4 + ((r + c) % 32);
-            t.rows[r].cells[c] = malloc(alloc);
-
-            if (t.rows[r].cells[c]) {
-                size_t usable = alloc - 1;
-                size_t idx = (2 + r + c) % size;
-                size_t avail = size - idx;
-                size_t n = usable < avail ? usable : avail;
-
-                memcpy(t.rows[r].cells[c], &data[idx], n);
-                t.rows[r].cells[c][n] = '\0';
-            }
-        }
-    }
+    /* Half the runs go through the typed-column paths */
+    if (data[size - 1] & 1) table_infer_types(&t);
 
     /* Fake stdin for: col index, min, max */
     char *input = malloc(size + 3);
@@ -80,12 +52,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
     free(input);
 
     /* Cleanup */
-    for (int i = 0; i < t.col_count; i++)
-        free(t.col_names[i]);
-
-    for (int r = 0; r < t.row_count; r++)
-        for (int c = 0; c < t.col_count; c++)
-            free(t.rows[r].cells[c]);
+    free_table(&t);
 
     return 0;
 }
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_aggregate()
+#include "fuzz_table.h"
+
+/* Numeric spellings that compare equal but group apart, specials and text. */
+static const char *const vocab[] = {
+    "", "1", "1.0", "01", "-1", "2", "10", "abc", "ab", "b", "key", "1e1",
+    "nan", "inf", "-inf", "0.5",
+};
+
+/* Even columns draw from the vocabulary; odd ones from the raw bytes,
+ * so some keys have many distinct values and the slots grow. */
+static Cell aggregate_cell(FuzzInput *in, int r, int c, char *buf) {
+    uint8_t b = fuzz_byte(in, r, c);
+    if (c % 2 == 0) return fuzz_text(vocab[b % COUNT_OF(vocab)]);
+    snprintf(buf, FUZZ_CELL_MAX, "%d", c == 1 ? b % 32 : b * 131 + r);
+    return fuzz_text(buf);
+}
+
+static int same_key(const Table *t, const int *keys, int key_count, int a, int b) {
+    for (int k = 0; k < key_count; k++) {
+        if (cell_compare(t->cols[keys[k]].cells[a], t->cols[keys[k]].cells[b]) != 0) return 0;
+    }
+    return 1;
+}
+
+static int same_double(double a, double b, int exact) {
+    if (a != a || b != b) return a != a && b != b;
+    if (a == b) return 1;
+    double scale = (a < 0 ? -a : a) + (b < 0 ? -b : b);
+    return !exact && (a - b < 0 ? b - a : a - b) <= scale * 1e-12;
+}
+
+/* Reference: groups in order of first appearance, with their row counts
+ * and the aggregates of every value column, accumulated in row order.
+ * Deleted rows belong to no group. */
+static void check_groups(const Table *t, const int *keys, int key_count,
+                         const int *values, int value_count, const Aggregate *a, int exact) {
+    int g = 0, total = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        if (!table_row_live(t, r)) continue;
+        int seen = 0;
+        for (int i = 0; i < r && !seen; i++) {
+            seen = table_row_live(t, i) && same_key(t, keys, key_count, i, r);
+        }
+        if (seen) continue;
+        if (g >= a->groups || a->first[g] != r) abort();
+        for (int k = 0; k < key_count; k++) {
+            if (cell_compare(a->keys[(size_t)g * key_count + k], t->cols[keys[k]].cells[r]) != 0) abort();
+        }
+        int count = 0;
+        for (int i = r; i < t->row_count; i++) {
+            if (table_row_live(t, i) && same_key(t, keys, key_count, i, r)) count++;
+        }
+        if (a->counts[g] != count) abort();
+        for (int v = 0; v < value_count; v++) {
+            double n = 0, sum = 0, lo = 0, hi = 0, x;
+            for (int i = r; i < t->row_count; i++) {
+                if (!table_row_live(t, i) || !same_key(t, keys, key_count, i, r)) continue;
+                if (!table_cell_number(t, i, values[v], &x) || x != x) continue;
+                if (n == 0 || x < lo) lo = x;
+                if (n == 0 || x > hi) hi = x;
+                sum += x;
+                n++;
+            }
+            double got;
+            if (!agg_result(a, g, v, AGG_COUNT, &got) || got != n) abort();
+            if (agg_result(a, g, v, AGG_SUM, &got) != (n > 0)) abort();
+            if (n > 0 && !same_double(got, sum, exact)) abort();
+            if (agg_result(a, g, v, AGG_AVG, &got) != (n > 0)) abort();
+            if (n > 0 && !same_double(got, sum / n, exact)) abort();
+            if (agg_result(a, g, v, AGG_MIN, &got) != (n > 0) || (n > 0 && got != lo)) abort();
+            if (agg_result(a, g, v, AGG_MAX, &got) != (n > 0) || (n > 0 && got != hi)) abort();
+        }
+        total += count;
+        g++;
+    }
+    if (g != a->groups || total != table_live_rows(t)) abort();
+}
+
+/* Sorted output: ascending by the Sort ASC comparison on each key column
+ * in turn, ties by first appearance. */
+static void check_sorted(const Table *t, const int *keys, int key_count,
+                         const Aggregate *a, const int *order) {
+    for (int i = 1; i < a->groups; i++) {
+        int ra = a->first[order[i - 1]], rb = a->first[order[i]];
+        int cmp = 0;
+        for (int k = 0; k < key_count && cmp == 0; k++) {
+            cmp = compare_rows_by_col(t, ra, rb, keys[k], 1);
+        }
+        if (cmp > 0 || (cmp == 0 && order[i - 1] > order[i])) abort();
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 5) return 0;
+
+    int col_count = fuzz_count(data[0], 1, 4);
+    FuzzInput in = { data, size, 5, NULL, 0, 0, 0 };
+    Table t;
+    fuzz_table_build(&t, col_count, fuzz_count(data[1] * 4 + data[2], 0, 512), aggregate_cell, &in);
+    if (data[2] & 1) table_infer_types(&t);
+
+    /* Some runs delete about a third of the rows, some a long run of
+     * them, leaving tombstones that whole bitmap words skip. */
+    tombstone_min_dead = FUZZ_MAX_ROWS + 1;
+    for (int r = 0; (data[0] & 4) && r < t.row_count; r++) {
+        if ((r * 7 + data[1]) % 3 == 0 && !table_delete_row(&t, r)) abort();
+    }
+    for (int r = data[1]; (data[0] & 8) && r < data[1] + data[2] && r < t.row_count; r++) {
+        if (!table_delete_row(&t, r)) abort();
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    /* Key and value columns are picked by bit masks; the same column may be both. */
+    int keys[FUZZ_MAX_COLS], vals[FUZZ_MAX_COLS], key_count = 0, value_count = 0;
+    for (int c = 0; c < col_count; c++) {
+        if (data[3] & (1 << c)) keys[key_count++] = c;
+        if (data[4] & (1 << c)) vals[value_count++] = c;
+    }
+    if (key_count == 0) keys[key_count++] = data[3] % col_count;
+
+    /* Serially, then split into small ranges on several threads. */
+    for (int pass = 0; pass < 2; pass++) {
+        csv_load_threads = pass ? 1 + data[0] % 7 : 1;
+        agg_parallel_min_rows = pass ? 1 + data[1] % 64 : AGG_PARALLEL_MIN_ROWS;
+        Aggregate agg;
+        if (!table_aggregate(&agg, &t, keys, key_count, vals, value_count)) abort();
+        check_groups(&t, keys, key_count, vals, value_count, &agg, pass == 0);
+        int *order = agg_sorted_groups(&agg);
+        if (!order) abort();
+        check_sorted(&t, keys, key_count, &agg, order);
+        free(order);
+        agg_free(&agg);
+    }
+
+    csv_load_threads = 0;
+    agg_parallel_min_rows = AGG_PARALLEL_MIN_ROWS;
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_create_index()
+#include "fuzz_table.h"
+
+/* Few distinct keys, so probe runs are full of duplicates and collisions. */
+static const char *const vocab[] = {
+    "", "a", "b", "ab", "42", "-1", "1.5", "key", "a,b", "longer value 0123456789",
+};
+
+/* Reference: the linear scan find_row_index_by_value() does without an
+ * index; deleted rows never match, not even "". */
+static int first_match(const Table *t, int col, const char *value) {
+    for (int i = 0; i < t->row_count; i++) {
+        if (table_row_live(t, i) && cell_equals(t->cols[col].cells[i], value, strlen(value))) return i;
+    }
+    return -1;
+}
+
+/* Every indexed column must agree with a scan, for every key. */
+static void check_table(const Table *t) {
+    for (int c = 0; c < t->col_count; c++) {
+        if (!t->cols[c].index) continue;
+        if (t->cols[c].index->count != (size_t)table_live_rows(t)) abort();
+        for (int k = 0; k < COUNT_OF(vocab); k++) {
+            if (find_row_index_by_value(t, c, vocab[k]) != first_match(t, c, vocab[k])) abort();
+            int *rows;
+            int n = table_index_rows(t, c, vocab[k], strlen(vocab[k]), &rows);
+            if (n < 0) abort();
+            int expected = 0;
+            for (int i = 0; i < t->row_count; i++) {
+                if (!table_row_live(t, i)) continue;
+                if (!cell_equals(t->cols[c].cells[i], vocab[k], strlen(vocab[k]))) continue;
+                if (expected >= n || rows[expected] != i) abort();
+                expected++;
+            }
+            if (expected != n) abort();
+            free(rows);
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 2) return 0;
+
+    FuzzInput in = { data, size, 2, vocab, COUNT_OF(vocab), 0, 0 };
+    Table t;
+    fuzz_table_build(&t, fuzz_count(data[0], 1, 3), fuzz_count(data[1], 0, 128), fuzz_vocab_cell, &in);
+    if (data[1] & 1) table_infer_types(&t);
+    table_create_index(&t, 0);
+    check_table(&t);
+
+    /* Some runs compact after every few deletes. */
+    tombstone_min_dead = (data[0] & 8) ? 1 + data[0] / 16 : TOMBSTONE_MIN_DEAD;
+
+    /* Mutations must keep every index in step with its column. */
+    while (in.pos + 3 <= size) {
+        int op = data[in.pos] % 7;
+        int row = t.row_count ? data[in.pos + 1] % t.row_count : 0;
+        int col = data[in.pos + 2] % t.col_count;
+        const char *v = vocab[data[in.pos + 1] % COUNT_OF(vocab)];
+        in.pos += 3;
+        if (op == 0) {
+            table_create_index(&t, col);
+        } else if (op == 1) {
+            if (t.row_count < FUZZ_GROW_ROWS) table_new_row(&t);
+        } else if (t.row_count == 0) {
+            continue;
+        } else if (op == 2) {
+            if (!table_row_live(&t, row)) continue;
+            table_release_cell(&t, t.cols[col].cells[row]);
+            table_set_cell(&t, row, col, arena_cell(&t.strings, v, strlen(v)));
+        } else if (op == 3) {
+            if (!table_delete_row(&t, row)) abort();
+        } else if (op == 4) {
+            table_swap_rows(&t, row, (row + col + 1) % t.row_count);
+        } else if (op == 5) {
+            table_compact_strings(&t);
+        } else {
+            int live = table_live_rows(&t);
+            table_compact_rows(&t);
+            if (t.live || t.dead_count != 0 || t.row_count != live) abort();
+        }
+        check_table(&t);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real column_duplicates() and key constraints
+#include "fuzz_table.h"
+
+/* Empty cells are NULL to a key; the rest collide often. */
+static const char *const vocab[] = {
+    "", "a", "b", "ab", "42", "-1", "1.5", "key", "a,b", "longer value 0123456789",
+    "c", "d", "e", "f", "g", "h",
+};
+
+static int same_value(Cell a, Cell b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.ptr, b.ptr, a.len) == 0);
+}
+
+/* Reference: the first row before `row` holding the same non-empty value. */
+static int earlier_match(const Table *t, int c, int row) {
+    Cell v = t->cols[c].cells[row];
+    if (v.len == 0) return -1;
+    for (int i = 0; i < row; i++) {
+        if (same_value(t->cols[c].cells[i], v)) return i;
+    }
+    return -1;
+}
+
+/* The chains must list each repeated value's rows, ascending, heads in row order. */
+static void check_duplicates(const Table *t, int c) {
+    int *heads, *next;
+    int dups = column_duplicates(t, c, &heads, &next, NULL);
+    if (dups < 0) abort();
+    int h = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        int first = earlier_match(t, c, r);
+        int later = -1;
+        for (int i = r + 1; i < t->row_count && later < 0; i++) {
+            if (t->cols[c].cells[r].len > 0 && same_value(t->cols[c].cells[i], t->cols[c].cells[r])) {
+                later = i;
+            }
+        }
+        if (next[r] != later) abort();
+        if (first < 0 && later >= 0) {
+            if (h >= dups || heads[h] != r) abort();
+            h++;
+        }
+    }
+    if (h != dups) abort();
+    free(heads);
+    free(next);
+}
+
+/* No two non-empty cells of a key column are equal; a PRIMARY KEY has no
+ * empty cells. An index, adopted from the duplicate check or not, covers
+ * every live row. */
+static void check_keys(const Table *t) {
+    for (int c = 0; c < t->col_count; c++) {
+        if (t->cols[c].index) {
+            if (t->cols[c].index->count != (size_t)table_live_rows(t)) abort();
+            for (int r = 0; r < t->row_count; r++) {
+                if (!table_row_live(t, r)) continue;
+                if (index_find_slot(t->cols[c].index, index_hash(t->cols[c].cells[r]), r) == SIZE_MAX) abort();
+            }
+        }
+        if (t->cols[c].key == KEY_NONE) continue;
+        for (int r = 0; r < t->row_count; r++) {
+            if (!table_row_live(t, r)) continue;
+            if (earlier_match(t, c, r) >= 0) abort();
+            if (t->cols[c].key == KEY_PRIMARY && t->cols[c].cells[r].len == 0) abort();
+        }
+    }
+}
+
+/* Write `v` the way insert/update do: only when the key allows it. */
+static void checked_write(Table *t, int row, int c, const char *v) {
+    size_t len = strlen(v);
+    int expected = -1;
+    for (int i = 0; i < t->row_count && expected < 0; i++) {
+        if (i != row && len > 0 && cell_equals(t->cols[c].cells[i], v, len)) expected = i;
+    }
+    int other = table_key_conflict(t, c, row, v, len);
+    if ((other >= 0) != (expected >= 0)) abort();
+    if (other >= 0 && (other == row || !cell_equals(t->cols[c].cells[other], v, len))) abort();
+    if (t->cols[c].key == KEY_NONE || (other < 0 && !(t->cols[c].key == KEY_PRIMARY && len == 0))) {
+        table_release_cell(t, t->cols[c].cells[row]);
+        table_set_cell(t, row, c, arena_cell(&t->strings, v, len));
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 3) return 0;
+
+    int col_count = fuzz_count(data[0], 1, 3);
+    FuzzInput in = { data, size, 3, vocab, COUNT_OF(vocab), 0, 0 };
+    Table t;
+    fuzz_table_build(&t, col_count, fuzz_count(data[1], 0, 128), fuzz_vocab_cell, &in);
+    if (data[1] & 1) table_infer_types(&t);
+    for (int c = 0; c < col_count; c++) {
+        check_duplicates(&t, c);
+    }
+
+    /* Some runs compact after every few deletes; some delete every third
+     * row before the key is enforced. */
+    tombstone_min_dead = (data[0] & 8) ? 1 + data[0] / 16 : TOMBSTONE_MIN_DEAD;
+    if (data[2] & 32) {
+        for (int r = 0; r < t.row_count; r += 3) {
+            if (!table_delete_row(&t, r)) abort();
+        }
+    }
+    int live_rows = table_live_rows(&t);
+
+    /* Loading under a key keeps the first row of each value, in order. */
+    int key_col = data[2] % col_count;
+    KeyConstraint key = (data[2] & 8) ? KEY_PRIMARY : KEY_UNIQUE;
+    int expected_rows = 0;
+    for (int r = 0; r < t.row_count; r++) {
+        if (!table_row_live(&t, r)) continue;
+        if (earlier_match(&t, key_col, r) >= 0) continue;
+        if (key == KEY_PRIMARY && t.cols[key_col].cells[r].len == 0) continue;
+        expected_rows++;
+    }
+    if (data[2] & 16) table_create_index(&t, (key_col + 1) % col_count);
+    int dropped = table_drop_key_violations(&t, key_col, key);
+    if (dropped < 0 || table_live_rows(&t) != expected_rows || dropped != live_rows - expected_rows) abort();
+    if (table_add_key(&t, key_col, key) != 1) abort();
+    check_keys(&t);
+
+    /* Writes that respect the key never break it, with or without the index. */
+    while (in.pos + 3 <= size) {
+        int op = data[in.pos] % 7;
+        int row = t.row_count ? data[in.pos + 1] % t.row_count : 0;
+        int col = data[in.pos + 2] % t.col_count;
+        const char *v = vocab[data[in.pos + 1] % COUNT_OF(vocab)];
+        in.pos += 3;
+        if (op == 0) {
+            int c = (col + 1) % t.col_count;
+            if (t.cols[c].key == KEY_NONE && table_add_key(&t, c, KEY_UNIQUE) == -1) {
+                check_duplicates(&t, c);
+            }
+        } else if (op == 1) {
+            /* Like insert_row(): check every column first, then append. */
+            int allowed = v[0] != '\0' && t.row_count < FUZZ_GROW_ROWS;
+            for (int c = 0; allowed && c < t.col_count; c++) {
+                if (t.cols[c].key != KEY_NONE && table_key_conflict(&t, c, -1, v, strlen(v)) >= 0) {
+                    allowed = 0;
+                }
+            }
+            int r = allowed ? table_new_row(&t) : -1;
+            for (int c = 0; r >= 0 && c < t.col_count; c++) {
+                table_set_cell(&t, r, c, arena_cell(&t.strings, v, strlen(v)));
+            }
+        } else if (t.row_count == 0) {
+            continue;
+        } else if (op == 2) {
+            if (table_row_live(&t, row)) checked_write(&t, row, col, v);
+        } else if (op == 3) {
+            if (!table_delete_row(&t, row)) abort();
+        } else if (op == 4) {
+            table_swap_rows(&t, row, (row + col + 1) % t.row_count);
+        } else if (op == 5) {
+            index_free(t.cols[col].index);
+            t.cols[col].index = NULL;
+        } else {
+            table_compact_rows(&t);
+        }
+        check_keys(&t);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+    for (int c = 0; c < t.col_count; c++) {
+        check_duplicates(&t, c);
+    }
+
+    free_table(&t);
+    return 0;
+}
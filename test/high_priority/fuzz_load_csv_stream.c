@@ -0,0 +1,56 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* Use the REAL project implementation (Table, load_csv_stream, ...) */
+#include "../../csv_sql.c"
+
+/* Stream the input through a tiny, growing read buffer and compare the
+ * result with an in-place load of the same bytes, cell for cell. */
+static int same_cell(Cell a, Cell b) {
+    if (!a.ptr || !b.ptr) return a.ptr == b.ptr;
+    return a.len == b.len && memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size == 0) return 0;
+
+    FILE *in = fmemopen((void *)data, size, "rb");
+    if (!in) return 0;
+
+    FILE *devnull = fopen("/dev/null", "w");
+    if (!devnull) {
+        fclose(in);
+        return 0;
+    }
+    FILE *orig_stdout = stdout;
+    stdout = devnull;
+
+    Table streamed, mapped;
+    init_table(&streamed);
+    init_table(&mapped);
+    csv_read_buffer = 1 + data[0] % 97;
+    load_csv_stream(&streamed, in);
+    load_csv_buffer(&mapped, (const char *)data, size);
+    csv_read_buffer = CSV_READ_BUFFER;
+
+    stdout = orig_stdout;
+    fclose(devnull);
+    fclose(in);
+
+    if (streamed.col_count != mapped.col_count) abort();
+    if (streamed.row_count != mapped.row_count) abort();
+    for (int c = 0; c < mapped.col_count; c++) {
+        if (strcmp(streamed.col_names[c], mapped.col_names[c]) != 0) abort();
+        for (int r = 0; r < mapped.row_count; r++) {
+            if (!same_cell(table_cell(&streamed, r, c), table_cell(&mapped, r, c))) abort();
+        }
+    }
+
+    free_table(&streamed);
+    free_table(&mapped);
+    return 0;
+}
@@ -5,9 +5,7 @@
 #include <string.h>
 
 #include "../../csv_sql.c"   // include project implementation ONCE
-
-//#define MAX_COLS 32
-#define MAX_ROWS 1024
+#include "fuzz_table.h"
 
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
@@ -22,49 +20,16 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     /* ---- Build synthetic Table ---- */
     Table t;
-    t.col_count = data[0] % (MAX_COLS + 1);
-    if (t.col_count == 0) t.col_count = 1;
-
-    t.row_count = data[1] % (MAX_ROWS + 1);
-
-    /* Allocate column names */
-    for (int i = 0; i < t.col_count; i++) {
-        t.col_names[i] = malloc(8);
-        if (t.col_names[i]) strcpy(t.col_names[i], "col");
-    }
-
-    /* Allocate rows + cells (safe copy) */
-    for (int r = 0; r < t.row_count; r++) {
-        t.rows[r].cell_count = t.col_count;
+    fuzz_slice_table(&t, data, size, 0);
 
-        for (int c = 0; c < t.col_count; c++) {
-            size_t alloc = 4 + ((r + c) % 32);   // allocated bytes (including terminator)
-            t.rows[r].cells[c] = malloc(alloc);
-            if (!t.rows[r].cells[c]) continue;
-
-            size_t copy_len = alloc - 1;         // bytes we want to copy at most
-            size_t idx = (2 + (size_t)r + (size_t)c) % size; // valid because size >= 3
-
-            /* compute how many bytes are actually available from data[idx] */
-            size_t avail = size - idx;
-            size_t to_copy = (copy_len < avail) ? copy_len : avail;
-
-            /* perform the safe copy and null-terminate at the correct place */
-            if (to_copy > 0) {
-                memcpy(t.rows[r].cells[c], &data[idx], to_copy);
-            }
-            t.rows[r].cells[c][to_copy] = '\0';
-        }
-    }
+    /* Half the runs go through the typed-column paths */
+    if (data[size - 1] & 1) table_infer_types(&t);
 
     /* ---- Fake stdin from fuzz data ---- */
     char *input = malloc(size + 1);
     if (!input) {
         /* cleanup */
-        for (int i = 0; i < t.col_count; i++) free(t.col_names[i]);
-        for (int r = 0; r < t.row_count; r++)
-            for (int c = 0; c < t.col_count; c++)
-                free(t.rows[r].cells[c]);
+        free_table(&t);
         fclose(devnull);
         return 0;
     }
@@ -74,10 +39,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
     FILE *fake_stdin = fmemopen(input, size, "r");
     if (!fake_stdin) {
         free(input);
-        for (int i = 0; i < t.col_count; i++) free(t.col_names[i]);
-        for (int r = 0; r < t.row_count; r++)
-            for (int c = 0; c < t.col_count; c++)
-                free(t.rows[r].cells[c]);
+        free_table(&t);
         fclose(devnull);
         return 0;
     }
@@ -97,12 +59,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
     free(input);
 
     /* ---- Cleanup ---- */
-    for (int i = 0; i < t.col_count; i++)
-        free(t.col_names[i]);
-
-    for (int r = 0; r < t.row_count; r++)
-        for (int c = 0; c < t.col_count; c++)
-            free(t.rows[r].cells[c]);
+    free_table(&t);
 
     return 0;
 }
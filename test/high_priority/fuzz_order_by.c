@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_sort(), serial and parallel
+#include "fuzz_table.h"
+
+/* Columns draw from one of these: all integers, all doubles (NaN in some
+ * runs), or a mix of numbers, text and text with embedded NUL bytes. */
+static const char *const ints[] = { "", "0", "-1", "1", "7", "-9223372036854775808",
+                                    "9223372036854775807", "42", "-42", "100" };
+static const char *const doubles[] = { "", "0.5", "-0.0", "0", "1e300", "-1e-300", "2.5",
+                                       "-2.5", "inf", "-inf", "nan" };
+static const Cell mixed[] = {
+    { "", 0 }, { "a", 1 }, { "b", 1 }, { "ab", 2 }, { "a\x01", 2 }, { "a\xff", 2 },
+    { "a\0", 2 }, { "a\0b", 3 }, { "\0", 1 }, { "1", 1 }, { "01", 2 }, { "1.0", 3 },
+    { "-3", 2 }, { "nan", 3 }, { " ", 1 }, { "zz", 2 },
+};
+
+/* data[3] picks each column's kind; data[2] bit 1 allows "nan", last, which
+ * keeps a DOUBLE column off the radix path. */
+static Cell order_by_cell(FuzzInput *in, int r, int c, char *buf) {
+    (void)buf;
+    uint8_t b = fuzz_byte(in, r, c);
+    int kind = (in->data[3] >> (2 * c)) % 3;
+    if (kind == 0) return fuzz_text(ints[b % COUNT_OF(ints)]);
+    if (kind == 1) return fuzz_text(doubles[b % (COUNT_OF(doubles) - !(in->data[2] & 2))]);
+    return mixed[b % COUNT_OF(mixed)];
+}
+
+/* Reference: rows tied on every key keep their order. */
+static int before(const Table *t, const SortKey *keys, int count, int a, int b) {
+    for (int k = 0; k < count; k++) {
+        int cmp = compare_rows_by_col(t, a, b, keys[k].col, keys[k].asc);
+        if (cmp) return cmp < 0;
+    }
+    return a < b;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 4) return 0;
+
+    /* The last column numbers the rows. */
+    int col_count = fuzz_count(data[0], 1, 4);
+    int row_count = fuzz_count(data[1] * 3 + data[2], 0, 256);
+    FuzzInput in = { data, size, 4, NULL, 0, 0, 1 };
+    Table t;
+    fuzz_table_build(&t, col_count, row_count, order_by_cell, &in);
+    if (data[2] & 1) table_infer_types(&t);
+
+    /* Keys: columns and directions from the remaining bytes. */
+    SortKey keys[SORT_MAX_KEYS];
+    int count = 1 + data[0] / 4 % 3;
+    for (int k = 0; k < count; k++) {
+        uint8_t b = in.pos < size ? data[in.pos++] : (uint8_t)k;
+        keys[k].col = b % col_count;
+        keys[k].asc = (b >> 4) & 1;
+    }
+
+    int *expected = (int *)malloc(((size_t)row_count + 1) * sizeof(int));
+    if (!expected) abort();
+    for (int i = 0; i < row_count; i++) {
+        int r = i;
+        while (r > 0 && before(&t, keys, count, i, expected[r - 1])) {
+            expected[r] = expected[r - 1];
+            r--;
+        }
+        expected[r] = i;
+    }
+    Cell *cells = (Cell *)malloc(((size_t)row_count + 1) * (col_count + 1) * sizeof(Cell));
+    if (!cells) abort();
+    for (int r = 0; r < row_count; r++) {
+        for (int c = 0; c <= col_count; c++) cells[r * (col_count + 1) + c] = t.cols[c].cells[r];
+    }
+
+    /* Some runs radix sort even the shortest ranges; some split the rows
+     * into small buckets on several threads. */
+    sort_radix_min = (data[1] & 1) ? 1 + data[1] % 16 : SORT_RADIX_MIN;
+    csv_load_threads = 1 + data[1] / 2 % 8;
+    sort_parallel_min_rows = 1 + data[2] / 4 % 32;
+    if (!table_sort(&t, keys, count)) abort();
+    sort_radix_min = SORT_RADIX_MIN;
+    csv_load_threads = 0;
+    sort_parallel_min_rows = SORT_PARALLEL_MIN_ROWS;
+
+    /* Row i is the reference's i-th row, every column moved with it. */
+    for (int r = 0; r < row_count; r++) {
+        for (int c = 0; c <= col_count; c++) {
+            Cell a = t.cols[c].cells[r], b = cells[expected[r] * (col_count + 1) + c];
+            if (a.ptr != b.ptr || a.len != b.len) abort();
+        }
+    }
+
+    free(cells);
+    free(expected);
+    free_table(&t);
+    return 0;
+}
@@ -7,6 +7,9 @@
 /* Import the REAL project implementation */
 #include "../../csv_sql.c"
 
+/* Field capacity handed to parse_csv_line() */
+#define MAX_COLS 16
+
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     /* Minimum 1 byte required */
@@ -21,7 +24,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
     input[size] = '\0';
 
     /* ---- Prepare storage for output fields ---- */
-    const int MAX_FIELDS = MAX_COLS;  /* project uses MAX_COLS */
+    const int MAX_FIELDS = MAX_COLS;
     char *fields[MAX_FIELDS];
     memset(fields, 0, sizeof(fields));
 
@@ -6,6 +6,23 @@
 
 #include "../../csv_sql.c"   // import real parse_double()
 
+/* What parse_double() used to be: strtod() must consume the whole string. */
+static int reference_parse(const char *s, double *out) {
+    char *end = NULL;
+    double v = strtod(s, &end);
+    if (end == s || *end != '\0') return 0;
+    *out = v;
+    return 1;
+}
+
+/* Same verdict and the same bits (NaN payloads and -0.0 included). */
+static void check_same(const char *s, int ok, double v) {
+    double expected = 0.0;
+    int ok_expected = reference_parse(s, &expected);
+    if (ok != ok_expected) abort();
+    if (ok && memcmp(&v, &expected, sizeof(v)) != 0) abort();
+}
+
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     if (size == 0) return 0;
@@ -17,7 +34,26 @@ int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
     input[size] = '\0';
 
     double out_value = 0.0;
-    parse_double(input, &out_value);   // <-- REAL project function
+    int ok = parse_double(input, &out_value);   // <-- REAL project function
+    check_same(input, ok, out_value);
+
+    /* The view form stops at an embedded NUL exactly like strtod() does. */
+    Cell cell = { (const char *)data, size };
+    out_value = 0.0;
+    ok = parse_cell_double(cell, &out_value);
+    check_same(input, ok, out_value);
+
+    /* Round-trip the first eight bytes as a double, printed at a precision
+     * taken from the ninth, so long significands and far exponents show up. */
+    if (size >= 9) {
+        double d;
+        char text[64];
+        memcpy(&d, data, sizeof(d));
+        snprintf(text, sizeof(text), (data[8] & 0x80) ? "%.*e" : "%.*g", 1 + data[8] % 19, d);
+        out_value = 0.0;
+        ok = parse_double(text, &out_value);
+        check_same(text, ok, out_value);
+    }
 
     free(input);
     return 0;
@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real column_quantiles(), column_quantiles_approx()
+#include "fuzz_table.h"
+
+/* Many repeats, so selection meets long runs of equal keys; integers
+ * past 2^53, so int64 columns must stay exact; and cells that are not
+ * numbers or are NaN, which quantiles leave out. */
+static const char *const vocab[] = {
+    "", "0", "1", "-1", "7", "42", "-300", "9007199254740993", "9007199254740995",
+    "-9223372036854775808", "9223372036854775807", "2.5", "-0.125", "1e300", "-1e300",
+    "inf", "-inf", "nan", "abc",
+};
+
+/* data[2] picks how much of the vocabulary to use, and whether most
+ * values are distinct, in a pattern from data[3]. */
+static Cell quantile_cell(FuzzInput *in, int r, int c, char *buf) {
+    uint8_t b = fuzz_byte(in, r, c);
+    int span = 2 + in->data[2] % (COUNT_OF(vocab) - 1);
+    if (!(in->data[2] & 0x80) || b % 7 == 0) return fuzz_text(vocab[b % span]);
+    snprintf(buf, FUZZ_CELL_MAX, "%d", (int)((uint32_t)r * (in->data[3] | 1u) % 1000u) - (b & 1) * 500);
+    return fuzz_text(buf);
+}
+
+static int compare_int64(const void *pa, const void *pb) {
+    int64_t a = *(const int64_t *)pa, b = *(const int64_t *)pb;
+    return (a > b) - (a < b);
+}
+
+static int compare_double(const void *pa, const void *pb) {
+    double a = *(const double *)pa, b = *(const double *)pb;
+    return (a > b) - (a < b);
+}
+
+/* Exact quantiles by sorting everything. */
+static int reference(const Table *t, const double *qs, int count, double *out, double *sorted) {
+    const Column *c = &t->cols[0];
+    int64_t ints[FUZZ_MAX_ROWS];
+    int n = 0;
+    for (int r = 0; r < t->row_count; r++) {
+        double v;
+        if (c->type == COL_INT64) {
+            if (c->valid[r]) ints[n++] = c->ints[r];
+        } else if (table_cell_number(t, r, 0, &v) && v == v) {
+            sorted[n++] = v;
+        }
+    }
+    if (c->type == COL_INT64) {
+        qsort(ints, (size_t)n, sizeof(int64_t), compare_int64);
+        for (int i = 0; i < n; i++) sorted[i] = (double)ints[i];
+    } else {
+        qsort(sorted, (size_t)n, sizeof(double), compare_double);
+    }
+    for (int i = 0; n > 0 && i < count; i++) {
+        double h = qs[i] * (double)(n - 1);
+        int r = (int)h;
+        out[i] = quantile_lerp(sorted[r], r + 1 < n ? sorted[r + 1] : sorted[r], h - (double)r);
+    }
+    return n;
+}
+
+static int same_value(double a, double b) {
+    return a == b || (a != a && b != b);
+}
+
+/* Exact quantiles must match a full sort bit for bit, on int64, double
+ * and text columns, with deleted rows. The t-digest, built through a
+ * small buffer so it merges many times, must keep at most compression + 1
+ * centroids, return the minimum and maximum at 0 and 1, land every
+ * quantile near its true rank, and be exact while it holds only single
+ * values. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 6) return 0;
+
+    Table t;
+    FuzzInput in = { data, size, 6, NULL, 0, 0, 0 };
+    fuzz_table_build(&t, 1, fuzz_count(data[0] * 8 + data[1], 0, 2048), quantile_cell, &in);
+    if (data[3] & 1) table_infer_types(&t);
+    tombstone_min_dead = FUZZ_MAX_ROWS + 1;
+    for (int r = data[1] % 3; (data[3] & 2) && r < t.row_count; r += 1 + data[4] % 9) {
+        table_delete_row(&t, r);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    /* Quantiles from the input, 0 and 1 included. */
+    double qs[QUANTILE_MAX];
+    int count = 1 + data[4] % QUANTILE_MAX;
+    for (int i = 0; i < count; i++) {
+        uint8_t b = data[(5 + (size_t)i * 3) % size];
+        qs[i] = b == 0 ? 0.0 : b == 255 ? 1.0 : (double)b / 255.0;
+    }
+
+    double expected[QUANTILE_MAX], actual[QUANTILE_MAX];
+    static double sorted[FUZZ_MAX_ROWS];
+    int n = reference(&t, qs, count, expected, sorted);
+    /* Some runs give up on partitioning early and sort. */
+    select_depth = data[4] & 0x80 ? data[5] % 2 : SELECT_DEPTH;
+    if (column_quantiles(&t, 0, qs, count, actual) != n) abort();
+    select_depth = SELECT_DEPTH;
+    for (int i = 0; i < count && n > 0; i++) {
+        if (!same_value(actual[i], expected[i])) abort();
+    }
+
+    int compression = 10 + data[5] % 190;
+    tdigest_buffer = 1 + data[5] % 64;
+    if (column_quantiles_approx(&t, 0, compression, qs, count, actual) != n) abort();
+    TDigest td;
+    if (!tdigest_init(&td, compression)) abort();
+    /* The values again, out of order (7919 is a prime above FUZZ_MAX_ROWS). */
+    for (int i = 0; i < n; i++) tdigest_add(&td, sorted[(int)((int64_t)i * 7919 % n)]);
+    tdigest_flush(&td);
+    tdigest_buffer = TDIGEST_BUFFER;
+
+    if (n > 0) {
+        double weight = 0.0;
+        for (int i = 0; i < td.count; i++) {
+            weight += td.centroids[i].weight;
+            if (i > 0 && td.centroids[i].mean < td.centroids[i - 1].mean) abort();
+        }
+        if (td.count > compression + 1 || weight != td.total) abort();
+        if (td.neg_inf + td.total + td.pos_inf != (double)n) abort();
+        if (tdigest_quantile(&td, 0.0) != sorted[0] || tdigest_quantile(&td, 1.0) != sorted[n - 1]) abort();
+    }
+    /* Centroids hold values from anywhere in their stretch of ranks once
+     * merged over and over, so on runs of equal values the estimate can
+     * fall between two of them: it must lie among the values within a
+     * few centroid widths of its rank. */
+    double tolerance = 2.0 + 8.0 * (double)n / (double)compression;
+    for (int i = 0; i < count && n > 0; i++) {
+        double v = actual[i];
+        if (v != v) abort();
+        if (qs[i] == 0.0 && v != sorted[0]) abort();
+        if (qs[i] == 1.0 && v != sorted[n - 1]) abort();
+        double h = qs[i] * (double)(n - 1);
+        int lo = h - tolerance < 0.0 ? 0 : (int)(h - tolerance);
+        int hi = h + tolerance > (double)(n - 1) ? n - 1 : (int)(h + tolerance) + 1;
+        if (v < sorted[lo] || v > sorted[hi]) abort();
+    }
+    /* While every centroid is a single value, the digest is exact. */
+    for (int i = 0; i < count && n > 0 && td.total == (double)td.count; i++) {
+        if (!same_value(tdigest_quantile(&td, qs[i]), expected[i])) abort();
+    }
+    tdigest_free(&td);
+
+    free_table(&t);
+    return 0;
+}
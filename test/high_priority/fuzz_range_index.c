@@ -0,0 +1,95 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_create_range_index()
+#include "fuzz_table.h"
+
+/* Numbers with ties, signed zeros, infinities and NaN, plus non-numbers. */
+static const char *const vocab[] = {
+    "0", "-0", "1", "2", "2.0", "-3", "1.5", "1e300", "-inf", "inf", "nan", "", "abc", "7",
+};
+
+/* Reference: the scan find_rows_in_range() does without an index, over
+ * the live rows. */
+static int scan_range(const Table *t, int col, double lo, double hi, int out[]) {
+    int n = 0;
+    for (int i = 0; i < t->row_count; i++) {
+        double v;
+        if (table_row_live(t, i) && table_cell_number(t, i, col, &v) && v >= lo && v <= hi) out[n++] = i;
+    }
+    return n;
+}
+
+static void check_table(const Table *t, const uint8_t *bounds) {
+    int expected[FUZZ_GROW_ROWS], actual[FUZZ_GROW_ROWS];
+    for (int c = 0; c < t->col_count; c++) {
+        if (!t->cols[c].range) continue;
+        for (int k = 0; k < 4; k++) {
+            double lo = 0.0, hi = 0.0;
+            parse_double(vocab[bounds[k] % COUNT_OF(vocab)], &lo);
+            parse_double(vocab[bounds[(k + 1) % 4] % COUNT_OF(vocab)], &hi);
+            if (lo > hi) {
+                double tmp = lo;
+                lo = hi;
+                hi = tmp;
+            }
+            int n = scan_range(t, c, lo, hi, expected);
+            /* A short output buffer keeps the first rows and the full count. */
+            int max_out = 1 + bounds[k] % FUZZ_GROW_ROWS;
+            int m = find_rows_in_range(t, c, lo, hi, actual, max_out);
+            if (m != n) abort();
+            if (memcmp(expected, actual, (size_t)(n < max_out ? n : max_out) * sizeof(int)) != 0) abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 6) return 0;
+
+    const uint8_t *bounds = data + 2;
+    FuzzInput in = { data, size, 6, vocab, COUNT_OF(vocab), 0, 0 };
+    Table t;
+    fuzz_table_build(&t, fuzz_count(data[0], 1, 3), fuzz_count(data[1], 0, 128), fuzz_vocab_cell, &in);
+    if (data[1] & 1) table_infer_types(&t);
+    table_create_range_index(&t, 0);
+    check_table(&t, bounds);
+
+    /* Some runs compact after every few deletes. */
+    tombstone_min_dead = (data[0] & 8) ? 1 + data[0] / 16 : TOMBSTONE_MIN_DEAD;
+
+    /* Mutations must keep every index in step with its column. */
+    while (in.pos + 3 <= size) {
+        int op = data[in.pos] % 8;
+        int row = t.row_count ? data[in.pos + 1] % t.row_count : 0;
+        int col = data[in.pos + 2] % t.col_count;
+        const char *v = vocab[data[in.pos + 1] % COUNT_OF(vocab)];
+        in.pos += 3;
+        if (op == 0) {
+            table_create_range_index(&t, col);
+        } else if (op == 1) {
+            if (t.row_count < FUZZ_GROW_ROWS) table_new_row(&t);
+        } else if (op == 2) {
+            if (t.cols[col].range && !range_index_merge(&t, col)) abort();
+        } else if (t.row_count == 0) {
+            continue;
+        } else if (op == 3 || op == 6) {
+            if (!table_row_live(&t, row)) continue;
+            table_set_cell(&t, row, col, arena_cell(&t.strings, v, strlen(v)));
+        } else if (op == 4) {
+            if (!table_delete_row(&t, row)) abort();
+        } else if (op == 5) {
+            table_swap_rows(&t, row, (row + col + 1) % t.row_count);
+        } else {
+            table_compact_rows(&t);
+        }
+        check_table(&t, bounds);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    free_table(&t);
+    return 0;
+}
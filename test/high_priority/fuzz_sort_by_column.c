@@ -6,61 +6,74 @@
 
 /* Import REAL project implementation */
 #include "../../csv_sql.c"
+#include "fuzz_table.h"
 
 int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
 
     if (size < 4)
         return 0;
 
-    /* ---- Build a valid table ---- */
+    /* ---- Build a valid table; the last column numbers the rows ---- */
+    /* Short cells are often numbers, empty or equal. */
+    int col_count = fuzz_count(data[0], 1, 16);
+    int row_count = fuzz_count(data[1], 1, FUZZ_MAX_ROWS);
+    FuzzInput in = { data, size, 0, NULL, 0, data[3] & 4, 1 };
     Table t;
+    fuzz_table_build(&t, col_count, row_count, fuzz_slice_cell, &in);
 
-    t.col_count = data[0] % (MAX_COLS + 1);
-    if (t.col_count == 0) t.col_count = 1;
+    /* Half the runs go through the typed-column paths */
+    if (data[size - 1] & 1) table_infer_types(&t);
 
-    t.row_count = data[1] % (MAX_ROWS + 1);
-    if (t.row_count == 0) t.row_count = 1;
+    /* ---- Fuzzed parameters ---- */
+    int col = data[2] % col_count;
+    int asc = data[3] & 1;
+    if (data[3] & 2) table_create_index(&t, col);
 
-    /* allocate column names */
-    for (int i = 0; i < t.col_count; i++) {
-        t.col_names[i] = malloc(8);
-        strcpy(t.col_names[i], "col");
+    Cell *before = (Cell *)malloc((size_t)row_count * (col_count + 1) * sizeof(Cell));
+    if (!before) abort();
+    for (int r = 0; r < row_count; r++) {
+        for (int c = 0; c <= col_count; c++) before[r * (col_count + 1) + c] = t.cols[c].cells[r];
     }
 
-    /* allocate row cells (safe memcpy) */
-    for (int r = 0; r < t.row_count; r++) {
-        t.rows[r].cell_count = t.col_count;
-
-        for (int c = 0; c < t.col_count; c++) {
-            size_t alloc = 4 + ((r + c) % 32);
-            t.rows[r].cells[c] = malloc(alloc);
-
-            if (t.rows[r].cells[c]) {
-                size_t to_copy = alloc - 1;
-                size_t idx = (2 + r + c) % size;
-                size_t avail = size - idx;
-                size_t n = to_copy < avail ? to_copy : avail;
+    /* ---- Call REAL function from csv_sql.c ---- */
+    sort_by_column(&t, col, asc);
 
-                memcpy(t.rows[r].cells[c], &data[idx], n);
-                t.rows[r].cells[c][n] = '\0';
-            }
+    /* ---- Check: whole rows moved, each row number once, and every
+     * adjacent pair in order, equal keys keeping their original order.
+     * compare_rows_by_col() is a total order, so that is the stable sort. */
+    uint8_t *seen = (uint8_t *)calloc((size_t)row_count, 1);
+    if (!seen || t.row_count != row_count) abort();
+    int prev = -1;
+    for (int r = 0; r < row_count; r++) {
+        double v;
+        if (!table_cell_number(&t, r, col_count, &v) || v < 0 || v >= row_count) abort();
+        int from = (int)v;
+        if (seen[from]) abort();
+        seen[from] = 1;
+        for (int c = 0; c <= col_count; c++) {
+            Cell a = t.cols[c].cells[r], b = before[from * (col_count + 1) + c];
+            if (a.ptr != b.ptr || a.len != b.len) abort();
+            /* Typed values moved with their cells. */
+            double x, y;
+            if (t.cols[c].type != COL_STRING && table_cell_number(&t, r, c, &x) &&
+                (!parse_cell_double(a, &y) || (x != y && x == x))) abort();
         }
+        if (r > 0) {
+            int cmp = compare_rows_by_col(&t, r - 1, r, col, asc);
+            if (cmp > 0 || (cmp == 0 && prev > from)) abort();
+        }
+        prev = from;
     }
-
-    /* ---- Fuzzed parameters ---- */
-    int col = data[2] % t.col_count;
-    int asc = data[3] & 1;
-
-    /* ---- Call REAL function from csv_sql.c ---- */
-    sort_by_column(&t, col, asc);
+    if (t.cols[col].index) {
+        for (int r = 0; r < row_count; r++) {
+            if (index_find_slot(t.cols[col].index, index_hash(t.cols[col].cells[r]), r) == SIZE_MAX) abort();
+        }
+    }
+    free(seen);
+    free(before);
 
     /* ---- Cleanup ---- */
-    for (int r = 0; r < t.row_count; r++)
-        for (int c = 0; c < t.col_count; c++)
-            free(t.rows[r].cells[c]);
-
-    for (int i = 0; i < t.col_count; i++)
-        free(t.col_names[i]);
 
+    free_table(&t);
     return 0;
 }
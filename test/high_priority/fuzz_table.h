@@ -0,0 +1,90 @@
+#ifndef FUZZ_TABLE_H
+#define FUZZ_TABLE_H
+
+/* Synthetic tables for the fuzzers, built from the fuzz input. Include
+ * after csv_sql.c. */
+
+#define FUZZ_MAX_COLS 17        /* columns any fuzzer builds */
+#define FUZZ_MAX_ROWS 4096      /* rows any fuzzer builds */
+#define FUZZ_GROW_ROWS 256      /* rows a table under mutation reaches */
+#define FUZZ_CELL_MAX 36        /* room for a cell written by a cell source */
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+/* The fuzz input, read a byte at a time from `pos`. */
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    const char *const *vocab;   /* for fuzz_vocab_cell() */
+    int vocab_size;
+    int short_slices;           /* fuzz_slice_cell() cuts 0 to 3 bytes */
+    int row_numbers;            /* one more column holds each row's number */
+} FuzzInput;
+
+/* Cell (r, c) of a table being built; `buf` has FUZZ_CELL_MAX bytes. */
+typedef Cell (*FuzzCellFn)(FuzzInput *in, int r, int c, char *buf);
+
+/* The next input byte, or r * 7 + c once the input is used up. */
+static inline uint8_t fuzz_byte(FuzzInput *in, int r, int c) {
+    return in->pos < in->size ? in->data[in->pos++] : (uint8_t)(r * 7 + c);
+}
+
+/* A row or column count: n % (max + 1), at least `min`. */
+static inline int fuzz_count(unsigned n, int min, int max) {
+    int count = (int)(n % (unsigned)(max + 1));
+    return count < min ? min : count;
+}
+
+static inline Cell fuzz_text(const char *s) {
+    Cell cell = { s, strlen(s) };
+    return cell;
+}
+
+/* `cols` columns named "col", then `rows` rows of cell(). */
+static inline void fuzz_table_build(Table *t, int cols, int rows, FuzzCellFn cell, FuzzInput *in) {
+    char buf[FUZZ_CELL_MAX];
+    init_table(t);
+    for (int c = 0; c < cols + (in->row_numbers != 0); c++) {
+        if (!table_add_column(t, "col")) abort();
+    }
+    for (int r = 0; r < rows; r++) {
+        int row = table_new_row(t);
+        if (row < 0) abort();
+        for (int c = 0; c < cols; c++) {
+            Cell v = cell(in, r, c, buf);
+            table_set_cell(t, row, c, arena_cell(&t->strings, v.ptr, v.len));
+        }
+        if (in->row_numbers) {
+            int n = snprintf(buf, FUZZ_CELL_MAX, "%d", r);
+            table_set_cell(t, row, cols, arena_cell(&t->strings, buf, (size_t)n));
+        }
+    }
+}
+
+/* Up to 3 + (r + c) % 32 bytes of the input from offset (2 + r + c) % size:
+ * arbitrary bytes, with neighbouring cells overlapping. */
+static inline Cell fuzz_slice_cell(FuzzInput *in, int r, int c, char *buf) {
+    size_t want = in->short_slices ? (size_t)(r + c) % 4 : 3 + (size_t)(r + c) % 32;
+    size_t idx = (2 + (size_t)r + (size_t)c) % in->size;
+    size_t n = want < in->size - idx ? want : in->size - idx;
+    memcpy(buf, in->data + idx, n);
+    buf[n] = '\0';
+    return fuzz_text(buf);
+}
+
+/* The vocabulary entry the next input byte picks. */
+static inline Cell fuzz_vocab_cell(FuzzInput *in, int r, int c, char *buf) {
+    (void)buf;
+    return fuzz_text(in->vocab[fuzz_byte(in, r, c) % in->vocab_size]);
+}
+
+/* The table the fuzzers of the menu functions share: data[0] picks 1 to 16
+ * columns and data[1] up to 255 rows (at least `min_rows`) of slices. */
+static inline void fuzz_slice_table(Table *t, const uint8_t *data, size_t size, int min_rows) {
+    FuzzInput in = { data, size, 0, NULL, 0, 0, 0 };
+    fuzz_table_build(t, fuzz_count(data[0], 1, 16), fuzz_count(data[1], min_rows, FUZZ_MAX_ROWS),
+                     fuzz_slice_cell, &in);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_infer_types()
+#include "fuzz_table.h"
+
+/* Mostly numeric vocabulary so columns actually come out typed. */
+static const char *const vocab[] = {
+    "0", "-1", "42", "+7", "007", "9223372036854775807", "-9223372036854775808",
+    "9223372036854775808", "1.5", "-0.25", "1e3", " 12", "0x1A", "inf", "nan",
+    "", "abc", "12abc", "-", "3.",
+};
+
+/* Each column draws from its own slice of the vocabulary. */
+static Cell span_cell(FuzzInput *in, int r, int c, char *buf) {
+    (void)buf;
+    int span = 4 + (c * 5) % (COUNT_OF(vocab) - 3);
+    return fuzz_text(vocab[fuzz_byte(in, r, c) % span]);
+}
+
+/* Typed values must agree with parsing the text, cell by cell. */
+static void check_table(const Table *t) {
+    for (int c = 0; c < t->col_count; c++) {
+        for (int r = 0; r < t->row_count; r++) {
+            double expected = 0.0, actual = 0.0;
+            int ok_expected = parse_cell_double(t->cols[c].cells[r], &expected);
+            int ok_actual = table_cell_number(t, r, c, &actual);
+            if (ok_expected != ok_actual) abort();
+            if (ok_expected && expected == expected && expected != actual) abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 2) return 0;
+
+    FuzzInput in = { data, size, 2, NULL, 0, 0, 0 };
+    Table t;
+    fuzz_table_build(&t, fuzz_count(data[0], 1, 4), fuzz_count(data[1], 0, 256), span_cell, &in);
+
+    table_infer_types(&t);
+    check_table(&t);
+
+    /* Mutations keep the typed values in step (and may widen or drop types). */
+    while (in.pos + 3 <= size && t.row_count > 0) {
+        int op = data[in.pos] % 3;
+        int row = data[in.pos + 1] % t.row_count;
+        int col = data[in.pos + 2] % t.col_count;
+        in.pos += 3;
+        if (op == 0) {
+            if (!table_row_live(&t, row)) continue;
+            const char *v = vocab[data[in.pos - 1] % COUNT_OF(vocab)];
+            table_set_cell(&t, row, col, arena_cell(&t.strings, v, strlen(v)));
+        } else if (op == 1) {
+            if (!table_delete_row(&t, row)) abort();
+        } else {
+            table_swap_rows(&t, row, (row + col + 1) % t.row_count);
+        }
+        check_table(&t);
+    }
+
+    free_table(&t);
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../csv_sql.c"   // import real table_create_trigram_index()
+#include "fuzz_table.h"
+
+/* Overlapping words, so trigrams are shared and candidates need verifying. */
+static const char *const vocab[] = {
+    "", "ab", "abc", "abcabc", "xabcx", "abxbc", "bca", "cab", "error: disk full",
+    "warn: disk", "disk", "aaaa", "aaa", "a\"b,c",
+};
+
+static const char *const patterns[] = {
+    "a", "ab", "abc", "bca", "cabc", "abcabc", "disk", "isk ", "aaa", "aaaa", "xyz", "b,c", "sk",
+};
+
+/* Reference: the scan find_rows_by_substring() does without an index,
+ * over the live rows. */
+static int scan_rows(const Table *t, int col, const char *pattern, int out[]) {
+    int n = 0;
+    for (int i = 0; i < t->row_count; i++) {
+        if (table_row_live(t, i) && cell_contains(t->cols[col].cells[i], pattern, strlen(pattern))) out[n++] = i;
+    }
+    return n;
+}
+
+static void check_table(const Table *t, uint8_t salt) {
+    int expected[FUZZ_GROW_ROWS], actual[FUZZ_GROW_ROWS];
+    for (int c = 0; c < t->col_count; c++) {
+        if (!t->cols[c].grams) continue;
+        for (int k = 0; k < COUNT_OF(patterns); k++) {
+            int n = scan_rows(t, c, patterns[k], expected);
+            /* A short output buffer keeps the first rows and the full count. */
+            int max_out = 1 + (salt + k * 37) % FUZZ_GROW_ROWS;
+            int m = find_rows_by_substring(t, c, patterns[k], actual, max_out);
+            if (m != n) abort();
+            if (memcmp(expected, actual, (size_t)(n < max_out ? n : max_out) * sizeof(int)) != 0) abort();
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+
+    if (size < 3) return 0;
+
+    uint8_t salt = data[2];
+    FuzzInput in = { data, size, 3, vocab, COUNT_OF(vocab), 0, 0 };
+    Table t;
+    fuzz_table_build(&t, fuzz_count(data[0], 1, 3), fuzz_count(data[1], 0, 128), fuzz_vocab_cell, &in);
+    table_create_trigram_index(&t, 0);
+    check_table(&t, salt);
+
+    /* Some runs compact after every few deletes. */
+    tombstone_min_dead = (data[0] & 8) ? 1 + data[0] / 16 : TOMBSTONE_MIN_DEAD;
+
+    /* Mutations must keep every index in step with its column. */
+    while (in.pos + 3 <= size) {
+        int op = data[in.pos] % 8;
+        int row = t.row_count ? data[in.pos + 1] % t.row_count : 0;
+        int col = data[in.pos + 2] % t.col_count;
+        const char *v = vocab[data[in.pos + 1] % COUNT_OF(vocab)];
+        in.pos += 3;
+        if (op == 0) {
+            table_create_trigram_index(&t, col);
+        } else if (op == 1) {
+            if (t.row_count < FUZZ_GROW_ROWS) table_new_row(&t);
+        } else if (op == 2) {
+            if (t.cols[col].grams && !trigram_rebuild(&t, col)) abort();
+        } else if (t.row_count == 0) {
+            continue;
+        } else if (op == 3 || op == 6) {
+            if (!table_row_live(&t, row)) continue;
+            table_set_cell(&t, row, col, arena_cell(&t.strings, v, strlen(v)));
+        } else if (op == 4) {
+            if (!table_delete_row(&t, row)) abort();
+        } else if (op == 5) {
+            table_swap_rows(&t, row, (row + col + 1) % t.row_count);
+        } else {
+            table_compact_rows(&t);
+        }
+        check_table(&t, salt);
+    }
+    tombstone_min_dead = TOMBSTONE_MIN_DEAD;
+
+    free_table(&t);
+    return 0;
+}